@@ -32,6 +32,7 @@ config = {
   },
   spatializers = {
     simple = true,
+    hrtf = true,
     oculus = false,
     phonon = false
   },
@@ -390,6 +391,7 @@ src = {
   'src/main.c',
   'src/util.c',
   'src/core/fs.c',
+  'src/core/mesh.c',
   ('src/core/os_%s.c'):format(target),
   'src/core/spv.c',
   'src/core/zip.c',
@@ -399,7 +401,7 @@ src = {
 
 for module, enabled in pairs(config.modules) do
   if enabled then
-    override = { audio = 'src/modules/audio/audio.c', headset = 'src/modules/headset/headset.c' } -- TODO
+    override = { audio = { 'src/modules/audio/audio.c', 'src/modules/audio/dsp.c', 'src/modules/audio/mix.c' }, headset = 'src/modules/headset/headset.c' } -- TODO
     src += override[module] or ('src/modules/%s/*.c'):format(module)
     src += ('src/api/l_%s*.c'):format(module)
   else
@@ -434,7 +436,7 @@ src += (config.modules.audio or config.modules.data) and 'src/lib/miniaudio/*.c'
 src += config.modules.data and 'src/lib/jsmn/*.c' or nil
 src += config.modules.data and 'src/lib/minimp3/*.c' or nil
 src += config.modules.math and 'src/lib/noise/*.c' or nil
-src += config.modules.thread and 'src/lib/tinycthread/*.c' or nil
+src += (config.modules.audio or config.modules.data or config.modules.thread) and 'src/lib/tinycthread/*.c' or nil
 
 -- embed resource files with xxd
 
@@ -10,6 +10,7 @@
 #include "shaders/fill_layer.frag.h"
 #include "shaders/animator.comp.h"
 #include "shaders/timewizard.comp.h"
+#include "shaders/cluster.comp.h"
 #include "shaders/logo.frag.h"
 
 #include "shaders/lovr.glsl.h"
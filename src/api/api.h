@@ -24,9 +24,11 @@ extern StringEntry lovrAudioType[];
 extern StringEntry lovrBlendAlphaMode[];
 extern StringEntry lovrBlendMode[];
 extern StringEntry lovrBlockType[];
+extern StringEntry lovrBroadphaseType[];
 extern StringEntry lovrBufferLayout[];
 extern StringEntry lovrChannelLayout[];
 extern StringEntry lovrCompareMode[];
+extern StringEntry lovrContactEventType[];
 extern StringEntry lovrCullMode[];
 extern StringEntry lovrDefaultAttribute[];
 extern StringEntry lovrDefaultShader[];
@@ -39,6 +41,7 @@ extern StringEntry lovrEffect[];
 extern StringEntry lovrEventType[];
 extern StringEntry lovrFieldType[];
 extern StringEntry lovrFilterMode[];
+extern StringEntry lovrFilterType[];
 extern StringEntry lovrHeadsetDriver[];
 extern StringEntry lovrHeadsetOrigin[];
 extern StringEntry lovrHorizontalAlign[];
@@ -48,6 +51,7 @@ extern StringEntry lovrMeshMode[];
 extern StringEntry lovrOriginType[];
 extern StringEntry lovrPassType[];
 extern StringEntry lovrPermission[];
+extern StringEntry lovrPoseLayout[];
 extern StringEntry lovrSampleFormat[];
 extern StringEntry lovrShaderStage[];
 extern StringEntry lovrShaderType[];
@@ -135,6 +139,7 @@ int luax_readmesh(lua_State* L, int index, float** vertices, uint32_t* vertexCou
 struct Blob;
 struct Image;
 struct Blob* luax_readblob(lua_State* L, int index, const char* debug);
+struct Blob* luax_mapblob(lua_State* L, int index, const char* debug);
 struct Image* luax_checkimage(lua_State* L, int index);
 uint32_t luax_checkcodepoint(lua_State* L, int index);
 #endif
@@ -187,4 +192,5 @@ struct Shape* luax_newcapsuleshape(lua_State* L, int index);
 struct Shape* luax_newcylindershape(lua_State* L, int index);
 struct Shape* luax_newmeshshape(lua_State* L, int index);
 struct Shape* luax_newterrainshape(lua_State* L, int index);
+struct Shape* luax_newconvexshape(lua_State* L, int index);
 #endif
@@ -16,6 +16,17 @@ StringEntry lovrEffect[] = {
   { 0 }
 };
 
+StringEntry lovrFilterType[] = {
+  [FILTER_LOWPASS] = ENTRY("lowpass"),
+  [FILTER_HIGHPASS] = ENTRY("highpass"),
+  [FILTER_BANDPASS] = ENTRY("bandpass"),
+  [FILTER_NOTCH] = ENTRY("notch"),
+  [FILTER_PEAK] = ENTRY("peak"),
+  [FILTER_LOWSHELF] = ENTRY("lowshelf"),
+  [FILTER_HIGHSHELF] = ENTRY("highshelf"),
+  { 0 }
+};
+
 StringEntry lovrAudioMaterial[] = {
   [MATERIAL_GENERIC] = ENTRY("generic"),
   [MATERIAL_BRICK] = ENTRY("brick"),
@@ -195,6 +206,84 @@ static int l_lovrAudioSetGeometry(lua_State* L) {
   return 1;
 }
 
+static int l_lovrAudioGetReverb(lua_State* L) {
+  float gain;
+  Sound* sound = lovrAudioGetReverb(&gain);
+  if (!sound) {
+    lua_pushnil(L);
+    return 1;
+  }
+  luax_pushtype(L, Sound, sound);
+  lua_pushnumber(L, gain);
+  return 2;
+}
+
+static int l_lovrAudioSetReverb(lua_State* L) {
+  Sound* sound = lua_toboolean(L, 1) ? luax_checktype(L, 1, Sound) : NULL;
+  float gain = luax_optfloat(L, 2, 1.f);
+  bool success = lovrAudioSetReverb(sound, gain);
+  lua_pushboolean(L, success);
+  return 1;
+}
+
+static int l_lovrAudioSetHRTF(lua_State* L) {
+  Sound* sound = luax_checktype(L, 1, Sound);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  lua_rawgeti(L, 2, 1);
+  bool nested = lua_type(L, -1) == LUA_TTABLE;
+  lua_pop(L, 1);
+
+  uint32_t count = luax_len(L, 2) / (nested ? 1 : 2);
+  lovrCheck(count > 0, "HRTF must have at least one direction");
+  float* directions = lua_newuserdata(L, count * 2 * sizeof(float));
+
+  if (nested) {
+    for (uint32_t i = 0; i < count; i++) {
+      lua_rawgeti(L, 2, i + 1);
+      lua_rawgeti(L, -1, 1);
+      lua_rawgeti(L, -2, 2);
+      directions[2 * i + 0] = luax_checkfloat(L, -2);
+      directions[2 * i + 1] = luax_checkfloat(L, -1);
+      lua_pop(L, 3);
+    }
+  } else {
+    for (uint32_t i = 0; i < count * 2; i++) {
+      lua_rawgeti(L, 2, i + 1);
+      directions[i] = luax_checkfloat(L, -1);
+      lua_pop(L, 1);
+    }
+  }
+
+  bool success = lovrAudioSetHRTF(sound, directions, count);
+  lua_pushboolean(L, success);
+  return 1;
+}
+
+static int l_lovrAudioRender(lua_State* L) {
+  Sound* sound = luax_totype(L, 1, Sound);
+
+  if (!sound) {
+    uint32_t frames = luax_checku32(L, 1);
+    sound = lovrSoundCreateRaw(frames, SAMPLE_F32, CHANNEL_STEREO, lovrAudioGetSampleRate(), NULL);
+    luax_pushtype(L, Sound, sound);
+    lovrRelease(sound, lovrSoundDestroy);
+    lovrAudioRender(sound, 0, frames);
+    return 1;
+  }
+
+  uint32_t offset = luax_optu32(L, 2, 0);
+  uint32_t frames;
+  if (lua_isnoneornil(L, 3)) {
+    uint32_t capacity = lovrSoundGetCapacity(sound);
+    frames = lovrSoundIsStream(sound) ? capacity : capacity - MIN(offset, capacity);
+  } else {
+    frames = luax_checku32(L, 3);
+  }
+  uint32_t rendered = lovrAudioRender(sound, offset, frames);
+  lua_pushinteger(L, rendered);
+  return 1;
+}
+
 static int l_lovrAudioGetSpatializer(lua_State *L) {
   lua_pushstring(L, lovrAudioGetSpatializer());
   return 1;
@@ -205,6 +294,11 @@ static int l_lovrAudioGetSampleRate(lua_State *L) {
   return 1;
 }
 
+static int l_lovrAudioGetTime(lua_State *L) {
+  lua_pushnumber(L, lovrAudioGetTime());
+  return 1;
+}
+
 static int l_lovrAudioGetAbsorption(lua_State* L) {
   float absorption[3];
   lovrAudioGetAbsorption(absorption);
@@ -280,6 +374,14 @@ static int l_lovrAudioNewSource(lua_State* L) {
   return 1;
 }
 
+static int l_lovrAudioNewBus(lua_State* L) {
+  Bus* parent = lua_isnoneornil(L, 1) ? NULL : luax_checktype(L, 1, Bus);
+  Bus* bus = lovrBusCreate(parent);
+  luax_pushtype(L, Bus, bus);
+  lovrRelease(bus, lovrBusDestroy);
+  return 1;
+}
+
 static const luaL_Reg lovrAudio[] = {
   { "getDevices", l_lovrAudioGetDevices },
   { "setDevice", l_lovrAudioSetDevice },
@@ -295,20 +397,28 @@ static const luaL_Reg lovrAudio[] = {
   { "getPose", l_lovrAudioGetPose },
   { "setPose", l_lovrAudioSetPose },
   { "setGeometry", l_lovrAudioSetGeometry },
+  { "getReverb", l_lovrAudioGetReverb },
+  { "setReverb", l_lovrAudioSetReverb },
+  { "setHRTF", l_lovrAudioSetHRTF },
+  { "render", l_lovrAudioRender },
   { "getSpatializer", l_lovrAudioGetSpatializer },
   { "getSampleRate", l_lovrAudioGetSampleRate },
+  { "getTime", l_lovrAudioGetTime },
   { "getAbsorption", l_lovrAudioGetAbsorption },
   { "setAbsorption", l_lovrAudioSetAbsorption },
   { "newSource", l_lovrAudioNewSource },
+  { "newBus", l_lovrAudioNewBus },
   { NULL, NULL }
 };
 
 extern const luaL_Reg lovrSource[];
+extern const luaL_Reg lovrBus[];
 
 int luaopen_lovr_audio(lua_State* L) {
   lua_newtable(L);
   luax_register(L, lovrAudio);
   luax_registertype(L, Source);
+  luax_registertype(L, Bus);
 
   bool start = true;
   const char *spatializer = NULL;
@@ -0,0 +1,125 @@
+#include "api.h"
+#include "audio/audio.h"
+#include "data/sound.h"
+#include "util.h"
+
+static int l_lovrBusGetParent(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  Bus* parent = lovrBusGetParent(bus);
+  luax_pushtype(L, Bus, parent);
+  return 1;
+}
+
+static int l_lovrBusGetVolume(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  VolumeUnit units = luax_checkenum(L, 2, VolumeUnit, "linear");
+  lua_pushnumber(L, lovrBusGetVolume(bus, units));
+  return 1;
+}
+
+static int l_lovrBusSetVolume(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  float volume = luax_checkfloat(L, 2);
+  VolumeUnit units = luax_checkenum(L, 3, VolumeUnit, "linear");
+  lovrBusSetVolume(bus, volume, units);
+  return 0;
+}
+
+static int l_lovrBusGetFilter(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  FilterType type;
+  float frequency, q, gain;
+  if (!lovrBusGetFilter(bus, &type, &frequency, &q, &gain)) {
+    lua_pushnil(L);
+    return 1;
+  }
+  luax_pushenum(L, FilterType, type);
+  lua_pushnumber(L, frequency);
+  lua_pushnumber(L, q);
+  lua_pushnumber(L, gain);
+  return 4;
+}
+
+static int l_lovrBusSetFilter(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  if (!lua_toboolean(L, 2)) {
+    FilterType type;
+    float frequency, q, gain;
+    lovrBusGetFilter(bus, &type, &frequency, &q, &gain);
+    lovrBusSetFilter(bus, false, type, MAX(frequency, 1.f), MAX(q, .001f), gain);
+    return 0;
+  }
+  FilterType type = luax_checkenum(L, 2, FilterType, NULL);
+  float frequency = luax_checkfloat(L, 3);
+  float q = luax_optfloat(L, 4, .7071f);
+  float gain = luax_optfloat(L, 5, 0.f);
+  lovrBusSetFilter(bus, true, type, frequency, q, gain);
+  return 0;
+}
+
+static int l_lovrBusGetCompressor(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  float threshold, ratio, attack, release, makeup;
+  if (!lovrBusGetCompressor(bus, &threshold, &ratio, &attack, &release, &makeup)) {
+    lua_pushnil(L);
+    return 1;
+  }
+  lua_pushnumber(L, threshold);
+  lua_pushnumber(L, ratio);
+  lua_pushnumber(L, attack);
+  lua_pushnumber(L, release);
+  lua_pushnumber(L, makeup);
+  return 5;
+}
+
+static int l_lovrBusSetCompressor(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  if (lua_isnoneornil(L, 2) || lua_isboolean(L, 2)) {
+    lovrCheck(!lua_toboolean(L, 2), "Expected a threshold, nil, or false");
+    lovrBusSetCompressor(bus, false, 0.f, 1.f, 0.f, 0.f, 0.f);
+    return 0;
+  }
+  float threshold = luax_checkfloat(L, 2);
+  float ratio = luax_optfloat(L, 3, 4.f);
+  float attack = luax_optfloat(L, 4, .01f);
+  float release = luax_optfloat(L, 5, .1f);
+  float makeup = luax_optfloat(L, 6, 0.f);
+  lovrBusSetCompressor(bus, true, threshold, ratio, attack, release, makeup);
+  return 0;
+}
+
+static int l_lovrBusGetReverb(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  float wet, dry;
+  Sound* sound = lovrBusGetReverb(bus, &wet, &dry);
+  if (!sound) {
+    lua_pushnil(L);
+    return 1;
+  }
+  luax_pushtype(L, Sound, sound);
+  lua_pushnumber(L, wet);
+  lua_pushnumber(L, dry);
+  return 3;
+}
+
+static int l_lovrBusSetReverb(lua_State* L) {
+  Bus* bus = luax_checktype(L, 1, Bus);
+  Sound* sound = lua_toboolean(L, 2) ? luax_checktype(L, 2, Sound) : NULL;
+  float wet = luax_optfloat(L, 3, 1.f);
+  float dry = luax_optfloat(L, 4, 1.f);
+  lovrBusSetReverb(bus, sound, wet, dry);
+  return 0;
+}
+
+const luaL_Reg lovrBus[] = {
+  { "getParent", l_lovrBusGetParent },
+  { "getVolume", l_lovrBusGetVolume },
+  { "setVolume", l_lovrBusSetVolume },
+  { "getFilter", l_lovrBusGetFilter },
+  { "setFilter", l_lovrBusSetFilter },
+  { "getCompressor", l_lovrBusGetCompressor },
+  { "setCompressor", l_lovrBusSetCompressor },
+  { "getReverb", l_lovrBusGetReverb },
+  { "setReverb", l_lovrBusSetReverb },
+  { NULL, NULL }
+};
@@ -25,6 +25,14 @@ static int l_lovrSourcePlay(lua_State* L) {
   return 1;
 }
 
+static int l_lovrSourcePlayAt(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  double time = luaL_checknumber(L, 2);
+  bool played = lovrSourcePlayAt(source, time);
+  lua_pushboolean(L, played);
+  return 1;
+}
+
 static int l_lovrSourcePause(lua_State* L) {
   Source* source = luax_checktype(L, 1, Source);
   lovrSourcePause(source);
@@ -37,6 +45,13 @@ static int l_lovrSourceStop(lua_State* L) {
   return 0;
 }
 
+static int l_lovrSourceStopAt(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  double time = luaL_checknumber(L, 2);
+  lovrSourceStopAt(source, time);
+  return 0;
+}
+
 static int l_lovrSourceIsPlaying(lua_State* L) {
   Source* source = luax_checktype(L, 1, Source);
   lua_pushboolean(L, lovrSourceIsPlaying(source));
@@ -218,6 +233,34 @@ static int l_lovrSourceSetEffectEnabled(lua_State* L) {
   return 0;
 }
 
+static int l_lovrSourceGetBus(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  Bus* bus = lovrSourceGetBus(source);
+  luax_pushtype(L, Bus, bus);
+  return 1;
+}
+
+static int l_lovrSourceSetBus(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  Bus* bus = lua_isnoneornil(L, 2) ? NULL : luax_checktype(L, 2, Bus);
+  lovrSourceSetBus(source, bus);
+  return 0;
+}
+
+static int l_lovrSourceGetPriority(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  int32_t priority = lovrSourceGetPriority(source);
+  lua_pushinteger(L, priority);
+  return 1;
+}
+
+static int l_lovrSourceSetPriority(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  int32_t priority = luaL_checkinteger(L, 2);
+  lovrSourceSetPriority(source, priority);
+  return 0;
+}
+
 static int l_lovrSourceIsSpatial(lua_State* L) {
   Source* source = luax_checktype(L, 1, Source);
   bool spatial = lovrSourceIsSpatial(source);
@@ -229,8 +272,10 @@ const luaL_Reg lovrSource[] = {
   { "clone", l_lovrSourceClone },
   { "getSound", l_lovrSourceGetSound },
   { "play", l_lovrSourcePlay },
+  { "playAt", l_lovrSourcePlayAt },
   { "pause", l_lovrSourcePause },
   { "stop", l_lovrSourceStop },
+  { "stopAt", l_lovrSourceStopAt },
   { "isPlaying", l_lovrSourceIsPlaying },
   { "isLooping", l_lovrSourceIsLooping },
   { "setLooping", l_lovrSourceSetLooping },
@@ -253,6 +298,10 @@ const luaL_Reg lovrSource[] = {
   { "setDirectivity", l_lovrSourceSetDirectivity },
   { "isEffectEnabled", l_lovrSourceIsEffectEnabled },
   { "setEffectEnabled", l_lovrSourceSetEffectEnabled },
+  { "getBus", l_lovrSourceGetBus },
+  { "setBus", l_lovrSourceSetBus },
+  { "getPriority", l_lovrSourceGetPriority },
+  { "setPriority", l_lovrSourceSetPriority },
   { "isSpatial", l_lovrSourceIsSpatial },
   { NULL, NULL }
 };
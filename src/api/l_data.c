@@ -137,7 +137,7 @@ static int l_lovrDataNewImage(lua_State* L) {
 }
 
 static int l_lovrDataNewModelData(lua_State* L) {
-  Blob* blob = luax_readblob(L, 1, "Model");
+  Blob* blob = luax_mapblob(L, 1, "Model");
   ModelData* modelData = lovrModelDataCreate(blob, luax_readfile);
   luax_pushtype(L, ModelData, modelData);
   lovrRelease(blob, lovrBlobDestroy);
@@ -192,12 +192,29 @@ static int l_lovrDataNewSound(lua_State* L) {
   return 1;
 }
 
+static int l_lovrDataGetSoundCacheLimit(lua_State* L) {
+  size_t bytes;
+  size_t limit = lovrSoundGetCacheLimit(&bytes);
+  lua_pushnumber(L, (lua_Number) limit);
+  lua_pushnumber(L, (lua_Number) bytes);
+  return 2;
+}
+
+static int l_lovrDataSetSoundCacheLimit(lua_State* L) {
+  lua_Number limit = luaL_checknumber(L, 1);
+  lovrCheck(limit >= 0, "Sound cache limit can not be negative");
+  lovrSoundSetCacheLimit((size_t) limit);
+  return 0;
+}
+
 static const luaL_Reg lovrData[] = {
   { "newBlob", l_lovrDataNewBlob },
   { "newImage", l_lovrDataNewImage },
   { "newModelData", l_lovrDataNewModelData },
   { "newRasterizer", l_lovrDataNewRasterizer },
   { "newSound", l_lovrDataNewSound },
+  { "getSoundCacheLimit", l_lovrDataGetSoundCacheLimit },
+  { "setSoundCacheLimit", l_lovrDataSetSoundCacheLimit },
   { NULL, NULL }
 };
 
@@ -1,5 +1,6 @@
 #include "api.h"
 #include "data/modelData.h"
+#include "data/blob.h"
 #include "core/maf.h"
 #include "util.h"
 
@@ -738,6 +739,14 @@ static int l_lovrModelDataGetSkinInverseBindMatrix(lua_State* L) {
   return 16;
 }
 
+static int l_lovrModelDataEncode(lua_State* L) {
+  ModelData* model = luax_checktype(L, 1, ModelData);
+  Blob* blob = lovrModelDataEncode(model);
+  luax_pushtype(L, Blob, blob);
+  lovrRelease(blob, lovrBlobDestroy);
+  return 1;
+}
+
 const luaL_Reg lovrModelData[] = {
   { "getMetadata", l_lovrModelDataGetMetadata },
   { "getBlobCount", l_lovrModelDataGetBlobCount },
@@ -790,5 +799,6 @@ const luaL_Reg lovrModelData[] = {
   { "getSkinCount", l_lovrModelDataGetSkinCount },
   { "getSkinJoints", l_lovrModelDataGetSkinJoints },
   { "getSkinInverseBindMatrix", l_lovrModelDataGetSkinInverseBindMatrix },
+  { "encode", l_lovrModelDataEncode },
   { NULL, NULL }
 };
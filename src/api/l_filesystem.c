@@ -32,6 +32,24 @@ Blob* luax_readblob(lua_State* L, int index, const char* debug) {
   }
 }
 
+// Like luax_readblob, but memory maps the file when possible.  Mapped Blobs are copy-on-write, so
+// they behave like regular Blobs, but the file should not be modified while they're alive.
+Blob* luax_mapblob(lua_State* L, int index, const char* debug) {
+  if (lua_type(L, index) != LUA_TUSERDATA) {
+    const char* path = luaL_checkstring(L, index);
+
+    size_t size;
+    void* data = lovrFilesystemMap(path, &size);
+    if (data) {
+      Blob* blob = lovrBlobCreate(data, size, path);
+      blob->mapped = true;
+      return blob;
+    }
+  }
+
+  return luax_readblob(L, index, debug);
+}
+
 static void pushDirectoryItem(void* context, const char* path) {
   lua_State* L = context;
 
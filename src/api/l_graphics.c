@@ -1442,9 +1442,10 @@ static int l_lovrGraphicsNewModel(lua_State* L) {
   ModelInfo info = { 0 };
   info.data = luax_totype(L, 1, ModelData);
   info.mipmaps = true;
+  info.lodError = 1.f;
 
   if (!info.data) {
-    Blob* blob = luax_readblob(L, 1, "Model");
+    Blob* blob = luax_mapblob(L, 1, "Model");
     info.data = lovrModelDataCreate(blob, luax_readfile);
     lovrRelease(blob, lovrBlobDestroy);
   } else {
@@ -1455,6 +1456,34 @@ static int l_lovrGraphicsNewModel(lua_State* L) {
     lua_getfield(L, 2, "mipmaps");
     info.mipmaps = lua_isnil(L, -1) || lua_toboolean(L, -1);
     lua_pop(L, 1);
+
+    lua_getfield(L, 2, "optimize");
+    info.optimize = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 2, "quantize");
+    info.quantize = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 2, "meshlets");
+    info.meshlets = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 2, "lods");
+    if (lua_istable(L, -1)) {
+      info.lodCount = luax_len(L, -1);
+      lovrCheck(info.lodCount <= MAX_MODEL_LODS, "Too many LODs (max is %d)", MAX_MODEL_LODS);
+      for (uint32_t i = 0; i < info.lodCount; i++) {
+        lua_rawgeti(L, -1, i + 1);
+        info.lodRatios[i] = luax_checkfloat(L, -1);
+        lua_pop(L, 1);
+      }
+    }
+    lua_pop(L, 1);
+
+    lua_getfield(L, 2, "lodError");
+    info.lodError = luax_optfloat(L, -1, 1.f);
+    lua_pop(L, 1);
   }
 
   Model* model = lovrModelCreate(&info);
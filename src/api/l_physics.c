@@ -1,7 +1,14 @@
 #include "api.h"
 #include "physics/physics.h"
+#include "core/os.h"
 #include "util.h"
 
+StringEntry lovrPoseLayout[] = {
+  [POSE_VECTORS] = ENTRY("vectors"),
+  [POSE_MATRIX] = ENTRY("matrix"),
+  { 0 }
+};
+
 StringEntry lovrShapeType[] = {
   [SHAPE_SPHERE] = ENTRY("sphere"),
   [SHAPE_BOX] = ENTRY("box"),
@@ -9,6 +16,21 @@ StringEntry lovrShapeType[] = {
   [SHAPE_CYLINDER] = ENTRY("cylinder"),
   [SHAPE_MESH] = ENTRY("mesh"),
   [SHAPE_TERRAIN] = ENTRY("terrain"),
+  [SHAPE_CONVEX] = ENTRY("convex"),
+  { 0 }
+};
+
+StringEntry lovrBroadphaseType[] = {
+  [BROADPHASE_HASH] = ENTRY("hash"),
+  [BROADPHASE_SAP] = ENTRY("sap"),
+  [BROADPHASE_QUADTREE] = ENTRY("quadtree"),
+  { 0 }
+};
+
+StringEntry lovrContactEventType[] = {
+  [CONTACT_BEGIN] = ENTRY("begin"),
+  [CONTACT_PERSIST] = ENTRY("persist"),
+  [CONTACT_END] = ENTRY("end"),
   { 0 }
 };
 
@@ -20,17 +42,32 @@ StringEntry lovrJointType[] = {
   { 0 }
 };
 
+static void luax_readworldvec3(lua_State* L, int index, float* v, const char* name) {
+  if (lua_istable(L, index)) {
+    for (int i = 0; i < 3; i++) {
+      lua_rawgeti(L, index, i + 1);
+      v[i] = luax_checkfloat(L, -1);
+      lua_pop(L, 1);
+    }
+  } else if (!lua_isnil(L, index)) {
+    luax_readvec3(L, index, v, name);
+  }
+}
+
 static int l_lovrPhysicsNewWorld(lua_State* L) {
-  float xg = luax_optfloat(L, 1, 0.f);
-  float yg = luax_optfloat(L, 2, -9.81f);
-  float zg = luax_optfloat(L, 3, 0.f);
-  bool allowSleep = lua_gettop(L) < 4 || lua_toboolean(L, 4);
+  WorldInfo info = {
+    .gravity = { luax_optfloat(L, 1, 0.f), luax_optfloat(L, 2, -9.81f), luax_optfloat(L, 3, 0.f) },
+    .allowSleep = lua_gettop(L) < 4 || lua_toboolean(L, 4),
+    .broadphase = BROADPHASE_HASH,
+    .extents = { 100.f, 100.f, 100.f },
+    .depth = 6
+  };
   const char* tags[16];
-  int tagCount;
   if (lua_type(L, 5) == LUA_TTABLE) {
-    tagCount = luax_len(L, 5);
-    for (int i = 0; i < tagCount; i++) {
-      lua_rawgeti(L, -1, i + 1);
+    info.tagCount = luax_len(L, 5);
+    lovrCheck(info.tagCount <= 16, "Max number of world tags is 16");
+    for (uint32_t i = 0; i < info.tagCount; i++) {
+      lua_rawgeti(L, 5, i + 1);
       if (lua_isstring(L, -1)) {
         tags[i] = lua_tostring(L, -1);
       } else {
@@ -38,10 +75,40 @@ static int l_lovrPhysicsNewWorld(lua_State* L) {
       }
       lua_pop(L, 1);
     }
-  } else {
-    tagCount = 0;
+    info.tags = tags;
+  }
+  if (lua_istable(L, 6)) {
+    lua_getfield(L, 6, "broadphase");
+    info.broadphase = luax_checkenum(L, -1, BroadphaseType, "hash");
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "center");
+    luax_readworldvec3(L, lua_gettop(L), info.center, "table or vec3");
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "extents");
+    luax_readworldvec3(L, lua_gettop(L), info.extents, "table or vec3");
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "depth");
+    info.depth = luaL_optinteger(L, -1, info.depth);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "stats");
+    info.stats = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "threads");
+    if (lua_type(L, -1) == LUA_TBOOLEAN) {
+      info.threadCount = lua_toboolean(L, -1) ? MIN(os_get_core_count(), MAX_THREADS) : 0;
+    } else {
+      lua_Integer threads = luaL_optinteger(L, -1, 0);
+      lovrCheck(threads >= 0 && threads <= MAX_THREADS, "World thread count must be between 0 and %d", MAX_THREADS);
+      info.threadCount = (uint32_t) threads;
+    }
+    lua_pop(L, 1);
   }
-  World* world = lovrWorldCreate(xg, yg, zg, allowSleep, tags, tagCount);
+  World* world = lovrWorldCreate(&info);
   luax_pushtype(L, World, world);
   lovrRelease(world, lovrWorldDestroy);
   return 1;
@@ -72,6 +139,13 @@ static int l_lovrPhysicsNewCapsuleShape(lua_State* L) {
   return 1;
 }
 
+static int l_lovrPhysicsNewConvexShape(lua_State* L) {
+  ConvexShape* convex = luax_newconvexshape(L, 1);
+  luax_pushtype(L, ConvexShape, convex);
+  lovrRelease(convex, lovrShapeDestroy);
+  return 1;
+}
+
 static int l_lovrPhysicsNewCylinderShape(lua_State* L) {
   CylinderShape* cylinder = luax_newcylindershape(L, 1);
   luax_pushtype(L, CylinderShape, cylinder);
@@ -141,6 +215,7 @@ static const luaL_Reg lovrPhysics[] = {
   { "newBallJoint", l_lovrPhysicsNewBallJoint },
   { "newBoxShape", l_lovrPhysicsNewBoxShape },
   { "newCapsuleShape", l_lovrPhysicsNewCapsuleShape },
+  { "newConvexShape", l_lovrPhysicsNewConvexShape },
   { "newCylinderShape", l_lovrPhysicsNewCylinderShape },
   { "newDistanceJoint", l_lovrPhysicsNewDistanceJoint },
   { "newHingeJoint", l_lovrPhysicsNewHingeJoint },
@@ -163,6 +238,7 @@ extern const luaL_Reg lovrCapsuleShape[];
 extern const luaL_Reg lovrCylinderShape[];
 extern const luaL_Reg lovrMeshShape[];
 extern const luaL_Reg lovrTerrainShape[];
+extern const luaL_Reg lovrConvexShape[];
 
 int luaopen_lovr_physics(lua_State* L) {
   lua_newtable(L);
@@ -179,6 +255,7 @@ int luaopen_lovr_physics(lua_State* L) {
   luax_registertype(L, CylinderShape);
   luax_registertype(L, MeshShape);
   luax_registertype(L, TerrainShape);
+  luax_registertype(L, ConvexShape);
   if (lovrPhysicsInit()) {
     luax_atexit(L, lovrPhysicsDestroy);
   }
@@ -92,6 +92,19 @@ static int l_lovrColliderSetKinematic(lua_State* L) {
   return 0;
 }
 
+static int l_lovrColliderIsStatic(lua_State* L) {
+  Collider* collider = luax_checktype(L, 1, Collider);
+  lua_pushboolean(L, lovrColliderIsStatic(collider));
+  return 1;
+}
+
+static int l_lovrColliderSetStatic(lua_State* L) {
+  Collider* collider = luax_checktype(L, 1, Collider);
+  bool isStatic = lua_toboolean(L, 2);
+  lovrColliderSetStatic(collider, isStatic);
+  return 0;
+}
+
 static int l_lovrColliderIsGravityIgnored(lua_State* L) {
   Collider* collider = luax_checktype(L, 1, Collider);
   lua_pushboolean(L, lovrColliderIsGravityIgnored(collider));
@@ -245,6 +258,21 @@ static int l_lovrColliderGetPose(lua_State* L) {
   return 7;
 }
 
+static int l_lovrColliderGetInterpolatedPose(lua_State* L) {
+  Collider* collider = luax_checktype(L, 1, Collider);
+  float position[4], orientation[4], angle, ax, ay, az;
+  lovrColliderGetInterpolatedPose(collider, position, orientation);
+  quat_getAngleAxis(orientation, &angle, &ax, &ay, &az);
+  lua_pushnumber(L, position[0]);
+  lua_pushnumber(L, position[1]);
+  lua_pushnumber(L, position[2]);
+  lua_pushnumber(L, angle);
+  lua_pushnumber(L, ax);
+  lua_pushnumber(L, ay);
+  lua_pushnumber(L, az);
+  return 7;
+}
+
 static int l_lovrColliderSetPose(lua_State* L) {
   Collider* collider = luax_checktype(L, 1, Collider);
   float position[4], orientation[4];
@@ -500,6 +528,8 @@ const luaL_Reg lovrCollider[] = {
   { "setUserData", l_lovrColliderSetUserData },
   { "isKinematic", l_lovrColliderIsKinematic },
   { "setKinematic", l_lovrColliderSetKinematic },
+  { "isStatic", l_lovrColliderIsStatic },
+  { "setStatic", l_lovrColliderSetStatic },
   { "isGravityIgnored", l_lovrColliderIsGravityIgnored },
   { "setGravityIgnored", l_lovrColliderSetGravityIgnored },
   { "isSleepingAllowed", l_lovrColliderIsSleepingAllowed },
@@ -516,6 +546,7 @@ const luaL_Reg lovrCollider[] = {
   { "setOrientation", l_lovrColliderSetOrientation },
   { "getPose", l_lovrColliderGetPose },
   { "setPose", l_lovrColliderSetPose },
+  { "getInterpolatedPose", l_lovrColliderGetInterpolatedPose },
   { "getLinearVelocity", l_lovrColliderGetLinearVelocity },
   { "setLinearVelocity", l_lovrColliderSetLinearVelocity },
   { "getAngularVelocity", l_lovrColliderGetAngularVelocity },
@@ -14,6 +14,7 @@ void luax_pushshape(lua_State* L, Shape* shape) {
     case SHAPE_CYLINDER: luax_pushtype(L, CylinderShape, shape); break;
     case SHAPE_MESH: luax_pushtype(L, MeshShape, shape); break;
     case SHAPE_TERRAIN: luax_pushtype(L, TerrainShape, shape); break;
+    case SHAPE_CONVEX: luax_pushtype(L, ConvexShape, shape); break;
     default: lovrUnreachable();
   }
 }
@@ -28,7 +29,8 @@ Shape* luax_checkshape(lua_State* L, int index) {
       hash64("CapsuleShape", strlen("CapsuleShape")),
       hash64("CylinderShape", strlen("CylinderShape")),
       hash64("MeshShape", strlen("MeshShape")),
-      hash64("TerrainShape", strlen("TerrainShape"))
+      hash64("TerrainShape", strlen("TerrainShape")),
+      hash64("ConvexShape", strlen("ConvexShape"))
     };
 
     for (size_t i = 0; i < COUNTOF(hashes); i++) {
@@ -91,6 +93,58 @@ Shape* luax_newmeshshape(lua_State* L, int index) {
   return lovrMeshShapeCreate(vertexCount, vertices, indexCount, indices);
 }
 
+Shape* luax_newconvexshape(lua_State* L, int index) {
+  float* points;
+  uint32_t count;
+
+  // A table of points (flat or nested), or anything luax_readmesh accepts, using all its vertices
+  if (lua_istable(L, index) && lua_type(L, index + 1) != LUA_TTABLE) {
+    lua_rawgeti(L, index, 1);
+    bool nested = lua_type(L, -1) == LUA_TTABLE;
+    lua_pop(L, 1);
+
+    count = luax_len(L, index) / (nested ? 1 : 3);
+    lovrCheck(count >= 4, "ConvexShape needs at least 4 points");
+    points = lua_newuserdata(L, 3 * count * sizeof(float)); // Collected if reading a point throws
+
+    if (nested) {
+      for (uint32_t i = 0; i < count; i++) {
+        lua_rawgeti(L, index, i + 1);
+        lua_rawgeti(L, -1, 1);
+        lua_rawgeti(L, -2, 2);
+        lua_rawgeti(L, -3, 3);
+        points[3 * i + 0] = luax_checkfloat(L, -3);
+        points[3 * i + 1] = luax_checkfloat(L, -2);
+        points[3 * i + 2] = luax_checkfloat(L, -1);
+        lua_pop(L, 4);
+      }
+    } else {
+      for (uint32_t i = 0; i < 3 * count; i++) {
+        lua_rawgeti(L, index, i + 1);
+        points[i] = luax_checkfloat(L, -1);
+        lua_pop(L, 1);
+      }
+    }
+
+    ConvexShape* convex = lovrConvexShapeCreate(points, count);
+    lua_pop(L, 1);
+    return convex;
+  }
+
+  uint32_t* indices;
+  uint32_t indexCount;
+  bool shouldFree;
+  luax_readmesh(L, index, &points, &count, &indices, &indexCount, &shouldFree);
+  ConvexShape* convex = lovrConvexShapeCreate(points, count);
+
+  if (shouldFree) {
+    free(points);
+    free(indices);
+  }
+
+  return convex;
+}
+
 Shape* luax_newterrainshape(lua_State* L, int index) {
   float horizontalScale = luax_checkfloat(L, index++);
   int type = lua_type(L, index);
@@ -415,3 +469,34 @@ const luaL_Reg lovrTerrainShape[] = {
   lovrShape,
   { NULL, NULL }
 };
+
+static int l_lovrConvexShapeGetPointCount(lua_State* L) {
+  ConvexShape* convex = luax_checktype(L, 1, ConvexShape);
+  lua_pushinteger(L, lovrConvexShapeGetPointCount(convex));
+  return 1;
+}
+
+static int l_lovrConvexShapeGetPoint(lua_State* L) {
+  ConvexShape* convex = luax_checktype(L, 1, ConvexShape);
+  uint32_t index = luax_checku32(L, 2) - 1;
+  float point[3];
+  lovrConvexShapeGetPoint(convex, index, point);
+  lua_pushnumber(L, point[0]);
+  lua_pushnumber(L, point[1]);
+  lua_pushnumber(L, point[2]);
+  return 3;
+}
+
+static int l_lovrConvexShapeGetFaceCount(lua_State* L) {
+  ConvexShape* convex = luax_checktype(L, 1, ConvexShape);
+  lua_pushinteger(L, lovrConvexShapeGetFaceCount(convex));
+  return 1;
+}
+
+const luaL_Reg lovrConvexShape[] = {
+  lovrShape,
+  { "getPointCount", l_lovrConvexShapeGetPointCount },
+  { "getPoint", l_lovrConvexShapeGetPoint },
+  { "getFaceCount", l_lovrConvexShapeGetFaceCount },
+  { NULL, NULL }
+};
@@ -1,7 +1,12 @@
 #include "api.h"
 #include "physics/physics.h"
+#include "data/blob.h"
+#ifndef LOVR_DISABLE_GRAPHICS
+#include "graphics/graphics.h"
+#endif
 #include "util.h"
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 static void collisionResolver(World* world, void* userdata) {
@@ -117,6 +122,65 @@ static int l_lovrWorldNewMeshCollider(lua_State* L) {
   return 1;
 }
 
+static int l_lovrWorldNewConvexCollider(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  float position[4];
+  int index = luax_readvec3(L, 2, position, NULL);
+
+  // Points are hulled directly, triangles can optionally be split into multiple convex pieces
+  bool points = lua_istable(L, index) && lua_type(L, index + 1) != LUA_TTABLE;
+  int options = index + (lua_istable(L, index) ? 2 : 1);
+  uint32_t maxShapes = points ? 1 : luax_optu32(L, options, 1);
+
+  if (maxShapes <= 1) {
+    Collider* collider = lovrColliderCreate(world, position[0], position[1], position[2]);
+    ConvexShape* shape = luax_newconvexshape(L, index);
+    lovrColliderAddShape(collider, shape);
+    lovrColliderInitInertia(collider, shape);
+    luax_pushtype(L, Collider, collider);
+    lovrRelease(collider, lovrColliderDestroy);
+    lovrRelease(shape, lovrShapeDestroy);
+    return 1;
+  }
+
+  float concavity = luax_optfloat(L, options + 1, .05f);
+
+  float* vertices;
+  uint32_t* indices;
+  uint32_t vertexCount, indexCount;
+  bool shouldFree;
+  luax_readmesh(L, index, &vertices, &vertexCount, &indices, &indexCount, &shouldFree);
+
+  // Every shape has at least one triangle, so there's no point in asking for more
+  maxShapes = MIN(maxShapes, indexCount / 3);
+  ConvexShape** shapes = malloc(maxShapes * sizeof(ConvexShape*));
+  lovrAssert(shapes || maxShapes == 0, "Out of memory");
+  uint32_t count = lovrConvexShapeDecompose(vertices, vertexCount, indices, indexCount, maxShapes, concavity, shapes);
+
+  if (shouldFree) {
+    free(vertices);
+    free(indices);
+  }
+
+  if (count == 0) {
+    free(shapes);
+    return luaL_error(L, "Mesh does not have any volume to make ConvexShapes from");
+  }
+
+  Collider* collider = lovrColliderCreate(world, position[0], position[1], position[2]);
+
+  for (uint32_t i = 0; i < count; i++) {
+    lovrColliderAddShape(collider, shapes[i]);
+    lovrRelease(shapes[i], lovrShapeDestroy);
+  }
+
+  lovrColliderInitInertia(collider, NULL);
+  luax_pushtype(L, Collider, collider);
+  lovrRelease(collider, lovrColliderDestroy);
+  free(shapes);
+  return 1;
+}
+
 static int l_lovrWorldNewTerrainCollider(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
   Collider* collider = lovrColliderCreate(world, 0.f, 0.f, 0.f);
@@ -174,7 +238,62 @@ static int l_lovrWorldUpdate(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
   float dt = luax_checkfloat(L, 2);
   CollisionResolver resolver = lua_type(L, 3) == LUA_TFUNCTION ? collisionResolver : NULL;
-  lovrWorldUpdate(world, dt, resolver, L);
+  uint32_t steps = lovrWorldUpdate(world, dt, resolver, L);
+  lua_pushinteger(L, steps);
+  return 1;
+}
+
+static int l_lovrWorldGetStats(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  WorldStats stats;
+  lovrWorldGetStats(world, &stats);
+
+  if (lua_istable(L, 2)) {
+    lua_settop(L, 2);
+  } else {
+    lua_settop(L, 1);
+    lua_createtable(L, 0, 8);
+  }
+
+  lua_pushnumber(L, stats.broadphaseTime);
+  lua_setfield(L, -2, "broadphaseTime");
+  lua_pushnumber(L, stats.narrowphaseTime);
+  lua_setfield(L, -2, "narrowphaseTime");
+  lua_pushnumber(L, stats.solverTime);
+  lua_setfield(L, -2, "solverTime");
+  lua_pushinteger(L, stats.stepCount);
+  lua_setfield(L, -2, "steps");
+  lua_pushinteger(L, stats.pairCount);
+  lua_setfield(L, -2, "pairs");
+  lua_pushinteger(L, stats.contactCount);
+  lua_setfield(L, -2, "contacts");
+  lua_pushinteger(L, stats.islandCount);
+  lua_setfield(L, -2, "islands");
+  lua_pushinteger(L, stats.awakeCount);
+  lua_setfield(L, -2, "awake");
+  return 1;
+}
+
+static int l_lovrWorldGetTimestep(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  uint32_t maxSteps;
+  float timestep = lovrWorldGetTimestep(world, &maxSteps);
+  if (timestep > 0.f) {
+    lua_pushnumber(L, timestep);
+    lua_pushinteger(L, maxSteps);
+    return 2;
+  }
+  lua_pushnil(L);
+  return 1;
+}
+
+static int l_lovrWorldSetTimestep(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  float timestep = luax_optfloat(L, 2, 0.f);
+  uint32_t maxSteps = luax_optu32(L, 3, 4);
+  lovrCheck(timestep >= 0.f, "Timestep can not be negative");
+  lovrCheck(timestep == 0.f || maxSteps > 0, "Max steps must be positive when using a fixed timestep");
+  lovrWorldSetTimestep(world, timestep, maxSteps);
   return 0;
 }
 
@@ -201,6 +320,49 @@ static int l_lovrWorldCollide(lua_State* L) {
   return 1;
 }
 
+// Events are flattened into one table, 10 values per event: type, shapeA, shapeB, x, y, z, nx, ny,
+// nz, impulse.  A table can be passed in to reuse it between frames.
+static int l_lovrWorldGetContactEvents(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  uint32_t count;
+  ContactEvent* events = lovrWorldGetContactEvents(world, &count);
+
+  if (lua_istable(L, 2)) {
+    lua_settop(L, 2);
+  } else {
+    lua_settop(L, 1);
+    lua_createtable(L, count * 10, 0);
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    ContactEvent* event = &events[i];
+    int base = i * 10;
+    luax_pushenum(L, ContactEventType, event->type);
+    lua_rawseti(L, 2, base + 1);
+    luax_pushshape(L, event->a);
+    lua_rawseti(L, 2, base + 2);
+    luax_pushshape(L, event->b);
+    lua_rawseti(L, 2, base + 3);
+    for (int j = 0; j < 3; j++) {
+      lua_pushnumber(L, event->position[j]);
+      lua_rawseti(L, 2, base + 4 + j);
+      lua_pushnumber(L, event->normal[j]);
+      lua_rawseti(L, 2, base + 7 + j);
+    }
+    lua_pushnumber(L, event->impulse);
+    lua_rawseti(L, 2, base + 10);
+  }
+
+  // Clear leftovers from a reused table
+  for (int i = luax_len(L, 2); i > (int) count * 10; i--) {
+    lua_pushnil(L);
+    lua_rawseti(L, 2, i);
+  }
+
+  lua_pushinteger(L, count);
+  return 2;
+}
+
 static int l_lovrWorldGetContacts(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
   Shape* a = luax_checkshape(L, 2);
@@ -242,6 +404,244 @@ static int l_lovrWorldRaycast(lua_State* L) {
   return 0;
 }
 
+static int luax_pushhit(lua_State* L, RaycastHit* hit) {
+  luax_pushshape(L, hit->shape);
+  lua_pushnumber(L, hit->position[0]);
+  lua_pushnumber(L, hit->position[1]);
+  lua_pushnumber(L, hit->position[2]);
+  lua_pushnumber(L, hit->normal[0]);
+  lua_pushnumber(L, hit->normal[1]);
+  lua_pushnumber(L, hit->normal[2]);
+  lua_pushnumber(L, hit->distance);
+  return 8;
+}
+
+// Reads a tag name or a table of tag names into a bitmask, nil means all colliders (even untagged)
+static uint32_t luax_checktagmask(lua_State* L, int index, World* world) {
+  switch (lua_type(L, index)) {
+    case LUA_TNONE:
+    case LUA_TNIL:
+      return ~0u;
+    case LUA_TSTRING: {
+      const char* name = lua_tostring(L, index);
+      uint32_t tag = lovrWorldGetTag(world, name);
+      lovrCheck(tag != NO_TAG, "Unknown tag '%s'", name);
+      return 1u << tag;
+    }
+    case LUA_TTABLE: {
+      uint32_t mask = 0;
+      int length = luax_len(L, index);
+      for (int i = 0; i < length; i++) {
+        lua_rawgeti(L, index, i + 1);
+        const char* name = luaL_checkstring(L, -1);
+        uint32_t tag = lovrWorldGetTag(world, name);
+        lovrCheck(tag != NO_TAG, "Unknown tag '%s'", name);
+        mask |= 1u << tag;
+        lua_pop(L, 1);
+      }
+      return mask;
+    }
+    default: return luax_typeerror(L, index, "string, table, or nil");
+  }
+}
+
+static int raycastFirst(lua_State* L, bool any) {
+  World* world = luax_checktype(L, 1, World);
+  float start[4], end[4];
+  int index;
+  index = luax_readvec3(L, 2, start, NULL);
+  index = luax_readvec3(L, index, end, NULL);
+  uint32_t mask = luax_checktagmask(L, index, world);
+  RaycastHit hit;
+  if (lovrWorldRaycastFirst(world, start, end, mask, any, &hit)) {
+    return luax_pushhit(L, &hit);
+  }
+  lua_pushnil(L);
+  return 1;
+}
+
+static int l_lovrWorldRaycastClosest(lua_State* L) {
+  return raycastFirst(L, false);
+}
+
+static int l_lovrWorldRaycastAny(lua_State* L) {
+  return raycastFirst(L, true);
+}
+
+static int l_lovrWorldRaycastBatch(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  Blob* rays = luax_checktype(L, 2, Blob);
+  uint32_t count = rays->size / (6 * sizeof(float));
+  size_t size = count * 8 * sizeof(float);
+  uint32_t mask = luax_checktagmask(L, 5, world);
+
+  Blob* results = luax_totype(L, 3, Blob);
+  if (results) {
+    lovrCheck(results->size >= size, "Raycast result Blob is too small (%d rays need %d bytes)", count, (int) size);
+    lua_pushvalue(L, 3);
+  } else {
+    void* data = malloc(size);
+    lovrAssert(data || size == 0, "Out of memory");
+    results = lovrBlobCreate(data, size, "Raycast results");
+    luax_pushtype(L, Blob, results);
+    lovrRelease(results, lovrBlobDestroy);
+  }
+
+  RaycastHit* hits = malloc(count * sizeof(RaycastHit));
+  lovrAssert(hits || count == 0, "Out of memory");
+  uint32_t hitCount = lovrWorldRaycastBatch(world, rays->data, count, mask, hits);
+
+  // Each result is the hit position, normal, distance, and 1 if the ray hit something (0 otherwise)
+  bool shapes = lua_istable(L, 4);
+  float* result = results->data;
+  for (uint32_t i = 0; i < count; i++, result += 8) {
+    RaycastHit* hit = &hits[i];
+    if (hit->shape) {
+      memcpy(result + 0, hit->position, 3 * sizeof(float));
+      memcpy(result + 3, hit->normal, 3 * sizeof(float));
+      result[6] = hit->distance;
+      result[7] = 1.f;
+    } else {
+      memset(result, 0, 8 * sizeof(float));
+    }
+
+    if (shapes) {
+      if (hit->shape) {
+        luax_pushshape(L, hit->shape);
+      } else {
+        lua_pushboolean(L, false);
+      }
+      lua_rawseti(L, 4, i + 1);
+    }
+  }
+
+  free(hits);
+  lua_pushinteger(L, hitCount);
+  return 2;
+}
+
+static int l_lovrWorldSpherecast(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  float start[4], end[4];
+  int index;
+  index = luax_readvec3(L, 2, start, NULL);
+  index = luax_readvec3(L, index, end, NULL);
+  float radius = luax_checkfloat(L, index);
+  RaycastHit hit;
+  if (lovrWorldSpherecast(world, radius, start, end, &hit)) {
+    return luax_pushhit(L, &hit);
+  }
+  lua_pushnil(L);
+  return 1;
+}
+
+static int l_lovrWorldBoxcast(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  float start[4], end[4], size[4], orientation[4];
+  int index;
+  index = luax_readvec3(L, 2, start, NULL);
+  index = luax_readvec3(L, index, end, NULL);
+  index = luax_readscale(L, index, size, 3, NULL);
+  luax_readquat(L, index, orientation, NULL);
+  RaycastHit hit;
+  if (lovrWorldBoxcast(world, size, orientation, start, end, &hit)) {
+    return luax_pushhit(L, &hit);
+  }
+  lua_pushnil(L);
+  return 1;
+}
+
+// A missing table means all of the World's colliders, in list order.  The array is scratch memory
+// owned by the Lua stack so it doesn't leak if a type check throws.
+static Collider** luax_readcolliders(lua_State* L, int index, World* world, uint32_t* count) {
+  if (lua_isnoneornil(L, index)) {
+    *count = lovrWorldGetColliderCount(world);
+    return NULL;
+  }
+
+  luaL_checktype(L, index, LUA_TTABLE);
+  *count = luax_len(L, index);
+  Collider** colliders = lua_newuserdata(L, *count * sizeof(Collider*));
+  for (uint32_t i = 0; i < *count; i++) {
+    lua_rawgeti(L, index, i + 1);
+    colliders[i] = luax_checktype(L, -1, Collider);
+    lovrCheck(lovrColliderGetWorld(colliders[i]) == world, "Collider belongs to a different World");
+    lua_pop(L, 1);
+  }
+  return colliders;
+}
+
+static int l_lovrWorldGetPoses(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  uint32_t count;
+  Collider** colliders = luax_readcolliders(L, 3, world, &count);
+  PoseLayout layout = luax_checkenum(L, 4, PoseLayout, "vectors");
+  bool interpolate = lua_toboolean(L, 5);
+  size_t size = count * (layout == POSE_MATRIX ? 16 : 8) * sizeof(float);
+  float* poses;
+
+  Blob* blob = luax_totype(L, 2, Blob);
+  if (blob) {
+    lovrCheck(blob->size >= size, "Blob is too small to hold %d poses", count);
+    poses = blob->data;
+  } else {
+#ifndef LOVR_DISABLE_GRAPHICS
+    // Permanent Buffers can only be written by a Pass, poses for them go through a Blob and Pass:copy
+    Buffer* buffer = luax_checkbuffer(L, 2);
+    lovrCheck(lovrBufferIsTemporary(buffer), "Poses can only be written to temporary Buffers (use a Blob and Pass:copy for permanent Buffers)");
+    const BufferInfo* info = lovrBufferGetInfo(buffer);
+    lovrCheck((size_t) info->length * info->stride >= size, "Buffer is too small to hold %d poses", count);
+    poses = size > 0 ? lovrBufferMap(buffer, 0, size) : NULL;
+#else
+    return luax_typeerror(L, 2, "Blob");
+#endif
+  }
+
+  lovrWorldGetPoses(world, colliders, count, layout, interpolate, poses);
+  lua_pushinteger(L, count);
+  return 1;
+}
+
+static int l_lovrWorldSetPoses(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  Blob* blob = luax_checktype(L, 2, Blob);
+  uint32_t count;
+  Collider** colliders = luax_readcolliders(L, 3, world, &count);
+  PoseLayout layout = luax_checkenum(L, 4, PoseLayout, "vectors");
+  size_t size = count * (layout == POSE_MATRIX ? 16 : 8) * sizeof(float);
+  lovrCheck(blob->size >= size, "Blob is too small to contain %d poses", count);
+  lovrWorldSetPoses(world, colliders, count, layout, blob->data);
+  return 0;
+}
+
+static int l_lovrWorldSaveSnapshot(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  size_t size = lovrWorldGetSnapshotSize(world);
+  Blob* blob = luax_totype(L, 2, Blob);
+
+  if (blob) {
+    lovrCheck(blob->size >= size, "Blob is too small to hold a snapshot of the World (need %d bytes)", (int) size);
+    lovrWorldSaveSnapshot(world, blob->data);
+    lua_settop(L, 2);
+    return 1;
+  }
+
+  void* data = malloc(size);
+  lovrAssert(data, "Out of memory");
+  lovrWorldSaveSnapshot(world, data);
+  blob = lovrBlobCreate(data, size, "World snapshot");
+  luax_pushtype(L, Blob, blob);
+  lovrRelease(blob, lovrBlobDestroy);
+  return 1;
+}
+
+static int l_lovrWorldLoadSnapshot(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  Blob* blob = luax_checktype(L, 2, Blob);
+  lovrWorldLoadSnapshot(world, blob->data, blob->size);
+  return 0;
+}
+
 static int l_lovrWorldGetGravity(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
   float x, y, z;
@@ -382,16 +782,30 @@ const luaL_Reg lovrWorld[] = {
   { "newCylinderCollider", l_lovrWorldNewCylinderCollider },
   { "newSphereCollider", l_lovrWorldNewSphereCollider },
   { "newMeshCollider", l_lovrWorldNewMeshCollider },
+  { "newConvexCollider", l_lovrWorldNewConvexCollider },
   { "newTerrainCollider", l_lovrWorldNewTerrainCollider },
   { "getColliders", l_lovrWorldGetColliders },
   { "getTags", l_lovrWorldGetTags },
   { "destroy", l_lovrWorldDestroy },
   { "update", l_lovrWorldUpdate },
+  { "getStats", l_lovrWorldGetStats },
+  { "getTimestep", l_lovrWorldGetTimestep },
+  { "setTimestep", l_lovrWorldSetTimestep },
   { "computeOverlaps", l_lovrWorldComputeOverlaps },
   { "overlaps", l_lovrWorldOverlaps },
   { "collide", l_lovrWorldCollide },
   { "getContacts", l_lovrWorldGetContacts },
+  { "getContactEvents", l_lovrWorldGetContactEvents },
+  { "getPoses", l_lovrWorldGetPoses },
+  { "setPoses", l_lovrWorldSetPoses },
+  { "saveSnapshot", l_lovrWorldSaveSnapshot },
+  { "loadSnapshot", l_lovrWorldLoadSnapshot },
   { "raycast", l_lovrWorldRaycast },
+  { "raycastClosest", l_lovrWorldRaycastClosest },
+  { "raycastAny", l_lovrWorldRaycastAny },
+  { "raycastBatch", l_lovrWorldRaycastBatch },
+  { "spherecast", l_lovrWorldSpherecast },
+  { "boxcast", l_lovrWorldBoxcast },
   { "getGravity", l_lovrWorldGetGravity },
   { "setGravity", l_lovrWorldSetGravity },
   { "getTightness", l_lovrWorldGetTightness },
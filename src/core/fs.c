@@ -81,13 +81,13 @@ void* fs_map(const char* path, size_t* size) {
     *size = lo;
   }
 
-  HANDLE mapping = CreateFileMappingA(file.handle, NULL, PAGE_READONLY, hi, lo, NULL);
+  HANDLE mapping = CreateFileMappingA(file.handle, NULL, PAGE_WRITECOPY, hi, lo, NULL);
   if (mapping == NULL) {
     CloseHandle(file.handle);
     return NULL;
   }
 
-  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, *size);
+  void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, *size);
 
   CloseHandle(mapping);
   CloseHandle(file.handle);
@@ -220,9 +220,9 @@ void* fs_map(const char* path, size_t* size) {
     return NULL;
   }
   *size = info.size;
-  void* data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+  void* data = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file.fd, 0);
   fs_close(file);
-  return data;
+  return data == MAP_FAILED ? NULL : data;
 }
 
 bool fs_unmap(void* data, size_t size) {
@@ -0,0 +1,1276 @@
+#include "mesh.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <float.h>
+
+#define VERTEX_CACHE_SIZE 32
+#define OVERDRAW_CACHE_SIZE 16
+
+static bool mesh_check_indices(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+  for (uint32_t i = 0; i < indexCount; i++) {
+    if (indices[i] >= vertexCount) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static uint64_t mesh_hash(const void* data, size_t length) {
+  const uint8_t* bytes = data;
+  uint64_t hash = 0xcbf29ce484222325;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3;
+  }
+  return hash;
+}
+
+// Weld
+
+uint32_t mesh_weld(uint32_t* indices, uint32_t indexCount, const void* vertices, uint32_t vertexCount, size_t stride) {
+  if (vertexCount == 0 || !mesh_check_indices(indices, indexCount, vertexCount)) {
+    return indexCount;
+  }
+
+  uint32_t capacity = 1;
+  while (capacity < vertexCount * 2) capacity <<= 1;
+  uint32_t mask = capacity - 1;
+
+  uint32_t* table = malloc((capacity + vertexCount) * sizeof(uint32_t));
+  if (!table) return indexCount;
+  uint32_t* canonical = table + capacity;
+  memset(table, 0xff, capacity * sizeof(uint32_t));
+
+  const char* base = vertices;
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    const char* vertex = base + i * stride;
+    uint32_t slot = mesh_hash(vertex, stride) & mask;
+
+    while (table[slot] != ~0u && memcmp(base + table[slot] * stride, vertex, stride)) {
+      slot = (slot + 1) & mask;
+    }
+
+    if (table[slot] == ~0u) {
+      table[slot] = i;
+    }
+
+    canonical[i] = table[slot];
+  }
+
+  uint32_t count = 0;
+  for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
+    uint32_t a = canonical[indices[i + 0]];
+    uint32_t b = canonical[indices[i + 1]];
+    uint32_t c = canonical[indices[i + 2]];
+
+    if (a == b || b == c || c == a) {
+      continue;
+    }
+
+    indices[count++] = a;
+    indices[count++] = b;
+    indices[count++] = c;
+  }
+
+  free(table);
+  return count;
+}
+
+// Vertex cache (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+
+static float forsythScore(const float* cacheScores, int32_t position, uint32_t remaining) {
+  if (remaining == 0) return -1.f;
+  float score = position >= 0 ? cacheScores[position] : 0.f;
+  return score + 2.f / sqrtf((float) remaining);
+}
+
+void mesh_optimize_vertex_cache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+  uint32_t triangleCount = indexCount / 3;
+
+  if (triangleCount < 2 || !mesh_check_indices(indices, triangleCount * 3, vertexCount)) {
+    return;
+  }
+
+  float cacheScores[VERTEX_CACHE_SIZE];
+  for (int32_t i = 0; i < VERTEX_CACHE_SIZE; i++) {
+    cacheScores[i] = i < 3 ? .75f : powf(1.f - (i - 3) / (float) (VERTEX_CACHE_SIZE - 3), 1.5f);
+  }
+
+  // Everything is 4 bytes, so it goes in one allocation
+  size_t words = 0;
+  words += vertexCount + 1; // offsets
+  words += vertexCount; // remaining
+  words += vertexCount; // position
+  words += vertexCount; // vertexScores
+  words += triangleCount; // triangleScores
+  words += triangleCount; // emitted
+  words += triangleCount * 3; // adjacency
+  words += triangleCount * 3; // output
+
+  uint32_t* memory = calloc(words, sizeof(uint32_t));
+  if (!memory) return;
+
+  uint32_t* offsets = memory;
+  uint32_t* remaining = offsets + vertexCount + 1;
+  int32_t* position = (int32_t*) (remaining + vertexCount);
+  float* vertexScores = (float*) (position + vertexCount);
+  float* triangleScores = vertexScores + vertexCount;
+  uint32_t* emitted = (uint32_t*) (triangleScores + triangleCount);
+  uint32_t* adjacency = emitted + triangleCount;
+  uint32_t* output = adjacency + triangleCount * 3;
+
+  for (uint32_t i = 0; i < triangleCount * 3; i++) {
+    remaining[indices[i]]++;
+  }
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    offsets[i + 1] = offsets[i] + remaining[i];
+    remaining[i] = 0;
+  }
+
+  for (uint32_t i = 0; i < triangleCount * 3; i++) {
+    uint32_t v = indices[i];
+    adjacency[offsets[v] + remaining[v]++] = i / 3;
+  }
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    position[i] = -1;
+    vertexScores[i] = forsythScore(cacheScores, -1, remaining[i]);
+  }
+
+  uint32_t best = 0;
+  for (uint32_t i = 0; i < triangleCount; i++) {
+    uint32_t* t = indices + 3 * i;
+    triangleScores[i] = vertexScores[t[0]] + vertexScores[t[1]] + vertexScores[t[2]];
+    if (triangleScores[i] > triangleScores[best]) {
+      best = i;
+    }
+  }
+
+  uint32_t cache[VERTEX_CACHE_SIZE + 3];
+  uint32_t cacheCount = 0;
+  uint32_t cursor = 0;
+
+  for (uint32_t n = 0; n < triangleCount; n++) {
+    if (best == ~0u) {
+      while (emitted[cursor]) cursor++;
+      best = cursor;
+    }
+
+    uint32_t* t = indices + 3 * best;
+    memcpy(output + 3 * n, t, 3 * sizeof(uint32_t));
+    emitted[best] = 1;
+
+    // Remove the triangle from the adjacency list of its vertices
+    for (uint32_t i = 0; i < 3; i++) {
+      uint32_t* list = adjacency + offsets[t[i]];
+      for (uint32_t j = 0; j < remaining[t[i]]; j++) {
+        if (list[j] == best) {
+          list[j] = list[--remaining[t[i]]];
+          break;
+        }
+      }
+    }
+
+    // Push the triangle's vertices to the front of the cache, the last few fall off the end
+    uint32_t next[VERTEX_CACHE_SIZE + 3];
+    uint32_t nextCount = 3;
+    memcpy(next, t, 3 * sizeof(uint32_t));
+    for (uint32_t i = 0; i < cacheCount; i++) {
+      uint32_t v = cache[i];
+      if (v != t[0] && v != t[1] && v != t[2]) {
+        next[nextCount++] = v;
+      }
+    }
+
+    for (uint32_t i = 0; i < nextCount; i++) {
+      uint32_t v = next[i];
+      position[v] = i < VERTEX_CACHE_SIZE ? (int32_t) i : -1;
+      vertexScores[v] = forsythScore(cacheScores, position[v], remaining[v]);
+    }
+
+    best = ~0u;
+    float bestScore = -1.f;
+    for (uint32_t i = 0; i < nextCount; i++) {
+      uint32_t v = next[i];
+      uint32_t* list = adjacency + offsets[v];
+      for (uint32_t j = 0; j < remaining[v]; j++) {
+        uint32_t* u = indices + 3 * list[j];
+        float score = triangleScores[list[j]] = vertexScores[u[0]] + vertexScores[u[1]] + vertexScores[u[2]];
+        if (score > bestScore) {
+          bestScore = score;
+          best = list[j];
+        }
+      }
+    }
+
+    cacheCount = nextCount < VERTEX_CACHE_SIZE ? nextCount : VERTEX_CACHE_SIZE;
+    memcpy(cache, next, cacheCount * sizeof(uint32_t));
+  }
+
+  memcpy(indices, output, triangleCount * 3 * sizeof(uint32_t));
+  free(memory);
+}
+
+// Overdraw (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+
+typedef struct {
+  float key;
+  uint32_t index;
+} mesh_cluster;
+
+static int mesh_cluster_compare(const void* a, const void* b) {
+  float x = ((const mesh_cluster*) a)->key;
+  float y = ((const mesh_cluster*) b)->key;
+  return (x < y) - (x > y);
+}
+
+static uint32_t mesh_simulate_cache(const uint32_t* t, uint32_t* timestamps, uint32_t* timestamp) {
+  uint32_t misses = 0;
+  for (uint32_t i = 0; i < 3; i++) {
+    if (*timestamp - timestamps[t[i]] > OVERDRAW_CACHE_SIZE) {
+      timestamps[t[i]] = (*timestamp)++;
+      misses++;
+    }
+  }
+  return misses;
+}
+
+void mesh_optimize_overdraw(uint32_t* indices, uint32_t indexCount, const float* positions, size_t stride, uint32_t vertexCount, float threshold) {
+  uint32_t triangleCount = indexCount / 3;
+
+  if (triangleCount < 2 || !mesh_check_indices(indices, triangleCount * 3, vertexCount)) {
+    return;
+  }
+
+  size_t size = 0;
+  size += vertexCount * sizeof(uint32_t); // timestamps
+  size += triangleCount * sizeof(uint32_t); // hard boundaries
+  size += (triangleCount + 1) * sizeof(uint32_t); // soft boundaries
+  size += triangleCount * sizeof(mesh_cluster); // clusters
+  size += triangleCount * 3 * sizeof(uint32_t); // output
+
+  char* memory = malloc(size);
+  if (!memory) return;
+
+  uint32_t* timestamps = (uint32_t*) memory;
+  uint32_t* hard = timestamps + vertexCount;
+  uint32_t* soft = hard + triangleCount;
+  mesh_cluster* clusters = (mesh_cluster*) (soft + triangleCount + 1);
+  uint32_t* output = (uint32_t*) (clusters + triangleCount);
+
+  // Hard boundaries: a triangle that misses the cache completely probably starts a new patch
+  uint32_t hardCount = 0;
+  uint32_t timestamp = OVERDRAW_CACHE_SIZE + 1;
+  memset(timestamps, 0, vertexCount * sizeof(uint32_t));
+  for (uint32_t i = 0; i < triangleCount; i++) {
+    if (mesh_simulate_cache(indices + 3 * i, timestamps, &timestamp) == 3 || i == 0) {
+      hard[hardCount++] = i;
+    }
+  }
+
+  // Soft boundaries: split hard clusters further as long as the ACMR stays within the threshold
+  uint32_t softCount = 0;
+  timestamp = 0;
+  memset(timestamps, 0, vertexCount * sizeof(uint32_t));
+  for (uint32_t c = 0; c < hardCount; c++) {
+    uint32_t start = hard[c];
+    uint32_t end = c + 1 < hardCount ? hard[c + 1] : triangleCount;
+
+    uint32_t misses = 0;
+    timestamp += OVERDRAW_CACHE_SIZE + 1;
+    for (uint32_t i = start; i < end; i++) {
+      misses += mesh_simulate_cache(indices + 3 * i, timestamps, &timestamp);
+    }
+
+    float target = threshold * misses / (float) (end - start);
+    soft[softCount++] = start;
+
+    uint32_t runningMisses = 0;
+    uint32_t runningTriangles = 0;
+    timestamp += OVERDRAW_CACHE_SIZE + 1;
+    for (uint32_t i = start; i < end; i++) {
+      runningMisses += mesh_simulate_cache(indices + 3 * i, timestamps, &timestamp);
+      runningTriangles++;
+
+      if (runningMisses <= target * runningTriangles) {
+        soft[softCount++] = i + 1;
+        timestamp += OVERDRAW_CACHE_SIZE + 1;
+        runningMisses = 0;
+        runningTriangles = 0;
+      }
+    }
+
+    // The last cluster is usually a bad leftover, so merge it into the previous one
+    if (soft[softCount - 1] != start) {
+      softCount--;
+    }
+  }
+
+  soft[softCount] = triangleCount;
+
+  // Sort clusters so the ones facing away from the center of the mesh are drawn first
+  float center[3] = { 0.f };
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    const float* p = (const float*) ((const char*) positions + i * stride);
+    center[0] += p[0] / vertexCount;
+    center[1] += p[1] / vertexCount;
+    center[2] += p[2] / vertexCount;
+  }
+
+  for (uint32_t c = 0; c < softCount; c++) {
+    float centroid[3] = { 0.f };
+    float normal[3] = { 0.f };
+    float area = 0.f;
+
+    for (uint32_t i = soft[c]; i < soft[c + 1]; i++) {
+      const float* a = (const float*) ((const char*) positions + indices[3 * i + 0] * stride);
+      const float* b = (const float*) ((const char*) positions + indices[3 * i + 1] * stride);
+      const float* p = (const float*) ((const char*) positions + indices[3 * i + 2] * stride);
+      float u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+      float v[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+      float n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+      float w = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      centroid[0] += (a[0] + b[0] + p[0]) / 3.f * w;
+      centroid[1] += (a[1] + b[1] + p[1]) / 3.f * w;
+      centroid[2] += (a[2] + b[2] + p[2]) / 3.f * w;
+      normal[0] += n[0];
+      normal[1] += n[1];
+      normal[2] += n[2];
+      area += w;
+    }
+
+    float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    float scale = area > 0.f ? 1.f / area : 0.f;
+    float invLength = length > 0.f ? 1.f / length : 0.f;
+
+    clusters[c].index = c;
+    clusters[c].key =
+      (centroid[0] * scale - center[0]) * normal[0] * invLength +
+      (centroid[1] * scale - center[1]) * normal[1] * invLength +
+      (centroid[2] * scale - center[2]) * normal[2] * invLength;
+  }
+
+  qsort(clusters, softCount, sizeof(mesh_cluster), mesh_cluster_compare);
+
+  uint32_t cursor = 0;
+  for (uint32_t c = 0; c < softCount; c++) {
+    uint32_t start = soft[clusters[c].index];
+    uint32_t count = soft[clusters[c].index + 1] - start;
+    memcpy(output + cursor, indices + 3 * start, 3 * count * sizeof(uint32_t));
+    cursor += 3 * count;
+  }
+
+  memcpy(indices, output, triangleCount * 3 * sizeof(uint32_t));
+  free(memory);
+}
+
+// Vertex fetch
+
+uint32_t mesh_optimize_vertex_fetch(uint32_t* remap, uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+  if (!mesh_check_indices(indices, indexCount, vertexCount)) {
+    for (uint32_t i = 0; i < vertexCount; i++) {
+      remap[i] = i;
+    }
+    return vertexCount;
+  }
+
+  memset(remap, 0xff, vertexCount * sizeof(uint32_t));
+
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < indexCount; i++) {
+    uint32_t v = indices[i];
+    if (remap[v] == ~0u) {
+      remap[v] = count++;
+    }
+    indices[i] = remap[v];
+  }
+
+  return count;
+}
+
+// Simplification (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics")
+
+typedef struct {
+  double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, w;
+} mesh_quadric;
+
+typedef struct {
+  float cost;
+  uint32_t from;
+  uint32_t to;
+} mesh_collapse;
+
+static int mesh_collapse_compare(const void* a, const void* b) {
+  float x = ((const mesh_collapse*) a)->cost;
+  float y = ((const mesh_collapse*) b)->cost;
+  return (x > y) - (x < y);
+}
+
+static void mesh_quadric_add(mesh_quadric* q, const mesh_quadric* r) {
+  q->a2 += r->a2, q->ab += r->ab, q->ac += r->ac, q->ad += r->ad;
+  q->b2 += r->b2, q->bc += r->bc, q->bd += r->bd;
+  q->c2 += r->c2, q->cd += r->cd;
+  q->d2 += r->d2;
+  q->w += r->w;
+}
+
+static float mesh_quadric_error(const mesh_quadric* q, const mesh_quadric* r, const float* p) {
+  double x = p[0], y = p[1], z = p[2];
+  double a2 = q->a2 + r->a2, ab = q->ab + r->ab, ac = q->ac + r->ac, ad = q->ad + r->ad;
+  double b2 = q->b2 + r->b2, bc = q->bc + r->bc, bd = q->bd + r->bd;
+  double c2 = q->c2 + r->c2, cd = q->cd + r->cd, d2 = q->d2 + r->d2;
+  double w = q->w + r->w;
+  double e = a2 * x * x + b2 * y * y + c2 * z * z + 2. * (ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z) + d2;
+  return w > 0. && e > 0. ? (float) (e / w) : 0.f;
+}
+
+static void mesh_normal(const float* a, const float* b, const float* c, float* n) {
+  float u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+  float v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+  n[0] = u[1] * v[2] - u[2] * v[1];
+  n[1] = u[2] * v[0] - u[0] * v[2];
+  n[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+uint32_t mesh_simplify(uint32_t* destination, const uint32_t* indices, uint32_t indexCount, const float* positions, size_t stride, uint32_t vertexCount, uint32_t targetIndexCount, float* error) {
+  indexCount -= indexCount % 3;
+  memcpy(destination, indices, indexCount * sizeof(uint32_t));
+  if (error) *error = 0.f;
+
+  if (indexCount <= targetIndexCount || !mesh_check_indices(indices, indexCount, vertexCount)) {
+    return indexCount;
+  }
+
+  uint32_t capacity = 1;
+  while (capacity < vertexCount * 2) capacity <<= 1;
+
+  size_t size = 0;
+  size += vertexCount * sizeof(mesh_quadric); // quadrics
+  size += (vertexCount + 1) * sizeof(uint32_t); // offsets
+  size += vertexCount * sizeof(uint32_t); // valence
+  size += vertexCount * sizeof(uint32_t); // flags
+  size += indexCount * sizeof(uint32_t); // adjacency
+  size += indexCount * sizeof(mesh_collapse); // collapses
+  size += capacity * sizeof(uint32_t); // position hash table
+
+  char* memory = calloc(1, size);
+  if (!memory) return indexCount;
+
+  mesh_quadric* quadrics = (mesh_quadric*) memory;
+  uint32_t* offsets = (uint32_t*) (quadrics + vertexCount);
+  uint32_t* valence = offsets + vertexCount + 1;
+  uint32_t* flags = valence + vertexCount;
+  uint32_t* adjacency = flags + vertexCount;
+  mesh_collapse* collapses = (mesh_collapse*) (adjacency + indexCount);
+  uint32_t* table = (uint32_t*) (collapses + indexCount);
+
+  enum { LOCKED = 1, TOUCHED = 2 };
+  #define POSITION(i) ((const float*) ((const char*) positions + (i) * stride))
+
+  // Vertices that share a position with another vertex are on an attribute seam and get locked
+  memset(table, 0xff, capacity * sizeof(uint32_t));
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    uint32_t slot = mesh_hash(POSITION(i), 3 * sizeof(float)) & (capacity - 1);
+    while (table[slot] != ~0u && memcmp(POSITION(table[slot]), POSITION(i), 3 * sizeof(float))) {
+      slot = (slot + 1) & (capacity - 1);
+    }
+    if (table[slot] == ~0u) {
+      table[slot] = i;
+    } else {
+      flags[i] |= LOCKED;
+      flags[table[slot]] |= LOCKED;
+    }
+  }
+
+  // Accumulate an area weighted plane quadric for each triangle into its vertices
+  for (uint32_t i = 0; i < indexCount; i += 3) {
+    const float* a = POSITION(indices[i + 0]);
+    float n[3];
+    mesh_normal(a, POSITION(indices[i + 1]), POSITION(indices[i + 2]), n);
+    double area = sqrt((double) n[0] * n[0] + (double) n[1] * n[1] + (double) n[2] * n[2]);
+    if (area <= 0.) continue;
+    double x = n[0] / area, y = n[1] / area, z = n[2] / area;
+    double d = -(x * a[0] + y * a[1] + z * a[2]);
+    double w = area * .5;
+    mesh_quadric q = { w * x * x, w * x * y, w * x * z, w * x * d, w * y * y, w * y * z, w * y * d, w * z * z, w * z * d, w * d * d, w };
+    mesh_quadric_add(&quadrics[indices[i + 0]], &q);
+    mesh_quadric_add(&quadrics[indices[i + 1]], &q);
+    mesh_quadric_add(&quadrics[indices[i + 2]], &q);
+  }
+
+  float maxError = 0.f;
+
+  for (;;) {
+    // Vertex -> triangle adjacency for the current triangles
+    memset(valence, 0, vertexCount * sizeof(uint32_t));
+    for (uint32_t i = 0; i < indexCount; i++) {
+      valence[destination[i]]++;
+    }
+
+    for (uint32_t i = 0; i < vertexCount; i++) {
+      offsets[i + 1] = offsets[i] + valence[i];
+      valence[i] = 0;
+      flags[i] &= ~TOUCHED;
+    }
+
+    for (uint32_t i = 0; i < indexCount; i++) {
+      uint32_t v = destination[i];
+      adjacency[offsets[v] + valence[v]++] = i / 3;
+    }
+
+    // Vertices on an open edge get locked.  An edge is open if its reverse isn't in any triangle.
+    for (uint32_t i = 0; i < indexCount; i++) {
+      uint32_t a = destination[i];
+      uint32_t b = destination[i - i % 3 + (i + 1) % 3];
+      bool open = true;
+      for (uint32_t j = 0; j < valence[b] && open; j++) {
+        const uint32_t* t = destination + 3 * adjacency[offsets[b] + j];
+        open = !((t[0] == b && t[1] == a) || (t[1] == b && t[2] == a) || (t[2] == b && t[0] == a));
+      }
+      if (open) {
+        flags[a] |= LOCKED;
+        flags[b] |= LOCKED;
+      }
+    }
+
+    // Collect edge collapses, each edge is visited once from the triangle where from < to
+    uint32_t collapseCount = 0;
+    for (uint32_t i = 0; i < indexCount; i++) {
+      uint32_t a = destination[i];
+      uint32_t b = destination[i - i % 3 + (i + 1) % 3];
+      if (a > b || ((flags[a] & LOCKED) && (flags[b] & LOCKED))) continue;
+      float ab = (flags[a] & LOCKED) ? FLT_MAX : mesh_quadric_error(&quadrics[a], &quadrics[b], POSITION(b));
+      float ba = (flags[b] & LOCKED) ? FLT_MAX : mesh_quadric_error(&quadrics[a], &quadrics[b], POSITION(a));
+      collapses[collapseCount++] = ab <= ba ? (mesh_collapse) { ab, a, b } : (mesh_collapse) { ba, b, a };
+    }
+
+    qsort(collapses, collapseCount, sizeof(mesh_collapse), mesh_collapse_compare);
+
+    // Apply the cheapest collapses that don't touch the same triangles or flip any triangles
+    uint32_t triangleCount = indexCount / 3;
+    uint32_t targetTriangleCount = targetIndexCount / 3;
+    uint32_t applied = 0;
+
+    for (uint32_t c = 0; c < collapseCount && triangleCount > targetTriangleCount; c++) {
+      uint32_t from = collapses[c].from;
+      uint32_t to = collapses[c].to;
+
+      if ((flags[from] & TOUCHED) || (flags[to] & TOUCHED)) {
+        continue;
+      }
+
+      bool flipped = false;
+      uint32_t removed = 0;
+      for (uint32_t j = 0; j < valence[from] && !flipped; j++) {
+        const uint32_t* t = destination + 3 * adjacency[offsets[from] + j];
+        if (t[0] == to || t[1] == to || t[2] == to) {
+          removed++;
+          continue;
+        }
+
+        float before[3], after[3];
+        const float* p[3] = { POSITION(t[0]), POSITION(t[1]), POSITION(t[2]) };
+        mesh_normal(p[0], p[1], p[2], before);
+        for (uint32_t k = 0; k < 3; k++) if (t[k] == from) p[k] = POSITION(to);
+        mesh_normal(p[0], p[1], p[2], after);
+        flipped = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.f;
+      }
+
+      if (flipped) {
+        continue;
+      }
+
+      for (uint32_t j = 0; j < valence[from]; j++) {
+        uint32_t* t = destination + 3 * adjacency[offsets[from] + j];
+        for (uint32_t k = 0; k < 3; k++) {
+          flags[t[k]] |= TOUCHED;
+          if (t[k] == from) t[k] = to;
+        }
+      }
+
+      for (uint32_t j = 0; j < valence[to]; j++) {
+        const uint32_t* t = destination + 3 * adjacency[offsets[to] + j];
+        flags[t[0]] |= TOUCHED, flags[t[1]] |= TOUCHED, flags[t[2]] |= TOUCHED;
+      }
+
+      mesh_quadric_add(&quadrics[to], &quadrics[from]);
+      maxError = collapses[c].cost > maxError ? collapses[c].cost : maxError;
+      triangleCount -= removed;
+      applied++;
+    }
+
+    // Remove triangles that became degenerate
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < indexCount; i += 3) {
+      uint32_t* t = destination + i;
+      if (t[0] != t[1] && t[1] != t[2] && t[2] != t[0]) {
+        destination[count++] = t[0];
+        destination[count++] = t[1];
+        destination[count++] = t[2];
+      }
+    }
+
+    indexCount = count;
+
+    if (applied == 0 || indexCount <= targetIndexCount) {
+      break;
+    }
+  }
+
+  #undef POSITION
+  free(memory);
+  if (error) *error = sqrtf(maxError);
+  return indexCount;
+}
+
+// Meshlets
+
+static void mesh_meshlet_bounds(mesh_meshlet* meshlet, const uint32_t* indices, const float* positions, size_t stride, const uint32_t* vertices, uint32_t vertexCount) {
+  float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+  float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    const float* p = (const float*) ((const char*) positions + vertices[i] * stride);
+    for (uint32_t j = 0; j < 3; j++) {
+      min[j] = fminf(min[j], p[j]);
+      max[j] = fmaxf(max[j], p[j]);
+    }
+  }
+
+  float radius = 0.f;
+  float* center = meshlet->center;
+  for (uint32_t j = 0; j < 3; j++) {
+    center[j] = (min[j] + max[j]) * .5f;
+  }
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    const float* p = (const float*) ((const char*) positions + vertices[i] * stride);
+    float d[3] = { p[0] - center[0], p[1] - center[1], p[2] - center[2] };
+    radius = fmaxf(radius, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+  }
+
+  meshlet->radius = sqrtf(radius);
+
+  // The cone axis is the average triangle normal, and the cutoff comes from the normal furthest
+  // away from it.  Degenerate triangles don't face any direction, so they're ignored.
+  float* axis = meshlet->axis;
+  float normals[3 * 128];
+  uint32_t triangleCount = meshlet->count / 3;
+  uint32_t normalCount = 0;
+  axis[0] = axis[1] = axis[2] = 0.f;
+
+  for (uint32_t i = 0; i < triangleCount; i++) {
+    const float* a = (const float*) ((const char*) positions + indices[3 * i + 0] * stride);
+    const float* b = (const float*) ((const char*) positions + indices[3 * i + 1] * stride);
+    const float* c = (const float*) ((const char*) positions + indices[3 * i + 2] * stride);
+    float* n = normals + 3 * normalCount;
+    mesh_normal(a, b, c, n);
+    float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length > 0.f) {
+      n[0] /= length, n[1] /= length, n[2] /= length;
+      axis[0] += n[0], axis[1] += n[1], axis[2] += n[2];
+      normalCount++;
+    }
+  }
+
+  float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+
+  if (normalCount == 0 || length <= 0.f) {
+    meshlet->cutoff = 1.f;
+    return;
+  }
+
+  axis[0] /= length, axis[1] /= length, axis[2] /= length;
+
+  float minDot = 1.f;
+  for (uint32_t i = 0; i < normalCount; i++) {
+    float* n = normals + 3 * i;
+    minDot = fminf(minDot, n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2]);
+  }
+
+  meshlet->cutoff = minDot <= 0.f ? 1.f : sqrtf(1.f - minDot * minDot);
+}
+
+uint32_t mesh_meshlet_bound(uint32_t indexCount, uint32_t maxVertices, uint32_t maxTriangles) {
+  if (maxVertices < 3 || maxTriangles == 0) {
+    return 0;
+  }
+
+  // Every meshlet except the last one is closed because it's full, either because it has the
+  // maximum number of triangles or the next triangle would overflow its vertices.  In the second
+  // case, it references at least maxVertices - 2 distinct vertices.
+  uint32_t minIndices = maxVertices - 2 < maxTriangles * 3 ? maxVertices - 2 : maxTriangles * 3;
+  return indexCount / minIndices + 1;
+}
+
+uint32_t mesh_build_meshlets(mesh_meshlet* meshlets, uint32_t* indices, uint32_t indexCount, const float* positions, size_t stride, uint32_t vertexCount, uint32_t maxVertices, uint32_t maxTriangles) {
+  uint32_t triangleCount = indexCount / 3;
+
+  if (triangleCount == 0 || maxVertices < 3 || maxTriangles == 0 || maxTriangles > 128 || !mesh_check_indices(indices, triangleCount * 3, vertexCount)) {
+    return 0;
+  }
+
+  size_t words = 0;
+  words += vertexCount + 1; // offsets
+  words += vertexCount; // stamps
+  words += triangleCount; // emitted
+  words += triangleCount * 3; // adjacency
+  words += triangleCount * 3; // output
+  words += maxVertices; // local
+
+  uint32_t* memory = calloc(words, sizeof(uint32_t));
+  if (!memory) return 0;
+
+  uint32_t* offsets = memory;
+  uint32_t* stamps = offsets + vertexCount + 1;
+  uint32_t* emitted = stamps + vertexCount;
+  uint32_t* adjacency = emitted + triangleCount;
+  uint32_t* output = adjacency + triangleCount * 3;
+  uint32_t* local = output + triangleCount * 3;
+
+  // Vertex -> triangle adjacency, using stamps as a temporary counter
+  for (uint32_t i = 0; i < triangleCount * 3; i++) {
+    stamps[indices[i]]++;
+  }
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    offsets[i + 1] = offsets[i] + stamps[i];
+    stamps[i] = 0;
+  }
+
+  for (uint32_t i = 0; i < triangleCount * 3; i++) {
+    uint32_t v = indices[i];
+    adjacency[offsets[v] + stamps[v]++] = i / 3;
+  }
+
+  memset(stamps, 0, vertexCount * sizeof(uint32_t));
+
+  // Meshlets are grown greedily.  The next triangle is one that shares vertices with the last
+  // triangle (or any triangle in the meshlet), preferring ones that add fewer vertices and then ones
+  // closer to the meshlet's centroid.  When nothing connected fits, the next unused triangle in
+  // index order is used, which works well when the input has already been optimized for locality.
+  uint32_t meshletCount = 0;
+  uint32_t emittedCount = 0;
+  uint32_t cursor = 0;
+  uint32_t last = ~0u;
+  uint32_t localCount = 0;
+  uint32_t triangles = 0;
+  float centroid[3] = { 0.f, 0.f, 0.f };
+
+  while (emittedCount < triangleCount) {
+    uint32_t stamp = meshletCount + 1;
+    uint32_t best = ~0u;
+    uint32_t bestExtra = 4;
+    float bestDistance = FLT_MAX;
+
+    for (uint32_t pass = 0; pass < 2 && best == ~0u && last != ~0u; pass++) {
+      const uint32_t* sources = pass == 0 ? &indices[3 * last] : local;
+      uint32_t sourceCount = pass == 0 ? 3 : localCount;
+      float c[3] = { centroid[0] / localCount, centroid[1] / localCount, centroid[2] / localCount };
+
+      for (uint32_t i = 0; i < sourceCount; i++) {
+        uint32_t v = sources[i];
+        for (uint32_t j = offsets[v]; j < offsets[v + 1]; j++) {
+          uint32_t t = adjacency[j];
+
+          if (emitted[t]) {
+            continue;
+          }
+
+          const uint32_t* triangle = &indices[3 * t];
+          uint32_t extra = (stamps[triangle[0]] != stamp) + (stamps[triangle[1]] != stamp) + (stamps[triangle[2]] != stamp);
+
+          if (localCount + extra > maxVertices || extra > bestExtra) {
+            continue;
+          }
+
+          float distance = 0.f;
+          for (uint32_t k = 0; k < 3; k++) {
+            const float* a = (const float*) ((const char*) positions + triangle[0] * stride);
+            const float* b = (const float*) ((const char*) positions + triangle[1] * stride);
+            const float* d = (const float*) ((const char*) positions + triangle[2] * stride);
+            float delta = (a[k] + b[k] + d[k]) / 3.f - c[k];
+            distance += delta * delta;
+          }
+
+          if (extra < bestExtra || distance < bestDistance) {
+            best = t;
+            bestExtra = extra;
+            bestDistance = distance;
+          }
+        }
+      }
+    }
+
+    if (best == ~0u) {
+      while (emitted[cursor]) {
+        cursor++;
+      }
+
+      const uint32_t* triangle = &indices[3 * cursor];
+      uint32_t extra = (stamps[triangle[0]] != stamp) + (stamps[triangle[1]] != stamp) + (stamps[triangle[2]] != stamp);
+      best = localCount + extra <= maxVertices ? cursor : ~0u;
+    }
+
+    // Close the meshlet if nothing fits (the next iteration will always find a triangle)
+    if (best == ~0u) {
+      mesh_meshlet* meshlet = &meshlets[meshletCount++];
+      meshlet->start = (emittedCount - triangles) * 3;
+      meshlet->count = triangles * 3;
+      mesh_meshlet_bounds(meshlet, output + meshlet->start, positions, stride, local, localCount);
+      centroid[0] = centroid[1] = centroid[2] = 0.f;
+      localCount = 0;
+      triangles = 0;
+      last = ~0u;
+      continue;
+    }
+
+    for (uint32_t k = 0; k < 3; k++) {
+      uint32_t v = indices[3 * best + k];
+      if (stamps[v] != stamp) {
+        const float* p = (const float*) ((const char*) positions + v * stride);
+        centroid[0] += p[0], centroid[1] += p[1], centroid[2] += p[2];
+        local[localCount++] = v;
+        stamps[v] = stamp;
+      }
+      output[3 * emittedCount + k] = v;
+    }
+
+    emitted[best] = 1;
+    emittedCount++;
+    triangles++;
+    last = best;
+
+    if (triangles == maxTriangles || emittedCount == triangleCount) {
+      mesh_meshlet* meshlet = &meshlets[meshletCount++];
+      meshlet->start = (emittedCount - triangles) * 3;
+      meshlet->count = triangles * 3;
+      mesh_meshlet_bounds(meshlet, output + meshlet->start, positions, stride, local, localCount);
+      centroid[0] = centroid[1] = centroid[2] = 0.f;
+      localCount = 0;
+      triangles = 0;
+      last = ~0u;
+    }
+  }
+
+  memcpy(indices, output, triangleCount * 3 * sizeof(uint32_t));
+  free(memory);
+  return meshletCount;
+}
+
+// Convex hull
+
+typedef struct {
+  uint32_t v[3];
+  float n[3];
+  float d;
+  bool dead;
+} mesh_hull_face;
+
+#define HULL_POINT(i) ((const float*) ((const char*) positions + (i) * stride))
+
+static bool mesh_hull_face_init(mesh_hull_face* face, const float* positions, size_t stride, uint32_t a, uint32_t b, uint32_t c) {
+  face->v[0] = a;
+  face->v[1] = b;
+  face->v[2] = c;
+  face->dead = false;
+  mesh_normal(HULL_POINT(a), HULL_POINT(b), HULL_POINT(c), face->n);
+  float length = sqrtf(face->n[0] * face->n[0] + face->n[1] * face->n[1] + face->n[2] * face->n[2]);
+  if (length == 0.f) return false;
+  face->n[0] /= length;
+  face->n[1] /= length;
+  face->n[2] /= length;
+  const float* p = HULL_POINT(a);
+  face->d = face->n[0] * p[0] + face->n[1] * p[1] + face->n[2] * p[2];
+  return true;
+}
+
+static float mesh_hull_distance(const mesh_hull_face* face, const float* p) {
+  return face->n[0] * p[0] + face->n[1] * p[1] + face->n[2] * p[2] - face->d;
+}
+
+static float mesh_distance_squared(const float* a, const float* b) {
+  float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+  return dx * dx + dy * dy + dz * dz;
+}
+
+typedef struct {
+  float key;
+  uint32_t index;
+} mesh_sort_entry;
+
+static int mesh_sort_descending(const void* a, const void* b) {
+  float x = ((const mesh_sort_entry*) a)->key;
+  float y = ((const mesh_sort_entry*) b)->key;
+  return (x < y) - (x > y);
+}
+
+uint32_t mesh_convex_hull(uint32_t* triangles, const float* positions, size_t stride, uint32_t vertexCount) {
+  if (vertexCount < 4) {
+    return 0;
+  }
+
+  float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+  float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+  uint32_t i0 = 0;
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    const float* p = HULL_POINT(i);
+    if (p[0] < HULL_POINT(i0)[0]) i0 = i;
+    for (int j = 0; j < 3; j++) {
+      min[j] = fminf(min[j], p[j]);
+      max[j] = fmaxf(max[j], p[j]);
+    }
+  }
+
+  float extent = fmaxf(fmaxf(max[0] - min[0], max[1] - min[1]), max[2] - min[2]);
+  float epsilon = extent * 1e-5f;
+
+  // Initial tetrahedron: the leftmost point, the point farthest from it, the point farthest from
+  // that line, and the point farthest from that plane
+  uint32_t i1 = i0, i2 = i0, i3 = i0;
+  float best = 0.f;
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    float d = mesh_distance_squared(HULL_POINT(i), HULL_POINT(i0));
+    if (d > best) best = d, i1 = i;
+  }
+
+  best = 0.f;
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    float n[3];
+    mesh_normal(HULL_POINT(i0), HULL_POINT(i1), HULL_POINT(i), n);
+    float d = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+    if (d > best) best = d, i2 = i;
+  }
+
+  mesh_hull_face base;
+  if (i1 == i0 || i2 == i0 || !mesh_hull_face_init(&base, positions, stride, i0, i1, i2)) {
+    return 0;
+  }
+
+  best = 0.f;
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    float d = fabsf(mesh_hull_distance(&base, HULL_POINT(i)));
+    if (d > best) best = d, i3 = i;
+  }
+
+  if (best <= epsilon) {
+    return 0;
+  }
+
+  // The base face has to point away from the fourth point
+  if (mesh_hull_distance(&base, HULL_POINT(i3)) > 0.f) {
+    uint32_t t = i1;
+    i1 = i2;
+    i2 = t;
+  }
+
+  uint32_t faceCapacity = 64;
+  uint32_t faceCount = 0;
+  uint32_t liveCount = 0;
+  mesh_hull_face* faces = malloc(faceCapacity * sizeof(mesh_hull_face));
+  uint32_t* visible = malloc(faceCapacity * sizeof(uint32_t));
+  uint32_t* horizon = malloc(2 * faceCapacity * sizeof(uint32_t));
+  mesh_sort_entry* order = malloc(vertexCount * sizeof(mesh_sort_entry));
+
+  if (!faces || !visible || !horizon || !order) {
+    free(faces);
+    free(visible);
+    free(horizon);
+    free(order);
+    return 0;
+  }
+
+  uint32_t initial[4][3] = { { i0, i1, i2 }, { i0, i3, i1 }, { i1, i3, i2 }, { i2, i3, i0 } };
+  for (uint32_t i = 0; i < 4; i++) {
+    mesh_hull_face_init(&faces[faceCount++], positions, stride, initial[i][0], initial[i][1], initial[i][2]);
+  }
+  liveCount = 4;
+
+  // Adding the farthest points first means most interior points are rejected with no work
+  float center[3];
+  for (int j = 0; j < 3; j++) {
+    center[j] = (HULL_POINT(i0)[j] + HULL_POINT(i1)[j] + HULL_POINT(i2)[j] + HULL_POINT(i3)[j]) * .25f;
+  }
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    order[i].key = mesh_distance_squared(HULL_POINT(i), center);
+    order[i].index = i;
+  }
+
+  qsort(order, vertexCount, sizeof(mesh_sort_entry), mesh_sort_descending);
+
+  bool ok = true;
+  for (uint32_t o = 0; o < vertexCount && ok; o++) {
+    uint32_t index = order[o].index;
+    if (index == i0 || index == i1 || index == i2 || index == i3) {
+      continue;
+    }
+
+    const float* p = HULL_POINT(index);
+    uint32_t visibleCount = 0;
+    for (uint32_t f = 0; f < faceCount; f++) {
+      if (!faces[f].dead && mesh_hull_distance(&faces[f], p) > epsilon) {
+        visible[visibleCount++] = f;
+      }
+    }
+
+    if (visibleCount == 0) {
+      continue;
+    }
+
+    // An edge of a visible face is on the horizon if the face across it is not visible
+    uint32_t horizonCount = 0;
+    for (uint32_t v = 0; v < visibleCount; v++) {
+      mesh_hull_face* face = &faces[visible[v]];
+      for (uint32_t e = 0; e < 3; e++) {
+        uint32_t a = face->v[e];
+        uint32_t b = face->v[(e + 1) % 3];
+        bool shared = false;
+        for (uint32_t w = 0; w < visibleCount && !shared; w++) {
+          mesh_hull_face* other = &faces[visible[w]];
+          for (uint32_t k = 0; k < 3; k++) {
+            if (other->v[k] == b && other->v[(k + 1) % 3] == a) {
+              shared = true;
+              break;
+            }
+          }
+        }
+        if (!shared) {
+          horizon[2 * horizonCount + 0] = a;
+          horizon[2 * horizonCount + 1] = b;
+          horizonCount++;
+        }
+      }
+    }
+
+    for (uint32_t v = 0; v < visibleCount; v++) {
+      faces[visible[v]].dead = true;
+    }
+
+    liveCount -= visibleCount;
+
+    // Dead faces are compacted away once they outnumber the live ones
+    if (faceCount + horizonCount > faceCapacity && faceCount > 2 * liveCount) {
+      uint32_t count = 0;
+      for (uint32_t f = 0; f < faceCount; f++) {
+        if (!faces[f].dead) {
+          faces[count++] = faces[f];
+        }
+      }
+      faceCount = count;
+    }
+
+    if (faceCount + horizonCount > faceCapacity) {
+      while (faceCount + horizonCount > faceCapacity) faceCapacity *= 2;
+      mesh_hull_face* newFaces = realloc(faces, faceCapacity * sizeof(mesh_hull_face));
+      uint32_t* newVisible = realloc(visible, faceCapacity * sizeof(uint32_t));
+      uint32_t* newHorizon = realloc(horizon, 2 * faceCapacity * sizeof(uint32_t));
+      faces = newFaces ? newFaces : faces;
+      visible = newVisible ? newVisible : visible;
+      horizon = newHorizon ? newHorizon : horizon;
+      if (!newFaces || !newVisible || !newHorizon) {
+        ok = false;
+        break;
+      }
+    }
+
+    for (uint32_t h = 0; h < horizonCount; h++) {
+      if (mesh_hull_face_init(&faces[faceCount], positions, stride, horizon[2 * h + 0], horizon[2 * h + 1], index)) {
+        faceCount++;
+        liveCount++;
+      }
+    }
+  }
+
+  uint32_t triangleCount = 0;
+  for (uint32_t f = 0; f < faceCount && ok; f++) {
+    if (!faces[f].dead) {
+      memcpy(triangles + 3 * triangleCount++, faces[f].v, 3 * sizeof(uint32_t));
+    }
+  }
+
+  free(faces);
+  free(visible);
+  free(horizon);
+  free(order);
+  return ok ? triangleCount : 0;
+}
+
+// Convex decomposition
+
+typedef struct {
+  uint32_t start;
+  uint32_t count;
+  float concavity;
+} mesh_part;
+
+// Triangles are sorted by a precomputed centroid coordinate, so the comparator needs no context
+typedef struct {
+  float key;
+  uint32_t triangle;
+} mesh_split_key;
+
+static float mesh_centroid(const uint32_t* indices, const float* positions, size_t stride, uint32_t triangle, int axis) {
+  const uint32_t* t = indices + 3 * triangle;
+  return HULL_POINT(t[0])[axis] + HULL_POINT(t[1])[axis] + HULL_POINT(t[2])[axis];
+}
+
+static int mesh_split_compare(const void* a, const void* b) {
+  const mesh_split_key* x = a;
+  const mesh_split_key* y = b;
+  if (x->key != y->key) return (x->key > y->key) - (x->key < y->key);
+  return (x->triangle > y->triangle) - (x->triangle < y->triangle);
+}
+
+// How far the part's surface dips below its convex hull
+static float mesh_part_concavity(const uint32_t* order, const mesh_part* part, const uint32_t* indices, const float* positions, size_t stride, float* points, uint32_t* hull) {
+  uint32_t pointCount = 0;
+  for (uint32_t i = 0; i < part->count; i++) {
+    const uint32_t* t = indices + 3 * order[part->start + i];
+    for (uint32_t j = 0; j < 3; j++) {
+      memcpy(points + 3 * pointCount++, HULL_POINT(t[j]), 3 * sizeof(float));
+    }
+  }
+
+  uint32_t faceCount = mesh_convex_hull(hull, points, 3 * sizeof(float), pointCount);
+
+  if (faceCount == 0) {
+    return 0.f;
+  }
+
+  // Triangle centroids are probed too, since a concave corner doesn't always have a vertex on it
+  float concavity = 0.f;
+  for (uint32_t i = 0; i < pointCount + part->count; i++) {
+    float centroid[3];
+    const float* p = points + 3 * i;
+    if (i >= pointCount) {
+      p = points + 9 * (i - pointCount);
+      for (int j = 0; j < 3; j++) {
+        centroid[j] = (p[j] + p[3 + j] + p[6 + j]) / 3.f;
+      }
+      p = centroid;
+    }
+
+    float depth = FLT_MAX;
+    for (uint32_t f = 0; f < faceCount && depth > concavity; f++) {
+      mesh_hull_face face;
+      if (mesh_hull_face_init(&face, points, 3 * sizeof(float), hull[3 * f + 0], hull[3 * f + 1], hull[3 * f + 2])) {
+        depth = fminf(depth, -mesh_hull_distance(&face, p));
+      }
+    }
+    concavity = fmaxf(concavity, depth);
+  }
+
+  return concavity;
+}
+
+uint32_t mesh_decompose_convex(uint32_t* parts, const uint32_t* indices, uint32_t indexCount, const float* positions, size_t stride, uint32_t vertexCount, uint32_t maxParts, float concavity) {
+  uint32_t triangleCount = indexCount / 3;
+
+  if (triangleCount == 0 || maxParts == 0 || !mesh_check_indices(indices, triangleCount * 3, vertexCount)) {
+    return 0;
+  }
+
+  // Every part has at least one triangle
+  maxParts = maxParts < triangleCount ? maxParts : triangleCount;
+
+  float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+  float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    const float* p = HULL_POINT(i);
+    for (int j = 0; j < 3; j++) {
+      min[j] = fminf(min[j], p[j]);
+      max[j] = fmaxf(max[j], p[j]);
+    }
+  }
+
+  float threshold = concavity * sqrtf(mesh_distance_squared(min, max));
+
+  uint32_t* order = malloc(triangleCount * sizeof(uint32_t));
+  mesh_split_key* keys = malloc(triangleCount * sizeof(mesh_split_key));
+  mesh_part* list = malloc(maxParts * sizeof(mesh_part));
+  float* points = malloc(9 * triangleCount * sizeof(float));
+  uint32_t* hull = malloc(3 * (6 * triangleCount) * sizeof(uint32_t));
+
+  if (!order || !keys || !list || !points || !hull) {
+    free(order);
+    free(keys);
+    free(list);
+    free(points);
+    free(hull);
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < triangleCount; i++) {
+    order[i] = i;
+  }
+
+  uint32_t partCount = 1;
+  list[0] = (mesh_part) { 0, triangleCount, 0.f };
+  list[0].concavity = mesh_part_concavity(order, &list[0], indices, positions, stride, points, hull);
+
+  // Repeatedly split the most concave part in half along its longest axis
+  while (partCount < maxParts) {
+    uint32_t worst = 0;
+    for (uint32_t i = 1; i < partCount; i++) {
+      if (list[i].concavity > list[worst].concavity) {
+        worst = i;
+      }
+    }
+
+    mesh_part* part = &list[worst];
+    if (part->concavity <= threshold || part->count < 2) {
+      break;
+    }
+
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = 0; i < part->count; i++) {
+      for (int j = 0; j < 3; j++) {
+        float c = mesh_centroid(indices, positions, stride, order[part->start + i], j);
+        lo[j] = fminf(lo[j], c);
+        hi[j] = fmaxf(hi[j], c);
+      }
+    }
+
+    int axis = 0;
+    for (int j = 1; j < 3; j++) {
+      if (hi[j] - lo[j] > hi[axis] - lo[axis]) {
+        axis = j;
+      }
+    }
+
+    for (uint32_t i = 0; i < part->count; i++) {
+      uint32_t triangle = order[part->start + i];
+      keys[i] = (mesh_split_key) { mesh_centroid(indices, positions, stride, triangle, axis), triangle };
+    }
+
+    qsort(keys, part->count, sizeof(mesh_split_key), mesh_split_compare);
+
+    for (uint32_t i = 0; i < part->count; i++) {
+      order[part->start + i] = keys[i].triangle;
+    }
+
+    uint32_t half = part->count / 2;
+    mesh_part* next = &list[partCount++];
+    *next = (mesh_part) { part->start + half, part->count - half, 0.f };
+    part->count = half;
+    part->concavity = mesh_part_concavity(order, part, indices, positions, stride, points, hull);
+    next->concavity = mesh_part_concavity(order, next, indices, positions, stride, points, hull);
+  }
+
+  for (uint32_t i = 0; i < partCount; i++) {
+    for (uint32_t j = 0; j < list[i].count; j++) {
+      parts[order[list[i].start + j]] = i;
+    }
+  }
+
+  free(order);
+  free(keys);
+  free(list);
+  free(points);
+  free(hull);
+  return partCount;
+}
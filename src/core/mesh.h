@@ -0,0 +1,70 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#pragma once
+
+// Notes about the mesh processing helpers:
+// - They all operate on indexed triangle lists with 32 bit indices
+// - Vertices are treated as opaque blobs of `stride` bytes, except for functions that need
+//   positions, which take a pointer to the first float of the first position plus a stride
+// - Scratch memory is allocated with malloc.  If an allocation fails, the input is left unchanged,
+//   which is always a valid (if unoptimized) result
+
+// Rewrites indices so bitwise identical vertices share an index, then drops degenerate triangles.
+// Returns the new index count.
+uint32_t mesh_weld(uint32_t* indices, uint32_t indexCount, const void* vertices, uint32_t vertexCount, size_t stride);
+
+// Reorders triangles to improve post-transform vertex cache hit rate (Forsyth's algorithm).
+void mesh_optimize_vertex_cache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+// Reorders clusters of triangles so outward facing ones come first, reducing overdraw.  Should be
+// called after mesh_optimize_vertex_cache.  threshold is the allowed ACMR increase (e.g. 1.05).
+void mesh_optimize_overdraw(uint32_t* indices, uint32_t indexCount, const float* positions, size_t stride, uint32_t vertexCount, float threshold);
+
+// Renumbers vertices in the order they are first referenced.  Writes the new index of each vertex
+// to remap (or ~0u if a vertex is unused) and returns the number of vertices still in use.
+uint32_t mesh_optimize_vertex_fetch(uint32_t* remap, uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+// Simplifies a mesh by collapsing edges (without moving or creating vertices) until the index count
+// is at or below targetIndexCount or no more edges can be collapsed.  Vertices on open edges and
+// attribute seams are kept in place.  destination must have room for indexCount indices.  The
+// geometric error of the result, in the same units as the positions, is written to error.
+uint32_t mesh_simplify(uint32_t* destination, const uint32_t* indices, uint32_t indexCount, const float* positions, size_t stride, uint32_t vertexCount, uint32_t targetIndexCount, float* error);
+
+// A meshlet is a small cluster of triangles that is contiguous in the index buffer, with bounds
+// that can be used to cull the whole cluster at once.  The triangles of a meshlet can be culled if
+// the sphere is outside the frustum, or if they are all backfacing from the camera position e:
+//   dot(center - e, axis) > cutoff * length(center - e) + radius * (1 + cutoff)
+// The normal cone's cutoff is the sine of its half angle, or 1 if the cone is too wide to be useful.
+// Triangles are assumed to use counterclockwise winding.
+typedef struct {
+  float center[3];
+  float radius;
+  float axis[3];
+  float cutoff;
+  uint32_t start;
+  uint32_t count;
+} mesh_meshlet;
+
+// Returns the maximum number of meshlets mesh_build_meshlets can produce for a mesh.
+uint32_t mesh_meshlet_bound(uint32_t indexCount, uint32_t maxVertices, uint32_t maxTriangles);
+
+// Groups triangles into meshlets with at most maxVertices unique vertices and maxTriangles
+// triangles (at most 128), reordering the index buffer so each meshlet's triangles are contiguous.
+// meshlets must have room for mesh_meshlet_bound meshlets.  Returns the number of meshlets, or 0
+// on failure.
+uint32_t mesh_build_meshlets(mesh_meshlet* meshlets, uint32_t* indices, uint32_t indexCount, const float* positions, size_t stride, uint32_t vertexCount, uint32_t maxVertices, uint32_t maxTriangles);
+
+// Computes the convex hull of a point cloud (incremental, farthest points first).  Writes
+// counterclockwise triangles that index into the input points to triangles, which must have room
+// for 6 * vertexCount indices.  Returns the triangle count, or 0 if the points are flat or the
+// allocation failed.
+uint32_t mesh_convex_hull(uint32_t* triangles, const float* positions, size_t stride, uint32_t vertexCount);
+
+// Approximate convex decomposition.  The most concave part (starting with the whole mesh) is split
+// in half along its longest axis until there are maxParts parts or every part is within the
+// concavity threshold, which is relative to the diagonal of the mesh's bounding box.  Concavity is
+// the distance from the deepest vertex of a part to the part's convex hull.  Writes the part index
+// of each triangle to parts and returns the number of parts, or 0 if the indices are invalid or the
+// allocation failed.
+uint32_t mesh_decompose_convex(uint32_t* parts, const uint32_t* indices, uint32_t indexCount, const float* positions, size_t stride, uint32_t vertexCount, uint32_t maxParts, float concavity);
@@ -1,9 +1,13 @@
 #include "audio/audio.h"
 #include "audio/spatializer.h"
+#include "audio/mix.h"
+#include "audio/dsp.h"
 #include "data/sound.h"
 #include "core/maf.h"
 #include "util.h"
 #include "lib/miniaudio/miniaudio.h"
+#include "lib/tinycthread/tinycthread.h"
+#include <stdatomic.h>
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
@@ -17,43 +21,237 @@
 #define FOREACH_SOURCE(s) for (uint64_t m = state.sourceMask; s = m ? state.sources[CTZL(m)] : NULL, m; m ^= (m & -m))
 #define OUTPUT_FORMAT SAMPLE_F32
 #define OUTPUT_CHANNELS 2
+#define STREAM_SECONDS .25
+#define COMMAND_QUEUE_SIZE 1024
+#define RETIRE_QUEUE_SIZE 1024
+
+// Compressed Sounds are decoded ahead of time on a background thread into a ring buffer for each
+// Source, so the audio callback only has to copy frames out.  The decoder is the only writer and
+// the callback is the only reader.  A seek bumps seekGeneration, the decoder starts writing the new
+// frames at flushIndex and bumps generation, and the callback skips ahead to flushIndex once it
+// sees the new generation.  Indices are frame counts that wrap, masked by capacity - 1.  While a
+// Source is virtual, the callback sets idle and the decoder leaves the stream alone.  Streams start
+// out idle, and the ring isn't allocated until the Source is played for the first time.
+typedef struct {
+  char* data;
+  size_t stride;
+  uint32_t capacity;
+  atomic_uint readIndex;
+  atomic_uint writeIndex;
+  atomic_uint endIndex;
+  atomic_uint generation;
+  atomic_uint flushIndex;
+  atomic_uint flushOffset;
+  atomic_uint seekGeneration;
+  atomic_uint seekOffset;
+  atomic_uint decodeGeneration;
+  atomic_uint idle;
+  uint32_t decodeOffset; // Decoder thread only
+  uint32_t readGeneration; // Audio callback only
+} SourceStream;
+
+// Changes to playing Sources are sent to the audio callback through a single producer, single
+// consumer queue, so the callback never waits on a lock held by another thread.  The Source getters
+// return the values from the last setter call, and the callback has its own render copies.  The
+// callback publishes what it changes on its own (a Source finishing, its offset) with atomics.
+// Threads that send commands take the command lock, which the callback never touches.  Each
+// command holds a reference to its Source until the callback has processed it.
+typedef enum {
+  COMMAND_PLAY,
+  COMMAND_PAUSE,
+  COMMAND_STOP,
+  COMMAND_SEEK,
+  COMMAND_POSE,
+  COMMAND_VOLUME,
+  COMMAND_PITCH,
+  COMMAND_PRIORITY,
+  COMMAND_RADIUS,
+  COMMAND_DIRECTIVITY,
+  COMMAND_EFFECTS,
+  COMMAND_BUS,
+  COMMAND_BUS_ADD,
+  COMMAND_BUS_VOLUME,
+  COMMAND_BUS_FILTER,
+  COMMAND_BUS_COMPRESSOR,
+  COMMAND_BUS_REVERB
+} CommandType;
+
+typedef struct {
+  CommandType type;
+  Source* source;
+  Bus* bus;
+  uint32_t serial;
+  union {
+    uint64_t frame;
+    uint32_t offset;
+    float volume;
+    float pitch;
+    int32_t priority;
+    float radius;
+    uint8_t effects;
+    struct {
+      float weight;
+      float power;
+    } directivity;
+    struct {
+      float position[3];
+      float orientation[4];
+    } pose;
+    struct {
+      dsp_biquad biquad;
+      bool enabled;
+    } filter;
+    struct {
+      dsp_compressor compressor;
+      bool enabled;
+    } compressor;
+    struct {
+      dsp_convolver* convolver;
+      float wet;
+      float dry;
+    } reverb;
+  };
+} Command;
+
+// The audio callback never frees anything, since destructors can take locks and free memory.  When
+// it drops the last reference to an object, the object is sent back through a second single
+// producer, single consumer queue, and destroyed on the decoder thread (or by the next thread that
+// sends a command, if there's no decoder thread).
+typedef struct {
+  void* object;
+  void (*destructor)(void*);
+} Retired;
+
+// Buses group Sources so they can share volume and effects.  Each Bus mixes into its parent, or
+// the output if it doesn't have one.  A Bus can't change its parent, so there are no cycles, and
+// the audio thread keeps its Buses sorted from deepest to shallowest so children are processed
+// before their parents.  The audio thread holds a reference to each Bus in its list, and drops it
+// once that's the only reference left.
+struct Bus {
+  uint32_t ref;
+  Bus* parent;
+  uint32_t depth;
+  float volume;
+  bool filterEnabled;
+  FilterType filterType;
+  float filterFrequency;
+  float filterQ;
+  float filterGain;
+  bool compressorEnabled;
+  float compressorThreshold;
+  float compressorRatio;
+  float compressorAttack;
+  float compressorRelease;
+  float compressorMakeup;
+  Sound* reverbSound;
+  dsp_convolver* reverbConvolver;
+  float reverbWet;
+  float reverbDry;
+  // Audio thread
+  float renderVolume;
+  float mixVolume;
+  bool renderFilter;
+  dsp_biquad filter;
+  bool renderCompressor;
+  dsp_compressor compressor;
+  dsp_convolver* reverb;
+  float renderWet;
+  float renderDry;
+  float buffer[BUFFER_SIZE * 2];
+};
 
 struct Source {
   uint32_t ref;
   uint32_t index;
+  int32_t priority;
+  float audibility;
+  double virtualFrames;
   Sound* sound;
   // Note: Converter is written once in lovrSourceCreate and can never be changed.
   ma_data_converter* converter;
+  SourceStream* stream;
+  Bus* bus;
+  Bus* renderBus;
   intptr_t spatializerMemo;
+  uint64_t startFrame;
+  uint64_t stopFrame;
   uint32_t offset;
+  uint32_t plays;
+  uint32_t seeks;
+  uint32_t seekOffset;
+  uint32_t renderPlay;
+  atomic_uint playing; // Serial of the last play, or 0 if paused (written by the main thread)
+  atomic_uint finished; // Serial of the last play that ended (written by the audio thread)
+  atomic_uint seeked; // Serial of the last seek the audio thread ran
+  atomic_uint tell; // Offset published by the audio thread
   float pitch;
   float volume;
   float position[4];
   float orientation[4];
+  float renderVolume;
+  float mixVolume;
+  float renderPosition[4];
+  float renderOrientation[4];
+  float renderPitch;
+  int32_t renderPriority;
   float radius;
   float dipoleWeight;
   float dipolePower;
+  float renderRadius;
+  float renderDipoleWeight;
+  float renderDipolePower;
   uint8_t effects;
-  bool playing;
-  bool looping;
+  uint8_t renderEffects;
+  atomic_uint looping; // Also read by the audio and decoder threads
+  bool active;
+  bool renderPlaying;
   bool pitchable;
   bool spatial;
 };
 
 static struct {
   bool initialized;
-  ma_mutex lock;
+  bool started;
+  mtx_t lock;
+  mtx_t commandLock;
+  Command commands[COMMAND_QUEUE_SIZE];
+  atomic_uint commandHead;
+  atomic_uint commandTail;
+  Retired retired[RETIRE_QUEUE_SIZE];
+  atomic_uint retireHead;
+  atomic_uint retireTail;
   ma_context context;
   ma_device devices[2];
   Sound* sinks[2];
+  Source* voices[MAX_VOICES];
+  uint32_t voiceCount;
+  atomic_uint liveVoices;
   Source* sources[MAX_SOURCES];
   uint64_t sourceMask;
+  Bus* buses[MAX_BUSES];
+  uint32_t busCount;
+  atomic_uint liveBuses;
+  uint64_t frame;
+  atomic_uint clock;
   float position[4];
   float orientation[4];
   Spatializer* spatializer;
+  Sound* reverb;
+  dsp_convolver* reverbConvolver;
+  float reverbGain;
   float absorption[3];
   ma_data_converter playbackConverter;
   uint32_t sampleRate;
+  thrd_t decoder;
+  mtx_t decodeLock;
+  mtx_t renderLock;
+  cnd_t decodeWake;
+  uint32_t decodeRequests;
+  bool decodePending;
+  atomic_uint decoding;
+  arr_t(Source*) streams;
+  float renderBuffer[BUFFER_SIZE * OUTPUT_CHANNELS];
+  uint32_t renderCursor;
 } state;
 
 static const ma_format miniaudioFormats[] = {
@@ -69,37 +267,747 @@ static float linearToDb(float linear) {
   return 20.f * log10f(linear);
 }
 
-// Device callbacks
+static uint64_t timeToFrame(double time) {
+  return time > 0. ? (uint64_t) (time * state.sampleRate + .5) : 0;
+}
 
-static void onPlayback(ma_device* device, void* out, const void* in, uint32_t count) {
-  lovrAssert(count == BUFFER_SIZE, "Unreachable");
+// Retiring
+
+// Audio thread: queues an object to be destroyed.  If the queue is full, the object is destroyed
+// right away, which is slow but still correct.
+static void retire(void* object, void (*destructor)(void*)) {
+  if (!object) {
+    return;
+  }
+
+  uint32_t head = atomic_load(&state.retireHead);
+  if (head - atomic_load(&state.retireTail) >= RETIRE_QUEUE_SIZE) {
+    destructor(object);
+    return;
+  }
+
+  state.retired[head % RETIRE_QUEUE_SIZE] = (Retired) { object, destructor };
+  atomic_store(&state.retireHead, head + 1);
+  state.decodePending = true;
+}
+
+// Audio thread: drops a reference, retiring the object if it was the last one
+static void release(void* object, void (*destructor)(void*)) {
+  if (object && atomic_fetch_sub((atomic_uint*) object, 1) == 1) {
+    retire(object, destructor);
+  }
+}
+
+static void destroyConvolver(void* convolver) {
+  dsp_convolver_destroy(convolver);
+}
+
+// Runs on the decoder thread, or a thread sending a command (holding the command lock)
+static void destroyRetired(void) {
+  uint32_t tail = atomic_load(&state.retireTail);
+  uint32_t head = atomic_load(&state.retireHead);
+
+  while (tail != head) {
+    Retired* retired = &state.retired[tail % RETIRE_QUEUE_SIZE];
+    retired->destructor(retired->object);
+    tail++;
+  }
+
+  atomic_store(&state.retireTail, tail);
+}
+
+// Streams
+
+static SourceStream* streamCreate(Sound* sound) {
+  uint32_t capacity = 1;
+  while (capacity < lovrSoundGetSampleRate(sound) * STREAM_SECONDS) capacity <<= 1;
+  SourceStream* stream = calloc(1, sizeof(SourceStream));
+  lovrAssert(stream, "Out of memory");
+  stream->stride = lovrSoundGetStride(sound);
+  stream->capacity = capacity;
+  stream->endIndex = ~0u;
+  stream->idle = 1;
+  return stream;
+}
+
+// Main thread: the callback and decoder don't touch the ring until the Source's play command runs
+static void streamAllocate(SourceStream* stream) {
+  if (!stream->data) {
+    stream->data = malloc(stream->capacity * stream->stride);
+    lovrAssert(stream->data, "Out of memory");
+  }
+}
+
+// Audio callback (or a thread running commands while the device is stopped).  The decoder is asked
+// for another pass once the callback has finished the buffer.
+static void streamSeek(SourceStream* stream, uint32_t offset) {
+  atomic_store(&stream->seekOffset, offset);
+  atomic_fetch_add(&stream->seekGeneration, 1);
+  state.decodePending = true;
+}
+
+// Audio callback: copies up to count decoded frames.  Nothing is read while a seek is waiting for
+// the decoder, since everything in the ring is from before the seek.  The generation is checked
+// again after reading the write index, so frames decoded after a seek are never mistaken for old ones.
+static uint32_t streamRead(Source* source, uint32_t count, void* data) {
+  SourceStream* stream = source->stream;
+
+  if (atomic_load(&stream->decodeGeneration) != atomic_load(&stream->seekGeneration)) {
+    return 0;
+  }
+
+  uint32_t generation = atomic_load(&stream->generation);
+
+  if (generation != stream->readGeneration) {
+    atomic_store(&stream->readIndex, atomic_load(&stream->flushIndex));
+    source->offset = atomic_load(&stream->flushOffset);
+    stream->readGeneration = generation;
+  }
+
+  uint32_t read = atomic_load(&stream->readIndex);
+  uint32_t write = atomic_load(&stream->writeIndex);
+
+  if (atomic_load(&stream->generation) != generation) {
+    return 0;
+  }
+
+  uint32_t mask = stream->capacity - 1;
+  uint32_t available = MIN(write - read, count);
+  uint32_t first = MIN(available, stream->capacity - (read & mask));
+  memcpy(data, stream->data + (read & mask) * stream->stride, first * stream->stride);
+  memcpy((char*) data + first * stream->stride, stream->data, (available - first) * stream->stride);
+  atomic_store(&stream->readIndex, read + available);
+  return available;
+}
+
+// Whether the stream is empty because the decoder reached the end (as opposed to falling behind)
+static bool streamFinished(SourceStream* stream) {
+  uint32_t read = atomic_load(&stream->readIndex);
+  return read == atomic_load(&stream->endIndex) &&
+    atomic_load(&stream->generation) == stream->readGeneration &&
+    atomic_load(&stream->decodeGeneration) == atomic_load(&stream->seekGeneration);
+}
+
+// Audio callback: restarts decoding at the Source's offset after it was virtual (or stops waiting
+// for it).  Frames left in the ring are stale, so they're dropped.  The seek comes first, so frames
+// the decoder is still writing from before it went idle are never read.
+static void streamWake(Source* source) {
+  SourceStream* stream = source->stream;
+  if (atomic_load(&stream->idle)) {
+    streamSeek(stream, source->offset);
+    atomic_store(&stream->readIndex, atomic_load(&stream->writeIndex));
+    atomic_store(&stream->idle, 0);
+  }
+}
+
+// Decoder thread: fills as much of the ring as possible
+static void streamDecode(Source* source) {
+  SourceStream* stream = source->stream;
+
+  if (atomic_load(&stream->idle)) {
+    return;
+  }
+
+  uint32_t seekGeneration = atomic_load(&stream->seekGeneration);
+  uint32_t write = atomic_load(&stream->writeIndex);
+
+  if (seekGeneration != atomic_load(&stream->decodeGeneration)) {
+    stream->decodeOffset = atomic_load(&stream->seekOffset);
+    atomic_store(&stream->endIndex, ~0u);
+    atomic_store(&stream->flushIndex, write);
+    atomic_store(&stream->flushOffset, stream->decodeOffset);
+    atomic_fetch_add(&stream->generation, 1);
+    atomic_store(&stream->decodeGeneration, seekGeneration);
+  }
+
+  uint32_t end = atomic_load(&stream->endIndex);
+  if (end != ~0u) {
+    if (!atomic_load(&source->looping)) return;
+    atomic_store(&stream->endIndex, ~0u);
+    stream->decodeOffset = 0;
+  }
+
+  uint32_t mask = stream->capacity - 1;
+  uint32_t frameCount = lovrSoundGetFrameCount(source->sound);
+  for (;;) {
+    uint32_t space = stream->capacity - (write - atomic_load(&stream->readIndex));
+    uint32_t count = MIN(space, stream->capacity - (write & mask));
+
+    if (count == 0) {
+      break;
+    }
+
+    uint32_t frames = lovrSoundRead(source->sound, stream->decodeOffset, count, stream->data + (write & mask) * stream->stride);
+
+    // Frames decoded while the Source was seeking are stale, and the next pass flushes them anyway
+    if (atomic_load(&stream->seekGeneration) != seekGeneration) {
+      break;
+    }
+
+    if (frames == 0) {
+      if (atomic_load(&source->looping) && stream->decodeOffset > 0 && frameCount > 0) {
+        stream->decodeOffset = 0;
+        continue;
+      } else {
+        atomic_store(&stream->endIndex, write);
+        break;
+      }
+    }
+
+    stream->decodeOffset += frames;
+    write += frames;
+    atomic_store(&stream->writeIndex, write);
+  }
+}
+
+// The last reference to a Source can be released by the audio callback at any time.  A Source
+// that's being destroyed is still in the list until its destructor acquires the decode lock, so
+// the decoder (which holds the lock here) can check the old refcount and back off safely.
+static bool retainIfAlive(Source* source) {
+  if (atomic_fetch_add((atomic_uint*) source, 1) == 0) {
+    atomic_fetch_sub((atomic_uint*) source, 1);
+    return false;
+  }
+  return true;
+}
+
+// The decoder thread sleeps until it's asked for a pass.  Requests are counted under the decode
+// lock, so one that comes in between checking the count and waiting isn't lost.
+static void wakeDecoder(void) {
+  mtx_lock(&state.decodeLock);
+  state.decodeRequests++;
+  cnd_signal(&state.decodeWake);
+  mtx_unlock(&state.decodeLock);
+}
+
+// Audio callback: it can't wait for the decode lock, so if the decoder is holding it the request is
+// sent after a later buffer instead.  Playing streams ask for a pass after every buffer they read.
+static void flushDecodeRequests(void) {
+  if (state.decodePending && atomic_load(&state.decoding) && mtx_trylock(&state.decodeLock) == thrd_success) {
+    state.decodeRequests++;
+    cnd_signal(&state.decodeWake);
+    mtx_unlock(&state.decodeLock);
+    state.decodePending = false;
+  }
+}
+
+static int decoderThread(void* userdata) {
+  arr_t(Source*) sources;
+  arr_init(&sources, arr_alloc);
+  uint32_t requests = 0;
+
+  mtx_lock(&state.decodeLock);
+
+  for (;;) {
+    while (atomic_load(&state.decoding) && state.decodeRequests == requests) {
+      cnd_wait(&state.decodeWake, &state.decodeLock);
+    }
+
+    if (!atomic_load(&state.decoding)) {
+      break;
+    }
+
+    requests = state.decodeRequests;
+    arr_clear(&sources);
+    for (size_t i = 0; i < state.streams.length; i++) {
+      if (retainIfAlive(state.streams.data[i])) {
+        arr_push(&sources, state.streams.data[i]);
+      }
+    }
+    mtx_unlock(&state.decodeLock);
+
+    // Offline rendering decodes streams itself, so the decoder waits for it to finish
+    mtx_lock(&state.renderLock);
+    for (size_t i = 0; i < sources.length; i++) {
+      streamDecode(sources.data[i]);
+      lovrRelease(sources.data[i], lovrSourceDestroy);
+    }
+    mtx_unlock(&state.renderLock);
+
+    destroyRetired();
+
+    mtx_lock(&state.decodeLock);
+  }
+
+  mtx_unlock(&state.decodeLock);
+  arr_free(&sources);
+  return 0;
+}
+
+// Streams are only used for compressed Sounds, when the decoder thread is running
+static void sourceInitStream(Source* source) {
+  if (!atomic_load(&state.decoding) || !lovrSoundIsCompressed(source->sound)) {
+    return;
+  }
+
+  source->stream = streamCreate(source->sound);
+  mtx_lock(&state.decodeLock);
+  arr_push(&state.streams, source);
+  mtx_unlock(&state.decodeLock);
+}
+
+// Spatializers can allocate when a Source is created, so it happens here instead of the callback
+static void sourceInitSpatializer(Source* source) {
+  mtx_lock(&state.lock);
+  state.spatializer->sourceCreate(source);
+  mtx_unlock(&state.lock);
+}
+
+// Commands
+
+static void runCommand(Command* command) {
+  Source* source = command->source;
+  Bus* bus = command->bus;
+
+  switch (command->type) {
+    case COMMAND_PLAY:
+      // If the Source isn't active, add it to the voice list.  It gets rendered once it's one of
+      // the most important voices.  The command's reference becomes the reference owned by the mixer.
+      // A paused Source that's still in the voice list just starts playing again.
+      source->renderPlay = command->serial;
+      if (source->active) {
+        if (!source->renderPlaying) {
+          source->renderPlaying = true;
+          source->startFrame = command->frame;
+          source->stopFrame = ~0ull;
+        }
+        break;
+      }
+
+      if (state.voiceCount >= MAX_VOICES) {
+        atomic_store(&source->finished, command->serial);
+        break;
+      }
+
+      state.voices[state.voiceCount++] = source;
+      source->active = true;
+      source->renderPlaying = true;
+      source->virtualFrames = 0.;
+      source->startFrame = command->frame;
+      source->stopFrame = ~0ull;
+      source = NULL;
+      break;
+    case COMMAND_PAUSE:
+      source->renderPlaying = false;
+      break;
+    case COMMAND_STOP:
+      source->stopFrame = command->frame;
+      break;
+    case COMMAND_SEEK:
+      source->offset = command->offset;
+      if (source->stream) streamSeek(source->stream, command->offset);
+      atomic_store(&source->tell, source->offset);
+      atomic_store(&source->seeked, command->serial);
+      break;
+    case COMMAND_POSE:
+      memcpy(source->renderPosition, command->pose.position, 3 * sizeof(float));
+      memcpy(source->renderOrientation, command->pose.orientation, 4 * sizeof(float));
+      break;
+    case COMMAND_VOLUME:
+      source->renderVolume = command->volume;
+      break;
+    case COMMAND_PITCH:
+      source->renderPitch = command->pitch;
+      ma_data_converter_set_rate_ratio(source->converter, command->pitch * lovrSoundGetSampleRate(source->sound) / state.sampleRate);
+      break;
+    case COMMAND_PRIORITY:
+      source->renderPriority = command->priority;
+      break;
+    case COMMAND_RADIUS:
+      source->renderRadius = command->radius;
+      break;
+    case COMMAND_DIRECTIVITY:
+      source->renderDipoleWeight = command->directivity.weight;
+      source->renderDipolePower = command->directivity.power;
+      break;
+    case COMMAND_EFFECTS:
+      source->renderEffects = command->effects;
+      break;
+    case COMMAND_BUS:
+      // The command's reference to the Bus becomes the Source's
+      release(source->renderBus, lovrBusDestroy);
+      source->renderBus = bus;
+      bus = NULL;
+      break;
+    case COMMAND_BUS_ADD: {
+      uint32_t index = state.busCount++;
+      while (index > 0 && state.buses[index - 1]->depth < bus->depth) {
+        state.buses[index] = state.buses[index - 1];
+        index--;
+      }
+      state.buses[index] = bus;
+      bus = NULL;
+      break;
+    }
+    case COMMAND_BUS_VOLUME:
+      bus->renderVolume = command->volume;
+      break;
+    case COMMAND_BUS_FILTER:
+      if (!bus->renderFilter) {
+        memset(bus->filter.z, 0, sizeof(bus->filter.z));
+      }
+      bus->filter.b0 = command->filter.biquad.b0;
+      bus->filter.b1 = command->filter.biquad.b1;
+      bus->filter.b2 = command->filter.biquad.b2;
+      bus->filter.a1 = command->filter.biquad.a1;
+      bus->filter.a2 = command->filter.biquad.a2;
+      bus->renderFilter = command->filter.enabled;
+      break;
+    case COMMAND_BUS_COMPRESSOR: {
+      float envelope = bus->renderCompressor ? bus->compressor.envelope : 0.f;
+      bus->compressor = command->compressor.compressor;
+      bus->compressor.envelope = envelope;
+      bus->renderCompressor = command->compressor.enabled;
+      break;
+    }
+    case COMMAND_BUS_REVERB:
+      if (bus->reverb != command->reverb.convolver) {
+        retire(bus->reverb, destroyConvolver);
+        bus->reverb = command->reverb.convolver;
+      }
+      bus->renderWet = command->reverb.wet;
+      bus->renderDry = command->reverb.dry;
+      break;
+    default: break;
+  }
+
+  release(source, lovrSourceDestroy);
+  release(bus, lovrBusDestroy);
+}
+
+// Runs on the audio callback, or on a sending thread when the playback device is stopped
+static void runCommands(void) {
+  uint32_t tail = atomic_load(&state.commandTail);
+  uint32_t head = atomic_load(&state.commandHead);
+
+  while (tail != head) {
+    runCommand(&state.commands[tail % COMMAND_QUEUE_SIZE]);
+    tail++;
+  }
+
+  atomic_store(&state.commandTail, tail);
+  atomic_store(&state.liveVoices, state.voiceCount);
+}
+
+static void pushCommand(Command command) {
+  lovrRetain(command.source);
+  lovrRetain(command.bus);
+  mtx_lock(&state.commandLock);
+
+  if (!atomic_load(&state.decoding)) {
+    destroyRetired();
+  }
+
+  // Nothing is draining the queue when the device is stopped, so the commands are run here.  The
+  // device can also stop on its own (e.g. when it's unplugged), so it's checked while waiting.
+  uint32_t head = atomic_load(&state.commandHead);
+  while (head - atomic_load(&state.commandTail) >= COMMAND_QUEUE_SIZE) {
+    if (!state.started || !ma_device_is_started(&state.devices[AUDIO_PLAYBACK])) {
+      runCommands();
+    } else {
+      thrd_yield();
+    }
+  }
+
+  state.commands[head % COMMAND_QUEUE_SIZE] = command;
+  atomic_store(&state.commandHead, head + 1);
+  mtx_unlock(&state.commandLock);
+}
+
+// Voices
+
+// Claims the right-most free slot in the mask
+static void voiceRender(Source* source) {
+  uint32_t index = state.sourceMask ? CTZL(~state.sourceMask) : 0;
+  state.sourceMask |= (1ull << index);
+  state.sources[index] = source;
+  source->index = index;
+  if (source->stream) streamWake(source);
+
+  // Fade in Sources that start in the middle, so a virtual voice coming back doesn't pop
+  source->mixVolume = source->offset == 0 ? source->renderVolume : 0.f;
+}
+
+static void voiceVirtualize(Source* source) {
+  state.sources[source->index] = NULL;
+  state.sourceMask &= ~(1ull << source->index);
+  state.spatializer->sourceDestroy(source);
+  source->index = ~0u;
+  if (source->stream) atomic_store(&source->stream->idle, 1);
+}
+
+// Distance attenuation, without any of the spatializer's other effects
+static float voiceAttenuation(Source* source) {
+  if (source->spatial && (source->renderEffects & (1 << EFFECT_ATTENUATION))) {
+    float distance = vec3_distance(source->renderPosition, state.position);
+    return 1.f / MAX(distance, 1.f);
+  }
+
+  return 1.f;
+}
+
+// A rough guess at how loud a voice is.  Voices that are already rendered get a small boost so
+// voices with similar volumes don't keep trading places.
+static float voiceAudibility(Source* source) {
+  float audibility = source->renderVolume * voiceAttenuation(source);
+  return source->index == ~0u ? audibility : audibility * 1.25f;
+}
+
+static int voiceCompare(const void* a, const void* b) {
+  const Source* x = *(const Source**) a;
+  const Source* y = *(const Source**) b;
+  if (x->renderPriority != y->renderPriority) return x->renderPriority > y->renderPriority ? -1 : 1;
+  if (x->audibility != y->audibility) return x->audibility > y->audibility ? -1 : 1;
+  return 0;
+}
+
+// Stops a Source from the audio thread, like reaching the end of its Sound
+static void voiceStop(Source* source) {
+  source->offset = 0;
+  source->renderPlaying = false;
+  source->stopFrame = ~0ull;
+  if (source->stream) streamSeek(source->stream, 0);
+  atomic_store(&source->tell, 0);
+  atomic_store(&source->finished, source->renderPlay);
+}
+
+// Where the Source starts and stops playing in the current buffer, in frames from its start.
+// Returns false if the Source hasn't started yet.
+static bool voiceSchedule(Source* source, uint32_t* start, uint32_t* end) {
+  if (source->startFrame >= state.frame + BUFFER_SIZE) {
+    return false;
+  }
+
+  *start = source->startFrame > state.frame ? (uint32_t) (source->startFrame - state.frame) : 0;
+  *end = BUFFER_SIZE;
+
+  if (source->stopFrame < state.frame + BUFFER_SIZE) {
+    *end = source->stopFrame > state.frame ? (uint32_t) (source->stopFrame - state.frame) : 0;
+    *end = MAX(*end, *start);
+  }
+
+  return true;
+}
+
+// Virtual voices skip ahead by the number of frames they would have read, without decoding them.
+// Stream Sounds are drained instead, so their writers don't get stuck.
+static void voiceAdvance(Source* source) {
+  uint32_t start, end;
+  if (!voiceSchedule(source, &start, &end)) {
+    return;
+  }
+
+  source->startFrame = 0;
+
+  if (end < BUFFER_SIZE) {
+    voiceStop(source);
+    return;
+  }
+
+  float pitch = source->pitchable ? source->renderPitch : 1.f;
+  source->virtualFrames += (double) (BUFFER_SIZE - start) * pitch * lovrSoundGetSampleRate(source->sound) / state.sampleRate;
+  uint32_t frames = (uint32_t) source->virtualFrames;
+  source->virtualFrames -= frames;
+
+  if (lovrSoundIsStream(source->sound)) {
+    char scratch[4096];
+    uint32_t capacity = sizeof(scratch) / lovrSoundGetStride(source->sound);
+    while (frames > 0) {
+      uint32_t read = lovrSoundRead(source->sound, 0, MIN(frames, capacity), scratch);
+      if (read == 0) break;
+      frames -= read;
+    }
+    return;
+  }
+
+  uint32_t frameCount = lovrSoundGetFrameCount(source->sound);
+  source->offset += frames;
+  if (source->offset >= frameCount) {
+    if (atomic_load(&source->looping) && frameCount > 0) {
+      source->offset %= frameCount;
+    } else {
+      voiceStop(source);
+      return;
+    }
+  }
+
+  atomic_store(&source->tell, source->offset);
+}
+
+// Removes voices that stopped, then renders the MAX_SOURCES voices with the highest priority,
+// breaking ties by audibility.  The rest become virtual.  The spatializer's Source hooks need the
+// lock, so when it isn't held, voices keep their current state until the next buffer.
+static void updateVoices(bool locked) {
+  for (uint32_t i = 0; i < state.voiceCount;) {
+    Source* source = state.voices[i];
+
+    if (source->renderPlaying || (source->index != ~0u && !locked)) {
+      i++;
+      continue;
+    }
+
+    if (source->index != ~0u) {
+      voiceVirtualize(source);
+    }
+
+    if (source->stream) {
+      streamWake(source);
+    }
+
+    state.voices[i] = state.voices[--state.voiceCount];
+    source->active = false;
+    release(source, lovrSourceDestroy);
+  }
+
+  if (locked) {
+    uint32_t renderCount = MIN(state.voiceCount, MAX_SOURCES);
+
+    if (state.voiceCount > MAX_SOURCES) {
+      for (uint32_t i = 0; i < state.voiceCount; i++) {
+        state.voices[i]->audibility = voiceAudibility(state.voices[i]);
+      }
+
+      qsort(state.voices, state.voiceCount, sizeof(Source*), voiceCompare);
+
+      for (uint32_t i = renderCount; i < state.voiceCount; i++) {
+        if (state.voices[i]->index != ~0u) {
+          voiceVirtualize(state.voices[i]);
+        }
+      }
+    }
+
+    for (uint32_t i = 0; i < renderCount; i++) {
+      if (state.voices[i]->index == ~0u) {
+        voiceRender(state.voices[i]);
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < state.voiceCount; i++) {
+    if (state.voices[i]->index == ~0u) {
+      voiceAdvance(state.voices[i]);
+    }
+  }
+
+  atomic_store(&state.liveVoices, state.voiceCount);
+}
+
+// Buses
+
+// Drops Buses that nothing else references.  The Bus list is kept in order.
+static void updateBuses(void) {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < state.busCount; i++) {
+    Bus* bus = state.buses[i];
+    if (atomic_load((atomic_uint*) &bus->ref) == 1) {
+      release(bus, lovrBusDestroy);
+    } else {
+      state.buses[count++] = bus;
+      memset(bus->buffer, 0, sizeof(bus->buffer));
+    }
+  }
+  state.busCount = count;
+}
+
+// Effects are applied in order (filter, compressor, reverb), then the Bus is mixed into its parent.
+// The reverb gets a mono mix of the Bus, and mono impulse responses are spread to both channels.
+static void processBus(Bus* bus, float* dst) {
+  float* buffer = bus->buffer;
+
+  if (bus->renderFilter) {
+    dsp_biquad_process(&bus->filter, buffer, BUFFER_SIZE);
+  }
+
+  if (bus->renderCompressor) {
+    dsp_compressor_process(&bus->compressor, buffer, BUFFER_SIZE);
+  }
+
+  if (bus->reverb) {
+    float input[BUFFER_SIZE];
+    float output[BUFFER_SIZE * 2];
+    float wet[BUFFER_SIZE * 2];
+
+    for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
+      input[i] = .5f * (buffer[2 * i + 0] + buffer[2 * i + 1]);
+    }
+
+    if (dsp_convolver_get_channel_count(bus->reverb) == 1) {
+      float gain[2] = { 1.f, 1.f };
+      dsp_convolver_process(bus->reverb, input, output);
+      mix_pan(wet, output, BUFFER_SIZE, gain, gain, 0.f);
+    } else {
+      dsp_convolver_process(bus->reverb, input, wet);
+    }
+
+    if (bus->renderDry != 1.f) {
+      for (uint32_t i = 0; i < BUFFER_SIZE * 2; i++) {
+        buffer[i] *= bus->renderDry;
+      }
+    }
+
+    mix_add(buffer, wet, BUFFER_SIZE * 2, bus->renderWet);
+  }
+
+  mix_add_ramp(dst, buffer, BUFFER_SIZE, bus->mixVolume, bus->renderVolume);
+  bus->mixVolume = bus->renderVolume;
+}
+
+// Mixer
+
+// Adds BUFFER_SIZE frames of all the playing Sources to dst.  This runs on the audio callback, or
+// on the thread calling lovrAudioRender.  When rendering offline, nothing is waiting for the
+// audio, so streams are decoded right away instead of risking an underrun.
+static void mixSources(float* dst, bool offline) {
   float raw[BUFFER_SIZE * 2];
   float aux[BUFFER_SIZE * 2];
   float mix[BUFFER_SIZE * 2];
-  float* dst = out;
+  int16_t pcm[BUFFER_SIZE * 2];
   float* buf = NULL; // The "current" buffer (used for fast paths)
 
-  ma_mutex_lock(&state.lock);
+  // The lock is only held by threads changing the audio geometry, which is rare.  Instead of
+  // waiting for it, spatialized Sources bypass the spatializer for one buffer.
+  bool spatialize = mtx_trylock(&state.lock) == thrd_success;
+
+  runCommands();
+  updateVoices(spatialize);
+  updateBuses();
 
   Source* source;
+  if (offline) {
+    FOREACH_SOURCE(source) {
+      if (source->stream) {
+        streamDecode(source);
+      }
+    }
+  }
+
   FOREACH_SOURCE(source) {
-    if (!source->playing) {
-      state.sources[source->index] = NULL;
-      state.sourceMask &= ~(1ull << source->index);
-      state.spatializer->sourceDestroy(source);
-      source->index = ~0u;
-      lovrRelease(source, lovrSourceDestroy);
+    // Sources that stopped stay rendered until the lock is available, but they're silent
+    if (!source->renderPlaying) {
+      continue;
+    }
+
+    // Sources scheduled with a start or stop time only play part of the buffer
+    uint32_t start, end;
+    if (!voiceSchedule(source, &start, &end)) {
       continue;
     }
 
-    // Read and convert raw frames until there's BUFFER_SIZE converted frames
-    // - No converter: just read frames into raw (it has enough space for BUFFER_SIZE frames).
+    if (source->stream) {
+      state.decodePending = true;
+    }
+
+    // Read and convert raw frames until there's enough converted frames
+    // - No converter: just read frames into raw (it has enough space for BUFFER_SIZE frames).  16
+    //   bit frames are read into pcm and converted into raw.
     // - Converter: keep reading as many frames as possible/needed into raw and convert into aux.
     // - If EOF is reached, rewind and continue for looping sources, otherwise pad end with zero.
     buf = source->converter ? aux : raw;
-    float* cursor = buf; // Edge of processed frames
     uint32_t channelsOut = source->spatial ? 1 : 2; // If spatializer isn't converting to stereo, converter must do it
-    uint32_t framesRemaining = BUFFER_SIZE;
+    float* cursor = buf + start * channelsOut; // Edge of processed frames
+    uint32_t framesRemaining = end - start;
+    bool decoded = false;
+    memset(buf, 0, start * channelsOut * sizeof(float));
     while (framesRemaining > 0) {
       uint32_t framesRead;
 
@@ -108,23 +1016,50 @@ static void onPlayback(ma_device* device, void* out, const void* in, uint32_t co
         uint32_t capacity = sizeof(raw) / (channelsIn * sizeof(float));
         ma_uint64 chunk;
         ma_data_converter_get_required_input_frame_count(source->converter, framesRemaining, &chunk);
-        framesRead = lovrSoundRead(source->sound, source->offset, MIN(chunk, capacity), raw);
+        if (source->stream) {
+          framesRead = streamRead(source, MIN(chunk, capacity), raw);
+        } else {
+          framesRead = lovrSoundRead(source->sound, source->offset, MIN(chunk, capacity), raw);
+        }
       } else {
-        framesRead = lovrSoundRead(source->sound, source->offset, framesRemaining, cursor);
+        bool convert = lovrSoundGetFormat(source->sound) == SAMPLE_I16;
+        void* target = convert ? (void*) pcm : (void*) cursor;
+        if (source->stream) {
+          framesRead = streamRead(source, framesRemaining, target);
+        } else {
+          framesRead = lovrSoundRead(source->sound, source->offset, framesRemaining, target);
+        }
+        if (convert) {
+          mix_convert_i16(cursor, pcm, framesRead * channelsOut);
+        }
       }
 
       if (framesRead == 0) {
-        if (source->looping) {
+        if (source->stream && offline && !decoded) {
+          // After a seek, the ring can be full of frames that were just skipped
+          streamDecode(source);
+          decoded = true;
+          continue;
+        } else if (source->stream && (!streamFinished(source->stream) || atomic_load(&source->looping))) {
+          // The decoder fell behind, or hasn't noticed that the Source started looping yet
+          memset(cursor, 0, framesRemaining * channelsOut * sizeof(float));
+          break;
+        } else if (atomic_load(&source->looping)) {
           source->offset = 0;
           continue;
         } else {
-          source->offset = 0;
-          source->playing = false;
+          voiceStop(source);
           memset(cursor, 0, framesRemaining * channelsOut * sizeof(float));
           break;
         }
       } else {
         source->offset += framesRead;
+
+        // Streams loop on their own, so the offset has to wrap around to match
+        uint32_t frameCount = lovrSoundGetFrameCount(source->sound);
+        if (source->stream && source->offset >= frameCount && frameCount > 0) {
+          source->offset %= frameCount;
+        }
       }
 
       if (source->converter) {
@@ -139,26 +1074,62 @@ static void onPlayback(ma_device* device, void* out, const void* in, uint32_t co
       }
     }
 
-    // Spatialize
+    source->startFrame = 0;
+
+    if (end < BUFFER_SIZE) {
+      memset(buf + end * channelsOut, 0, (BUFFER_SIZE - end) * channelsOut * sizeof(float));
+      voiceStop(source);
+    }
+
+    // Spatialize.  Without the lock, the Source is panned to the center with its attenuation, so it
+    // doesn't drop out (its frames were already read).
     if (source->spatial) {
-      state.spatializer->apply(source, buf, mix, BUFFER_SIZE, BUFFER_SIZE);
+      if (spatialize) {
+        state.spatializer->apply(source, buf, mix, BUFFER_SIZE, BUFFER_SIZE);
+      } else {
+        float gain = .5f * voiceAttenuation(source);
+        float pan[2] = { gain, gain };
+        mix_pan(mix, buf, BUFFER_SIZE, pan, pan, 0.f);
+      }
       buf = mix;
     }
 
-    // Mix
-    float volume = source->volume;
-    for (uint32_t i = 0; i < OUTPUT_CHANNELS * BUFFER_SIZE; i++) {
-      dst[i] += buf[i] * volume;
-    }
+    // Mix, ramping to the new volume over the buffer
+    float* target = source->renderBus ? source->renderBus->buffer : dst;
+    mix_add_ramp(target, buf, BUFFER_SIZE, source->mixVolume, source->renderVolume);
+    source->mixVolume = source->renderVolume;
+    atomic_store(&source->tell, source->offset);
+  }
+
+  for (uint32_t i = 0; i < state.busCount; i++) {
+    Bus* bus = state.buses[i];
+    processBus(bus, bus->parent ? bus->parent->buffer : dst);
   }
 
   // Tail
-  uint32_t tailCount = state.spatializer->tail(aux, mix, BUFFER_SIZE);
-  for (uint32_t i = 0; i < tailCount * OUTPUT_CHANNELS; i++) {
-    dst[i] += mix[i];
+  if (spatialize) {
+    uint32_t tailCount = state.spatializer->tail(aux, mix, BUFFER_SIZE);
+    for (uint32_t i = 0; i < tailCount * OUTPUT_CHANNELS; i++) {
+      dst[i] += mix[i];
+    }
+
+    mtx_unlock(&state.lock);
   }
 
-  ma_mutex_unlock(&state.lock);
+  flushDecodeRequests();
+
+  state.frame += BUFFER_SIZE;
+  atomic_fetch_add(&state.clock, 1);
+}
+
+// Device callbacks
+
+static void onPlayback(ma_device* device, void* out, const void* in, uint32_t count) {
+  lovrAssert(count == BUFFER_SIZE, "Unreachable");
+  float aux[BUFFER_SIZE * 2];
+  float* dst = out;
+
+  mixSources(dst, false);
 
   if (state.sinks[AUDIO_PLAYBACK]) {
     uint64_t capacity = sizeof(aux) / lovrSoundGetChannelCount(state.sinks[AUDIO_PLAYBACK]) / sizeof(float);
@@ -186,7 +1157,10 @@ static Spatializer* spatializers[] = {
 #ifdef LOVR_ENABLE_OCULUS_SPATIALIZER
   &oculusSpatializer,
 #endif
-  &simpleSpatializer
+  &simpleSpatializer,
+#ifdef LOVR_ENABLE_HRTF_SPATIALIZER
+  &hrtfSpatializer
+#endif
 };
 
 // Entry
@@ -199,8 +1173,8 @@ bool lovrAudioInit(const char* spatializer, uint32_t sampleRate) {
   ma_result result = ma_context_init(NULL, 0, NULL, &state.context);
   lovrAssert(result == MA_SUCCESS, "Failed to initialize miniaudio");
 
-  result = ma_mutex_init(&state.lock);
-  lovrAssert(result == MA_SUCCESS, "Failed to create audio mutex");
+  lovrAssert(mtx_init(&state.lock, mtx_plain) == thrd_success, "Failed to create audio mutex");
+  lovrAssert(mtx_init(&state.commandLock, mtx_plain) == thrd_success, "Failed to create audio mutex");
 
   for (size_t i = 0; i < COUNTOF(spatializers); i++) {
     if (spatializer && strcmp(spatializer, spatializers[i]->name)) {
@@ -221,6 +1195,29 @@ bool lovrAudioInit(const char* spatializer, uint32_t sampleRate) {
 
   quat_identity(state.orientation);
 
+  // If the decoder thread can't be started, compressed Sounds are decoded in the audio callback
+  arr_init(&state.streams, arr_alloc);
+  if (mtx_init(&state.decodeLock, mtx_plain) == thrd_success) {
+    if (mtx_init(&state.renderLock, mtx_plain) == thrd_success) {
+      if (cnd_init(&state.decodeWake) == thrd_success) {
+        atomic_store(&state.decoding, true);
+        if (thrd_create(&state.decoder, decoderThread, NULL) != thrd_success) {
+          atomic_store(&state.decoding, false);
+          cnd_destroy(&state.decodeWake);
+          mtx_destroy(&state.renderLock);
+          mtx_destroy(&state.decodeLock);
+        }
+      } else {
+        mtx_destroy(&state.renderLock);
+        mtx_destroy(&state.decodeLock);
+      }
+    } else {
+      mtx_destroy(&state.decodeLock);
+    }
+  }
+
+  state.renderCursor = BUFFER_SIZE;
+
   return state.initialized = true;
 }
 
@@ -229,12 +1226,32 @@ void lovrAudioDestroy() {
   for (size_t i = 0; i < 2; i++) {
     ma_device_uninit(&state.devices[i]);
   }
-  Source* source;
-  FOREACH_SOURCE(source) lovrRelease(source, lovrSourceDestroy);
-  ma_mutex_uninit(&state.lock);
+  if (atomic_load(&state.decoding)) {
+    mtx_lock(&state.decodeLock);
+    atomic_store(&state.decoding, false);
+    cnd_signal(&state.decodeWake);
+    mtx_unlock(&state.decodeLock);
+    thrd_join(state.decoder, NULL);
+    cnd_destroy(&state.decodeWake);
+    mtx_destroy(&state.decodeLock);
+    mtx_destroy(&state.renderLock);
+  }
+  arr_free(&state.streams);
+  state.started = false;
+  runCommands();
+  for (uint32_t i = 0; i < state.voiceCount; i++) {
+    lovrRelease(state.voices[i], lovrSourceDestroy);
+  }
+  for (uint32_t i = 0; i < state.busCount; i++) {
+    lovrRelease(state.buses[i], lovrBusDestroy);
+  }
+  destroyRetired();
+  mtx_destroy(&state.lock);
+  mtx_destroy(&state.commandLock);
   ma_context_uninit(&state.context);
   lovrRelease(state.sinks[AUDIO_PLAYBACK], lovrSoundDestroy);
   lovrRelease(state.sinks[AUDIO_CAPTURE], lovrSoundDestroy);
+  lovrRelease(state.reverb, lovrSoundDestroy);
   if (state.spatializer) state.spatializer->destroy();
   ma_data_converter_uninit(&state.playbackConverter, NULL);
   memset(&state, 0, sizeof(state));
@@ -270,7 +1287,10 @@ bool lovrAudioSetDevice(AudioType type, void* id, size_t size, Sound* sink, Audi
   lovrAssert(!sink || lovrSoundGetChannelLayout(sink) != CHANNEL_AMBISONIC, "Ambisonic Sounds cannot be used as sinks");
   lovrAssert(!sink || lovrSoundIsStream(sink), "Sinks must be streams");
 
+  mtx_lock(&state.commandLock);
   ma_device_uninit(&state.devices[type]);
+  state.started &= type != AUDIO_PLAYBACK;
+  mtx_unlock(&state.commandLock);
   lovrRelease(state.sinks[type], lovrSoundDestroy);
   state.sinks[type] = sink;
 
@@ -323,12 +1343,30 @@ bool lovrAudioSetDevice(AudioType type, void* id, size_t size, Sound* sink, Audi
   return result == MA_SUCCESS;
 }
 
+// The command lock is held while the playback device starts or stops, so senders know whether the
+// callback is running
 bool lovrAudioStart(AudioType type) {
-  return ma_device_start(&state.devices[type]) == MA_SUCCESS;
+  if (type == AUDIO_CAPTURE) {
+    return ma_device_start(&state.devices[type]) == MA_SUCCESS;
+  }
+
+  mtx_lock(&state.commandLock);
+  bool success = ma_device_start(&state.devices[type]) == MA_SUCCESS;
+  state.started = ma_device_is_started(&state.devices[type]);
+  mtx_unlock(&state.commandLock);
+  return success;
 }
 
 bool lovrAudioStop(AudioType type) {
-  return ma_device_stop(&state.devices[type]) == MA_SUCCESS;
+  if (type == AUDIO_CAPTURE) {
+    return ma_device_stop(&state.devices[type]) == MA_SUCCESS;
+  }
+
+  mtx_lock(&state.commandLock);
+  bool success = ma_device_stop(&state.devices[type]) == MA_SUCCESS;
+  state.started = ma_device_is_started(&state.devices[type]);
+  mtx_unlock(&state.commandLock);
+  return success;
 }
 
 bool lovrAudioIsStarted(AudioType type) {
@@ -352,16 +1390,173 @@ void lovrAudioGetPose(float position[4], float orientation[4]) {
 }
 
 void lovrAudioSetPose(float position[4], float orientation[4]) {
+  memcpy(state.position, position, sizeof(state.position));
+  memcpy(state.orientation, orientation, sizeof(state.orientation));
   state.spatializer->setListenerPose(position, orientation);
 }
 
 bool lovrAudioSetGeometry(float* vertices, uint32_t* indices, uint32_t vertexCount, uint32_t indexCount, AudioMaterial material) {
-  ma_mutex_lock(&state.lock);
+  mtx_lock(&state.lock);
   bool success = state.spatializer->setGeometry(vertices, indices, vertexCount, indexCount, material);
-  ma_mutex_unlock(&state.lock);
+  mtx_unlock(&state.lock);
   return success;
 }
 
+Sound* lovrAudioGetReverb(float* gain) {
+  *gain = state.reverbGain;
+  return state.reverb;
+}
+
+// The convolver is built before taking the lock, since it can take a while for long impulse
+// responses and the audio thread skips spatialization while the lock is held.
+bool lovrAudioSetReverb(Sound* sound, float gain) {
+  if (!state.spatializer->setReverb) {
+    return false;
+  }
+
+  if (sound != state.reverb) {
+    dsp_convolver* convolver = NULL;
+
+    if (sound) {
+      uint32_t frames, channels;
+      float* ir = lovrAudioReadImpulseResponse(sound, &frames, &channels);
+      convolver = dsp_convolver_create(BUFFER_SIZE, ir, frames, channels);
+      free(ir);
+      lovrAssert(convolver, "Out of memory");
+    }
+
+    lovrRetain(sound);
+    lovrRelease(state.reverb, lovrSoundDestroy);
+    state.reverb = sound;
+    state.reverbConvolver = convolver;
+  }
+
+  state.reverbGain = gain;
+
+  mtx_lock(&state.lock);
+  dsp_convolver* previous = state.spatializer->setReverb(state.reverbConvolver, gain);
+  mtx_unlock(&state.lock);
+
+  if (previous != state.reverbConvolver) {
+    dsp_convolver_destroy(previous);
+  }
+
+  return true;
+}
+
+// Directions are azimuth/elevation pairs in degrees, using the SOFA convention: azimuth goes
+// counterclockwise from straight ahead and elevation goes up from the horizon.
+bool lovrAudioSetHRTF(Sound* sound, float* directions, uint32_t count) {
+  if (!state.spatializer->setHRTF) {
+    return false;
+  }
+
+  lovrCheck(count > 0, "HRTF must have at least one direction");
+  lovrCheck(lovrSoundGetChannelLayout(sound) == CHANNEL_STEREO, "HRTF impulse responses must be stereo");
+
+  uint32_t frames, channels;
+  float* hrirs = lovrAudioReadImpulseResponse(sound, &frames, &channels);
+  float* vectors = malloc(count * 3 * sizeof(float));
+  lovrAssert(vectors, "Out of memory");
+
+  if (frames < count) {
+    free(hrirs);
+    free(vectors);
+    lovrThrow("HRTF Sound has fewer frames than directions");
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    float azimuth = directions[2 * i + 0] * (float) M_PI / 180.f;
+    float elevation = directions[2 * i + 1] * (float) M_PI / 180.f;
+    vectors[3 * i + 0] = -sinf(azimuth) * cosf(elevation);
+    vectors[3 * i + 1] = sinf(elevation);
+    vectors[3 * i + 2] = -cosf(azimuth) * cosf(elevation);
+  }
+
+  mtx_lock(&state.lock);
+  bool success = state.spatializer->setHRTF(hrirs, vectors, count, frames / count);
+  mtx_unlock(&state.lock);
+
+  free(hrirs);
+  free(vectors);
+  return success;
+}
+
+// Offline rendering runs the same mixer as the playback device, so it holds the command lock to
+// make sure the device isn't running.  Frames are mixed in whole buffers, and any frames left over
+// are kept for the next call, so rendering in small pieces gives the same result.
+uint32_t lovrAudioRender(Sound* sound, uint32_t offset, uint32_t count) {
+  lovrCheck(lovrSoundGetChannelLayout(sound) == CHANNEL_STEREO, "Audio can only be rendered to stereo Sounds");
+  lovrCheck(lovrSoundGetSampleRate(sound) == state.sampleRate, "Sound sample rate must match the audio sample rate (%d)", state.sampleRate);
+  lovrCheck(!lovrSoundIsCompressed(sound), "Audio can not be rendered to a compressed Sound");
+  lovrCheck(lovrSoundIsStream(sound) || lovrSoundGetBlob(sound), "Audio can not be rendered to a Sound with a callback");
+  lovrCheck(lovrSoundIsStream(sound) || offset <= lovrSoundGetFrameCount(sound), "Tried to render past the end of the Sound");
+
+  mtx_lock(&state.commandLock);
+
+  if (state.started) {
+    mtx_unlock(&state.commandLock);
+    lovrThrow("Audio can not be rendered while the playback device is started");
+  }
+
+  bool decoding = atomic_load(&state.decoding);
+  if (decoding) mtx_lock(&state.renderLock);
+
+  uint32_t frames = 0;
+  while (frames < count) {
+    if (state.renderCursor == BUFFER_SIZE) {
+      memset(state.renderBuffer, 0, sizeof(state.renderBuffer));
+      mixSources(state.renderBuffer, true);
+      state.renderCursor = 0;
+    }
+
+    uint32_t chunk = MIN(count - frames, BUFFER_SIZE - state.renderCursor);
+    float* data = state.renderBuffer + state.renderCursor * OUTPUT_CHANNELS;
+    uint32_t written;
+
+    if (lovrSoundGetFormat(sound) == SAMPLE_I16) {
+      int16_t pcm[BUFFER_SIZE * OUTPUT_CHANNELS];
+      ma_pcm_f32_to_s16(pcm, data, chunk * OUTPUT_CHANNELS, ma_dither_mode_none);
+      written = lovrSoundWrite(sound, offset + frames, chunk, pcm);
+    } else {
+      written = lovrSoundWrite(sound, offset + frames, chunk, data);
+    }
+
+    state.renderCursor += written;
+    frames += written;
+
+    if (written < chunk) {
+      break;
+    }
+  }
+
+  if (decoding) mtx_unlock(&state.renderLock);
+  mtx_unlock(&state.commandLock);
+  return frames;
+}
+
+// Decodes a mono or stereo Sound to floats at the audio sample rate, for use as an impulse response
+float* lovrAudioReadImpulseResponse(Sound* sound, uint32_t* frames, uint32_t* channels) {
+  lovrCheck(lovrSoundGetChannelLayout(sound) != CHANNEL_AMBISONIC, "Impulse responses can not be ambisonic");
+  lovrCheck(!lovrSoundIsStream(sound), "Impulse responses can not be streams");
+  uint32_t frameCount = lovrSoundGetFrameCount(sound);
+  lovrCheck(frameCount > 0 && frameCount != LOVR_SOUND_ENDLESS, "Impulse responses must have a fixed, nonzero length");
+
+  *channels = lovrSoundGetChannelCount(sound);
+  void* raw = malloc(frameCount * lovrSoundGetStride(sound));
+  lovrAssert(raw, "Out of memory");
+  frameCount = lovrSoundRead(sound, 0, frameCount, raw);
+
+  ma_format format = miniaudioFormats[lovrSoundGetFormat(sound)];
+  uint32_t rate = lovrSoundGetSampleRate(sound);
+  *frames = (uint32_t) ma_convert_frames(NULL, 0, ma_format_f32, *channels, state.sampleRate, raw, frameCount, format, *channels, rate);
+  float* ir = malloc(*frames * *channels * sizeof(float));
+  lovrAssert(ir, "Out of memory");
+  *frames = (uint32_t) ma_convert_frames(ir, *frames, ma_format_f32, *channels, state.sampleRate, raw, frameCount, format, *channels, rate);
+  free(raw);
+  return ir;
+}
+
 const char* lovrAudioGetSpatializer() {
   return state.spatializer->name;
 }
@@ -370,14 +1565,21 @@ uint32_t lovrAudioGetSampleRate() {
   return state.sampleRate;
 }
 
+// The mixer clock is the time of the first frame of the next buffer to be mixed.  It advances while
+// the playback device is running or audio is being rendered.  The main thread only sees whole
+// buffers, but Sources are scheduled on it to the frame.
+double lovrAudioGetTime(void) {
+  return (double) (uint32_t) atomic_load(&state.clock) * BUFFER_SIZE / state.sampleRate;
+}
+
 void lovrAudioGetAbsorption(float absorption[3]) {
   memcpy(absorption, state.absorption, 3 * sizeof(float));
 }
 
 void lovrAudioSetAbsorption(float absorption[3]) {
-  ma_mutex_lock(&state.lock);
+  mtx_lock(&state.lock);
   memcpy(state.absorption, absorption, 3 * sizeof(float));
-  ma_mutex_unlock(&state.lock);
+  mtx_unlock(&state.lock);
 }
 
 // Source
@@ -393,10 +1595,14 @@ Source* lovrSourceCreate(Sound* sound, bool pitchable, bool spatial, uint32_t ef
 
   source->pitch = 1.f;
   source->volume = 1.f;
+  source->renderVolume = 1.f;
+  source->renderPitch = 1.f;
   source->pitchable = pitchable;
   source->spatial = spatial;
   source->effects = spatial ? effects : 0;
+  source->renderEffects = source->effects;
   quat_identity(source->orientation);
+  quat_identity(source->renderOrientation);
 
   ma_data_converter_config config = ma_data_converter_config_init_default();
   config.formatIn = miniaudioFormats[lovrSoundGetFormat(sound)];
@@ -407,13 +1613,16 @@ Source* lovrSourceCreate(Sound* sound, bool pitchable, bool spatial, uint32_t ef
   config.sampleRateOut = state.sampleRate;
   config.allowDynamicSampleRate = pitchable;
 
-  if (pitchable || config.formatIn != config.formatOut || config.channelsIn != config.channelsOut || config.sampleRateIn != config.sampleRateOut) {
+  // 16 bit Sounds that only need format conversion skip the converter and use mix_convert_i16
+  if (pitchable || config.channelsIn != config.channelsOut || config.sampleRateIn != config.sampleRateOut) {
     source->converter = malloc(sizeof(ma_data_converter));
     lovrAssert(source->converter, "Out of memory");
     ma_result status = ma_data_converter_init(&config, NULL, source->converter);
     lovrAssert(status == MA_SUCCESS, "Problem creating Source data converter: %s (%d)", ma_result_description(status), status);
   }
 
+  sourceInitStream(source);
+  sourceInitSpatializer(source);
   return source;
 }
 
@@ -424,15 +1633,27 @@ Source* lovrSourceClone(Source* source) {
   clone->index = ~0u;
   clone->sound = source->sound;
   lovrRetain(clone->sound);
+  clone->priority = source->priority;
+  clone->bus = source->bus;
+  lovrRetain(clone->bus);
   clone->pitch = source->pitch;
   clone->volume = source->volume;
   memcpy(clone->position, source->position, 4 * sizeof(float));
   memcpy(clone->orientation, source->orientation, 4 * sizeof(float));
+  clone->renderVolume = clone->volume;
+  memcpy(clone->renderPosition, clone->position, 4 * sizeof(float));
+  memcpy(clone->renderOrientation, clone->orientation, 4 * sizeof(float));
+  clone->renderPitch = clone->pitch;
+  clone->renderPriority = clone->priority;
   clone->radius = source->radius;
   clone->dipoleWeight = source->dipoleWeight;
   clone->dipolePower = source->dipolePower;
+  clone->renderRadius = clone->radius;
+  clone->renderDipoleWeight = clone->dipoleWeight;
+  clone->renderDipolePower = clone->dipolePower;
   clone->effects = source->effects;
-  clone->looping = source->looping;
+  clone->renderEffects = clone->effects;
+  atomic_store(&clone->looping, atomic_load(&source->looping));
   clone->pitchable = source->pitchable;
   clone->spatial = source->spatial;
   if (source->converter) {
@@ -449,11 +1670,32 @@ Source* lovrSourceClone(Source* source) {
     ma_result status = ma_data_converter_init(&config, NULL, clone->converter);
     lovrAssert(status == MA_SUCCESS, "Problem creating Source data converter: %s (%d)", ma_result_description(status), status);
   }
+  sourceInitStream(clone);
+  sourceInitSpatializer(clone);
+  if (clone->bus) {
+    pushCommand((Command) { .type = COMMAND_BUS, .source = clone, .bus = clone->bus });
+  }
   return clone;
 }
 
 void lovrSourceDestroy(void* ref) {
   Source* source = ref;
+  if (source->stream) {
+    if (atomic_load(&state.decoding)) {
+      mtx_lock(&state.decodeLock);
+      for (size_t i = 0; i < state.streams.length; i++) {
+        if (state.streams.data[i] == source) {
+          state.streams.data[i] = state.streams.data[--state.streams.length];
+          break;
+        }
+      }
+      mtx_unlock(&state.decodeLock);
+    }
+    free(source->stream->data);
+    free(source->stream);
+  }
+  lovrRelease(source->bus, lovrBusDestroy);
+  lovrRelease(source->renderBus, lovrBusDestroy);
   lovrRelease(source->sound, lovrSoundDestroy);
   ma_data_converter_uninit(source->converter, NULL);
   free(source->converter);
@@ -465,31 +1707,42 @@ Sound* lovrSourceGetSound(Source* source) {
 }
 
 bool lovrSourcePlay(Source* source) {
-  // If too many sources already running, refuse to play
-  if (state.sourceMask == ~0ull) {
+  return lovrSourcePlayAt(source, 0.);
+}
+
+// Times are on the mixer clock (lovrAudioGetTime).  A Source that's already playing keeps playing,
+// and a time in the past starts it in the next buffer.
+bool lovrSourcePlayAt(Source* source, double time) {
+  // If too many sources already running, refuse to play.  The count is from the last buffer, so
+  // the audio thread still checks again when it runs the command.
+  if (atomic_load(&state.liveVoices) >= MAX_VOICES) {
     return false;
   }
 
-  ma_mutex_lock(&state.lock);
+  if (source->stream) {
+    streamAllocate(source->stream);
+  }
 
-  source->playing = true;
+  // Serials tell the audio thread's "finished" from the current play apart from an older one's
+  if (++source->plays == 0) source->plays = 1;
+  atomic_store(&source->playing, source->plays);
+  pushCommand((Command) { .type = COMMAND_PLAY, .source = source, .serial = source->plays, .frame = timeToFrame(time) });
 
-  // If the source isn't tracked, set its index to the right-most zero bit in the mask
-  if (source->index == ~0u) {
-    uint32_t index = state.sourceMask ? CTZL(~state.sourceMask) : 0;
-    state.sourceMask |= (1ull << index);
-    state.sources[index] = source;
-    source->index = index;
-    lovrRetain(source);
-    state.spatializer->sourceCreate(source);
+  if (source->stream) {
+    wakeDecoder();
   }
 
-  ma_mutex_unlock(&state.lock);
   return true;
 }
 
+// Only affects the current playback, since playing a Source that isn't playing clears its stop time
+void lovrSourceStopAt(Source* source, double time) {
+  pushCommand((Command) { .type = COMMAND_STOP, .source = source, .frame = timeToFrame(time) });
+}
+
 void lovrSourcePause(Source* source) {
-  source->playing = false;
+  atomic_store(&source->playing, 0);
+  pushCommand((Command) { .type = COMMAND_PAUSE, .source = source });
 }
 
 void lovrSourceStop(Source* source) {
@@ -498,16 +1751,17 @@ void lovrSourceStop(Source* source) {
 }
 
 bool lovrSourceIsPlaying(Source* source) {
-  return source->playing;
+  uint32_t playing = atomic_load(&source->playing);
+  return playing != 0 && atomic_load(&source->finished) != playing;
 }
 
 bool lovrSourceIsLooping(Source* source) {
-  return source->looping;
+  return atomic_load(&source->looping);
 }
 
 void lovrSourceSetLooping(Source* source, bool loop) {
   lovrAssert(loop == false || lovrSoundIsStream(source->sound) == false, "Can't loop streams");
-  source->looping = loop;
+  atomic_store(&source->looping, loop);
 }
 
 float lovrSourceGetPitch(Source* source) {
@@ -520,10 +1774,7 @@ void lovrSourceSetPitch(Source* source, float pitch) {
 
   if (source->pitch != pitch) {
     source->pitch = pitch;
-    ma_mutex_lock(&state.lock);
-    float ratio = (float) lovrSoundGetSampleRate(source->sound) / state.sampleRate;
-    ma_data_converter_set_rate_ratio(source->converter, pitch * ratio);
-    ma_mutex_unlock(&state.lock);
+    pushCommand((Command) { .type = COMMAND_PITCH, .source = source, .pitch = pitch });
   }
 }
 
@@ -534,16 +1785,25 @@ float lovrSourceGetVolume(Source* source, VolumeUnit units) {
 void lovrSourceSetVolume(Source* source, float volume, VolumeUnit units) {
   if (units == UNIT_DECIBELS) volume = dbToLinear(volume);
   source->volume = CLAMP(volume, 0.f, 1.f);
+  pushCommand((Command) { .type = COMMAND_VOLUME, .source = source, .volume = source->volume });
 }
 
 void lovrSourceSeek(Source* source, double time, TimeUnit units) {
-  ma_mutex_lock(&state.lock);
-  source->offset = units == UNIT_SECONDS ? (uint32_t) (time * lovrSoundGetSampleRate(source->sound) + .5) : (uint32_t) time;
-  ma_mutex_unlock(&state.lock);
+  uint32_t offset = units == UNIT_SECONDS ? (uint32_t) (time * lovrSoundGetSampleRate(source->sound) + .5) : (uint32_t) time;
+
+  // Source:tell returns this offset until the audio thread has run the seek
+  source->seekOffset = offset;
+  source->seeks++;
+  pushCommand((Command) { .type = COMMAND_SEEK, .source = source, .serial = source->seeks, .offset = offset });
+
+  if (source->stream) {
+    wakeDecoder();
+  }
 }
 
 double lovrSourceTell(Source* source, TimeUnit units) {
-  return units == UNIT_SECONDS ? (double) source->offset / lovrSoundGetSampleRate(source->sound) : source->offset;
+  uint32_t offset = atomic_load(&source->seeked) == source->seeks ? atomic_load(&source->tell) : source->seekOffset;
+  return units == UNIT_SECONDS ? (double) offset / lovrSoundGetSampleRate(source->sound) : offset;
 }
 
 double lovrSourceGetDuration(Source* source, TimeUnit units) {
@@ -561,10 +1821,12 @@ void lovrSourceGetPose(Source* source, float position[4], float orientation[4])
 }
 
 void lovrSourceSetPose(Source* source, float position[4], float orientation[4]) {
-  ma_mutex_lock(&state.lock);
   memcpy(source->position, position, sizeof(source->position));
   memcpy(source->orientation, orientation, sizeof(source->orientation));
-  ma_mutex_unlock(&state.lock);
+  Command command = { .type = COMMAND_POSE, .source = source };
+  memcpy(command.pose.position, position, 3 * sizeof(float));
+  memcpy(command.pose.orientation, orientation, 4 * sizeof(float));
+  pushCommand(command);
 }
 
 float lovrSourceGetRadius(Source* source) {
@@ -573,6 +1835,7 @@ float lovrSourceGetRadius(Source* source) {
 
 void lovrSourceSetRadius(Source* source, float radius) {
   source->radius = radius;
+  pushCommand((Command) { .type = COMMAND_RADIUS, .source = source, .radius = radius });
 }
 
 void lovrSourceGetDirectivity(Source* source, float* weight, float* power) {
@@ -583,6 +1846,7 @@ void lovrSourceGetDirectivity(Source* source, float* weight, float* power) {
 void lovrSourceSetDirectivity(Source* source, float weight, float power) {
   source->dipoleWeight = weight;
   source->dipolePower = power;
+  pushCommand((Command) { .type = COMMAND_DIRECTIVITY, .source = source, .directivity = { weight, power } });
 }
 
 bool lovrSourceIsEffectEnabled(Source* source, Effect effect) {
@@ -596,6 +1860,51 @@ void lovrSourceSetEffectEnabled(Source* source, Effect effect, bool enabled) {
   } else {
     source->effects &= ~(1 << effect);
   }
+  pushCommand((Command) { .type = COMMAND_EFFECTS, .source = source, .effects = source->effects });
+}
+
+Bus* lovrSourceGetBus(Source* source) {
+  return source->bus;
+}
+
+void lovrSourceSetBus(Source* source, Bus* bus) {
+  if (source->bus != bus) {
+    lovrRetain(bus);
+    lovrRelease(source->bus, lovrBusDestroy);
+    source->bus = bus;
+    pushCommand((Command) { .type = COMMAND_BUS, .source = source, .bus = bus });
+  }
+}
+
+int32_t lovrSourceGetPriority(Source* source) {
+  return source->priority;
+}
+
+void lovrSourceSetPriority(Source* source, int32_t priority) {
+  source->priority = priority;
+  pushCommand((Command) { .type = COMMAND_PRIORITY, .source = source, .priority = priority });
+}
+
+void lovrSourceGetRenderPose(Source* source, float position[4], float orientation[4]) {
+  memcpy(position, source->renderPosition, sizeof(source->renderPosition));
+  memcpy(orientation, source->renderOrientation, sizeof(source->renderOrientation));
+}
+
+float lovrSourceGetRenderVolume(Source* source) {
+  return source->renderVolume;
+}
+
+float lovrSourceGetRenderRadius(Source* source) {
+  return source->renderRadius;
+}
+
+void lovrSourceGetRenderDirectivity(Source* source, float* weight, float* power) {
+  *weight = source->renderDipoleWeight;
+  *power = source->renderDipolePower;
+}
+
+bool lovrSourceIsRenderEffectEnabled(Source* source, Effect effect) {
+  return source->renderEffects & (1 << effect);
 }
 
 intptr_t* lovrSourceGetSpatializerMemoField(Source* source) {
@@ -605,3 +1914,125 @@ intptr_t* lovrSourceGetSpatializerMemoField(Source* source) {
 uint32_t lovrSourceGetIndex(Source* source) {
   return source->index;
 }
+
+// Bus
+
+Bus* lovrBusCreate(Bus* parent) {
+  lovrCheck(atomic_load(&state.liveBuses) < MAX_BUSES, "Too many Buses (the limit is %d)", MAX_BUSES);
+  atomic_fetch_add(&state.liveBuses, 1);
+  Bus* bus = calloc(1, sizeof(Bus));
+  lovrAssert(bus, "Out of memory");
+  bus->ref = 1;
+  bus->parent = parent;
+  bus->depth = parent ? parent->depth + 1 : 0;
+  bus->volume = 1.f;
+  bus->renderVolume = 1.f;
+  bus->mixVolume = 1.f;
+  bus->reverbWet = 1.f;
+  bus->reverbDry = 1.f;
+  lovrRetain(parent);
+  pushCommand((Command) { .type = COMMAND_BUS_ADD, .bus = bus });
+  return bus;
+}
+
+void lovrBusDestroy(void* ref) {
+  Bus* bus = ref;
+  lovrRelease(bus->parent, lovrBusDestroy);
+  lovrRelease(bus->reverbSound, lovrSoundDestroy);
+  dsp_convolver_destroy(bus->reverb);
+  atomic_fetch_sub(&state.liveBuses, 1);
+  free(bus);
+}
+
+Bus* lovrBusGetParent(Bus* bus) {
+  return bus->parent;
+}
+
+float lovrBusGetVolume(Bus* bus, VolumeUnit units) {
+  return units == UNIT_LINEAR ? bus->volume : linearToDb(bus->volume);
+}
+
+void lovrBusSetVolume(Bus* bus, float volume, VolumeUnit units) {
+  if (units == UNIT_DECIBELS) volume = dbToLinear(volume);
+  bus->volume = MAX(volume, 0.f);
+  pushCommand((Command) { .type = COMMAND_BUS_VOLUME, .bus = bus, .volume = bus->volume });
+}
+
+bool lovrBusGetFilter(Bus* bus, FilterType* type, float* frequency, float* q, float* gain) {
+  *type = bus->filterType;
+  *frequency = bus->filterFrequency;
+  *q = bus->filterQ;
+  *gain = bus->filterGain;
+  return bus->filterEnabled;
+}
+
+void lovrBusSetFilter(Bus* bus, bool enabled, FilterType type, float frequency, float q, float gain) {
+  lovrCheck(frequency > 0.f, "Filter frequency must be positive");
+  lovrCheck(q > 0.f, "Filter Q must be positive");
+  bus->filterEnabled = enabled;
+  bus->filterType = type;
+  bus->filterFrequency = frequency;
+  bus->filterQ = q;
+  bus->filterGain = gain;
+  Command command = { .type = COMMAND_BUS_FILTER, .bus = bus, .filter.enabled = enabled };
+  dsp_biquad_design(&command.filter.biquad, type, frequency, q, gain, state.sampleRate);
+  pushCommand(command);
+}
+
+bool lovrBusGetCompressor(Bus* bus, float* threshold, float* ratio, float* attack, float* release, float* makeup) {
+  *threshold = bus->compressorThreshold;
+  *ratio = bus->compressorRatio;
+  *attack = bus->compressorAttack;
+  *release = bus->compressorRelease;
+  *makeup = bus->compressorMakeup;
+  return bus->compressorEnabled;
+}
+
+void lovrBusSetCompressor(Bus* bus, bool enabled, float threshold, float ratio, float attack, float release, float makeup) {
+  lovrCheck(ratio >= 1.f, "Compressor ratio must be at least 1");
+  lovrCheck(attack >= 0.f && release >= 0.f, "Compressor attack and release times can not be negative");
+  bus->compressorEnabled = enabled;
+  bus->compressorThreshold = threshold;
+  bus->compressorRatio = ratio;
+  bus->compressorAttack = attack;
+  bus->compressorRelease = release;
+  bus->compressorMakeup = makeup;
+  Command command = { .type = COMMAND_BUS_COMPRESSOR, .bus = bus, .compressor.enabled = enabled };
+  dsp_compressor_design(&command.compressor.compressor, threshold, ratio, attack, release, makeup, state.sampleRate);
+  pushCommand(command);
+}
+
+Sound* lovrBusGetReverb(Bus* bus, float* wet, float* dry) {
+  *wet = bus->reverbWet;
+  *dry = bus->reverbDry;
+  return bus->reverbSound;
+}
+
+// The convolver is created here and handed to the audio thread, which destroys the old one.  If
+// the Sound didn't change, the same convolver is sent again with the new levels.
+void lovrBusSetReverb(Bus* bus, Sound* sound, float wet, float dry) {
+  if (sound != bus->reverbSound) {
+    dsp_convolver* convolver = NULL;
+
+    if (sound) {
+      uint32_t frames, channels;
+      float* ir = lovrAudioReadImpulseResponse(sound, &frames, &channels);
+      convolver = dsp_convolver_create(BUFFER_SIZE, ir, frames, channels);
+      free(ir);
+      lovrAssert(convolver, "Out of memory");
+    }
+
+    lovrRetain(sound);
+    lovrRelease(bus->reverbSound, lovrSoundDestroy);
+    bus->reverbSound = sound;
+    bus->reverbConvolver = convolver;
+  }
+
+  bus->reverbWet = wet;
+  bus->reverbDry = dry;
+  Command command = { .type = COMMAND_BUS_REVERB, .bus = bus };
+  command.reverb.convolver = bus->reverbConvolver;
+  command.reverb.wet = wet;
+  command.reverb.dry = dry;
+  pushCommand(command);
+}
@@ -5,11 +5,14 @@
 #pragma once
 
 #define BUFFER_SIZE 256
-#define MAX_SOURCES 64
+#define MAX_SOURCES 64 // Sources that can be rendered at once
+#define MAX_VOICES 1024 // Sources that can be playing at once
+#define MAX_BUSES 64
 
 struct Sound;
 
 typedef struct Source Source;
+typedef struct Bus Bus;
 
 typedef enum {
   EFFECT_ABSORPTION,
@@ -54,6 +57,16 @@ typedef enum {
   UNIT_DECIBELS
 } VolumeUnit;
 
+typedef enum {
+  FILTER_LOWPASS,
+  FILTER_HIGHPASS,
+  FILTER_BANDPASS,
+  FILTER_NOTCH,
+  FILTER_PEAK,
+  FILTER_LOWSHELF,
+  FILTER_HIGHSHELF
+} FilterType;
+
 typedef void AudioDeviceCallback(const void* id, size_t size, const char* name, bool isDefault, void* userdata);
 
 bool lovrAudioInit(const char* spatializer, uint32_t sampleRate);
@@ -68,8 +81,14 @@ void lovrAudioSetVolume(float volume, VolumeUnit units);
 void lovrAudioGetPose(float position[4], float orientation[4]);
 void lovrAudioSetPose(float position[4], float orientation[4]);
 bool lovrAudioSetGeometry(float* vertices, uint32_t* indices, uint32_t vertexCount, uint32_t indexCount, AudioMaterial material);
+struct Sound* lovrAudioGetReverb(float* gain);
+bool lovrAudioSetReverb(struct Sound* sound, float gain);
+bool lovrAudioSetHRTF(struct Sound* sound, float* directions, uint32_t count);
+uint32_t lovrAudioRender(struct Sound* sound, uint32_t offset, uint32_t count);
+float* lovrAudioReadImpulseResponse(struct Sound* sound, uint32_t* frames, uint32_t* channels);
 const char* lovrAudioGetSpatializer(void);
 uint32_t lovrAudioGetSampleRate(void);
+double lovrAudioGetTime(void);
 void lovrAudioGetAbsorption(float absorption[3]);
 void lovrAudioSetAbsorption(float absorption[3]);
 
@@ -80,6 +99,8 @@ Source* lovrSourceClone(Source* source);
 void lovrSourceDestroy(void* ref);
 struct Sound* lovrSourceGetSound(Source* source);
 bool lovrSourcePlay(Source* source);
+bool lovrSourcePlayAt(Source* source, double time);
+void lovrSourceStopAt(Source* source, double time);
 void lovrSourcePause(Source* source);
 void lovrSourceStop(Source* source);
 bool lovrSourceIsPlaying(Source* source);
@@ -102,3 +123,21 @@ void lovrSourceGetDirectivity(Source* source, float* weight, float* power);
 void lovrSourceSetDirectivity(Source* source, float weight, float power);
 bool lovrSourceIsEffectEnabled(Source* source, Effect effect);
 void lovrSourceSetEffectEnabled(Source* Source, Effect effect, bool enabled);
+Bus* lovrSourceGetBus(Source* source);
+void lovrSourceSetBus(Source* source, Bus* bus);
+int32_t lovrSourceGetPriority(Source* source);
+void lovrSourceSetPriority(Source* source, int32_t priority);
+
+// Bus
+
+Bus* lovrBusCreate(Bus* parent);
+void lovrBusDestroy(void* ref);
+Bus* lovrBusGetParent(Bus* bus);
+float lovrBusGetVolume(Bus* bus, VolumeUnit units);
+void lovrBusSetVolume(Bus* bus, float volume, VolumeUnit units);
+bool lovrBusGetFilter(Bus* bus, FilterType* type, float* frequency, float* q, float* gain);
+void lovrBusSetFilter(Bus* bus, bool enabled, FilterType type, float frequency, float q, float gain);
+bool lovrBusGetCompressor(Bus* bus, float* threshold, float* ratio, float* attack, float* release, float* makeup);
+void lovrBusSetCompressor(Bus* bus, bool enabled, float threshold, float ratio, float attack, float release, float makeup);
+struct Sound* lovrBusGetReverb(Bus* bus, float* wet, float* dry);
+void lovrBusSetReverb(Bus* bus, struct Sound* sound, float wet, float dry);
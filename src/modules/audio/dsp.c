@@ -0,0 +1,464 @@
+#include "audio/dsp.h"
+#include "audio/mix.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DSP_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DSP_NEON
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979
+#endif
+
+// FFT
+
+// The real transform packs the input into a complex transform of half the size (even samples are
+// the real parts, odd samples are the imaginary parts), then splits the result using the symmetry
+// of real spectra.  The complex transform runs on planar data in work, so the butterflies of each
+// stage are 4 wide.  twiddles holds the twiddles for the stage with half size h at index h (real
+// parts first, then imaginary parts), and split holds the twiddles for the split step.
+
+bool dsp_fft_init(dsp_fft* fft, uint32_t size) {
+  if (size < 4 || (size & (size - 1))) return false;
+  uint32_t n = size / 2;
+  fft->size = size;
+  fft->reverse = malloc(n * sizeof(uint32_t));
+  fft->twiddles = malloc(2 * n * sizeof(float));
+  fft->split = malloc((n / 2 + 1) * 2 * sizeof(float));
+  fft->work = malloc(2 * n * sizeof(float));
+
+  if (!fft->reverse || !fft->twiddles || !fft->split || !fft->work) {
+    dsp_fft_destroy(fft);
+    return false;
+  }
+
+  uint32_t bits = 0;
+  while ((1u << bits) < n) bits++;
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t r = 0;
+    for (uint32_t b = 0; b < bits; b++) {
+      r |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    fft->reverse[i] = r;
+  }
+
+  fft->twiddles[0] = 1.f;
+  fft->twiddles[n] = 0.f;
+  for (uint32_t half = 1; half < n; half <<= 1) {
+    for (uint32_t k = 0; k < half; k++) {
+      double angle = -M_PI * k / half;
+      fft->twiddles[half + k] = (float) cos(angle);
+      fft->twiddles[n + half + k] = (float) sin(angle);
+    }
+  }
+
+  for (uint32_t k = 0; k <= n / 2; k++) {
+    double angle = -2. * M_PI * k / size;
+    fft->split[2 * k + 0] = (float) cos(angle);
+    fft->split[2 * k + 1] = (float) sin(angle);
+  }
+
+  return true;
+}
+
+void dsp_fft_destroy(dsp_fft* fft) {
+  free(fft->reverse);
+  free(fft->twiddles);
+  free(fft->split);
+  free(fft->work);
+  memset(fft, 0, sizeof(*fft));
+}
+
+// Iterative radix-2 transform of size / 2 complex values, already in bit reversed order in work.
+// The inverse is unscaled.
+static void fft_complex(const dsp_fft* fft, bool inverse) {
+  uint32_t n = fft->size / 2;
+  float* re = fft->work;
+  float* im = fft->work + n;
+  float sign = inverse ? -1.f : 1.f;
+
+  // The first two stages only have twiddles of 1 and -i (or i for the inverse), so they're merged
+  for (uint32_t i = 0; i + 4 <= n; i += 4) {
+    float r0 = re[i + 0] + re[i + 1], i0 = im[i + 0] + im[i + 1];
+    float r1 = re[i + 0] - re[i + 1], i1 = im[i + 0] - im[i + 1];
+    float r2 = re[i + 2] + re[i + 3], i2 = im[i + 2] + im[i + 3];
+    float r3 = re[i + 2] - re[i + 3], i3 = im[i + 2] - im[i + 3];
+    float tr = i3 * sign, ti = -r3 * sign;
+    re[i + 0] = r0 + r2, im[i + 0] = i0 + i2;
+    re[i + 2] = r0 - r2, im[i + 2] = i0 - i2;
+    re[i + 1] = r1 + tr, im[i + 1] = i1 + ti;
+    re[i + 3] = r1 - tr, im[i + 3] = i1 - ti;
+  }
+
+  for (uint32_t half = n >= 4 ? 4 : 1; half < n; half <<= 1) {
+    const float* twr = fft->twiddles + half;
+    const float* twi = fft->twiddles + n + half;
+    for (uint32_t start = 0; start < n; start += 2 * half) {
+      float* ar = re + start;
+      float* ai = im + start;
+      float* br = re + start + half;
+      float* bi = im + start + half;
+      uint32_t k = 0;
+#if defined(DSP_SSE)
+      __m128 s = _mm_set1_ps(sign);
+      for (; k + 4 <= half; k += 4) {
+        __m128 wr = _mm_loadu_ps(twr + k);
+        __m128 wi = _mm_mul_ps(_mm_loadu_ps(twi + k), s);
+        __m128 xr = _mm_loadu_ps(br + k), xi = _mm_loadu_ps(bi + k);
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+        __m128 yr = _mm_loadu_ps(ar + k), yi = _mm_loadu_ps(ai + k);
+        _mm_storeu_ps(br + k, _mm_sub_ps(yr, tr));
+        _mm_storeu_ps(bi + k, _mm_sub_ps(yi, ti));
+        _mm_storeu_ps(ar + k, _mm_add_ps(yr, tr));
+        _mm_storeu_ps(ai + k, _mm_add_ps(yi, ti));
+      }
+#elif defined(DSP_NEON)
+      for (; k + 4 <= half; k += 4) {
+        float32x4_t wr = vld1q_f32(twr + k);
+        float32x4_t wi = vmulq_n_f32(vld1q_f32(twi + k), sign);
+        float32x4_t xr = vld1q_f32(br + k), xi = vld1q_f32(bi + k);
+        float32x4_t tr = vmlsq_f32(vmulq_f32(xr, wr), xi, wi);
+        float32x4_t ti = vmlaq_f32(vmulq_f32(xr, wi), xi, wr);
+        float32x4_t yr = vld1q_f32(ar + k), yi = vld1q_f32(ai + k);
+        vst1q_f32(br + k, vsubq_f32(yr, tr));
+        vst1q_f32(bi + k, vsubq_f32(yi, ti));
+        vst1q_f32(ar + k, vaddq_f32(yr, tr));
+        vst1q_f32(ai + k, vaddq_f32(yi, ti));
+      }
+#endif
+      for (; k < half; k++) {
+        float wr = twr[k];
+        float wi = twi[k] * sign;
+        float tr = br[k] * wr - bi[k] * wi;
+        float ti = br[k] * wi + bi[k] * wr;
+        br[k] = ar[k] - tr;
+        bi[k] = ai[k] - ti;
+        ar[k] += tr;
+        ai[k] += ti;
+      }
+    }
+  }
+}
+
+// With Z the complex transform, E = (Z[k] + conj(Z[n - k])) / 2 and O = (Z[k] - conj(Z[n - k])) / 2i
+// are the transforms of the even and odd samples, and X[k] = E + W^k O, X[n - k] = conj(E - W^k O).
+void dsp_fft_forward(const dsp_fft* fft, const float* input, float* spectrum) {
+  uint32_t n = fft->size / 2;
+  float* re = fft->work;
+  float* im = fft->work + n;
+
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t j = fft->reverse[i];
+    re[i] = input[2 * j + 0];
+    im[i] = input[2 * j + 1];
+  }
+
+  fft_complex(fft, false);
+
+  spectrum[0] = re[0] + im[0];
+  spectrum[1] = 0.f;
+  spectrum[2 * n + 0] = re[0] - im[0];
+  spectrum[2 * n + 1] = 0.f;
+
+  for (uint32_t k = 1; k <= n / 2; k++) {
+    float xr = re[k], xi = im[k];
+    float yr = re[n - k], yi = im[n - k];
+    float er = .5f * (xr + yr);
+    float ei = .5f * (xi - yi);
+    float odr = .5f * (xi + yi);
+    float odi = -.5f * (xr - yr);
+    float wr = fft->split[2 * k + 0];
+    float wi = fft->split[2 * k + 1];
+    float tr = wr * odr - wi * odi;
+    float ti = wr * odi + wi * odr;
+    spectrum[2 * k + 0] = er + tr;
+    spectrum[2 * k + 1] = ei + ti;
+    spectrum[2 * (n - k) + 0] = er - tr;
+    spectrum[2 * (n - k) + 1] = -(ei - ti);
+  }
+}
+
+// Undoes the split (E = (X[k] + conj(X[n - k])) / 2, O = (X[k] - conj(X[n - k])) / 2W^k) to get
+// Z = E + iO, then does the inverse complex transform.  The spectrum is used as scratch space.
+void dsp_fft_inverse(const dsp_fft* fft, float* spectrum, float* output) {
+  uint32_t n = fft->size / 2;
+  float* re = fft->work;
+  float* im = fft->work + n;
+
+  float r0 = spectrum[0], rn = spectrum[2 * n];
+  spectrum[0] = .5f * (r0 + rn);
+  spectrum[1] = .5f * (r0 - rn);
+
+  for (uint32_t k = 1; k <= n / 2; k++) {
+    float* x = spectrum + 2 * k;
+    float* y = spectrum + 2 * (n - k);
+    float er = .5f * (x[0] + y[0]);
+    float ei = .5f * (x[1] - y[1]);
+    float dr = .5f * (x[0] - y[0]);
+    float di = .5f * (x[1] + y[1]);
+    float wr = fft->split[2 * k + 0];
+    float wi = -fft->split[2 * k + 1];
+    float odr = dr * wr - di * wi;
+    float odi = dr * wi + di * wr;
+    x[0] = er - odi;
+    x[1] = ei + odr;
+    y[0] = er + odi;
+    y[1] = -ei + odr;
+  }
+
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t j = fft->reverse[i];
+    re[i] = spectrum[2 * j + 0];
+    im[i] = spectrum[2 * j + 1];
+  }
+
+  fft_complex(fft, true);
+
+  float scale = 1.f / n;
+  for (uint32_t i = 0; i < n; i++) {
+    output[2 * i + 0] = re[i] * scale;
+    output[2 * i + 1] = im[i] * scale;
+  }
+}
+
+// Convolver
+
+// Spectra in the filters and the delay line are stored planar (all the real parts, then all the
+// imaginary parts), padded to a multiple of 4 bins, so the multiply-accumulate is plain SIMD.
+struct dsp_convolver {
+  uint32_t blockSize;
+  uint32_t channels;
+  uint32_t partitions;
+  uint32_t bins;
+  uint32_t stride;
+  uint32_t head;
+  dsp_fft fft;
+  float* filters;
+  float* history;
+  float* input;
+  float* accumulator;
+  float* spectrum;
+  float* time;
+};
+
+static void deinterleave(float* planar, const float* spectrum, uint32_t bins, uint32_t stride) {
+  for (uint32_t k = 0; k < bins; k++) {
+    planar[k] = spectrum[2 * k + 0];
+    planar[stride + k] = spectrum[2 * k + 1];
+  }
+}
+
+dsp_convolver* dsp_convolver_create(uint32_t blockSize, const float* ir, uint32_t frames, uint32_t channels) {
+  dsp_convolver* convolver = calloc(1, sizeof(dsp_convolver));
+  if (!convolver) return NULL;
+
+  if (!dsp_fft_init(&convolver->fft, 2 * blockSize)) {
+    free(convolver);
+    return NULL;
+  }
+
+  uint32_t partitions = MAX((frames + blockSize - 1) / blockSize, 1);
+  uint32_t bins = blockSize + 1;
+  uint32_t stride = (bins + 3) & ~3u;
+  convolver->blockSize = blockSize;
+  convolver->channels = channels;
+  convolver->partitions = partitions;
+  convolver->bins = bins;
+  convolver->stride = stride;
+  convolver->filters = calloc((size_t) channels * partitions * 2 * stride, sizeof(float));
+  convolver->history = calloc((size_t) partitions * 2 * stride, sizeof(float));
+  convolver->input = calloc(2 * blockSize, sizeof(float));
+  convolver->accumulator = calloc(2 * stride, sizeof(float));
+  convolver->spectrum = calloc(2 * bins, sizeof(float));
+  convolver->time = calloc(2 * blockSize, sizeof(float));
+
+  if (!convolver->filters || !convolver->history || !convolver->input || !convolver->accumulator || !convolver->spectrum || !convolver->time) {
+    dsp_convolver_destroy(convolver);
+    return NULL;
+  }
+
+  // Each partition is zero padded to twice the block size, which is what makes overlap-save work
+  for (uint32_t c = 0; c < channels; c++) {
+    for (uint32_t p = 0; p < partitions; p++) {
+      memset(convolver->time, 0, 2 * blockSize * sizeof(float));
+      for (uint32_t i = 0; i < blockSize && p * blockSize + i < frames; i++) {
+        convolver->time[i] = ir[((size_t) p * blockSize + i) * channels + c];
+      }
+      dsp_fft_forward(&convolver->fft, convolver->time, convolver->spectrum);
+      deinterleave(convolver->filters + ((size_t) c * partitions + p) * 2 * stride, convolver->spectrum, bins, stride);
+    }
+  }
+
+  return convolver;
+}
+
+void dsp_convolver_destroy(dsp_convolver* convolver) {
+  if (!convolver) return;
+  dsp_fft_destroy(&convolver->fft);
+  free(convolver->filters);
+  free(convolver->history);
+  free(convolver->input);
+  free(convolver->accumulator);
+  free(convolver->spectrum);
+  free(convolver->time);
+  free(convolver);
+}
+
+uint32_t dsp_convolver_get_channel_count(dsp_convolver* convolver) {
+  return convolver->channels;
+}
+
+void dsp_convolver_process(dsp_convolver* convolver, const float* input, float* output) {
+  uint32_t blockSize = convolver->blockSize;
+  uint32_t partitions = convolver->partitions;
+  uint32_t bins = convolver->bins;
+  uint32_t stride = convolver->stride;
+
+  // The newest input block is transformed along with the block before it, and its spectrum goes in
+  // the history ring, which acts as a frequency domain delay line
+  memmove(convolver->input, convolver->input + blockSize, blockSize * sizeof(float));
+  memcpy(convolver->input + blockSize, input, blockSize * sizeof(float));
+  dsp_fft_forward(&convolver->fft, convolver->input, convolver->spectrum);
+  deinterleave(convolver->history + (size_t) convolver->head * 2 * stride, convolver->spectrum, bins, stride);
+
+  for (uint32_t c = 0; c < convolver->channels; c++) {
+    float* re = convolver->accumulator;
+    float* im = convolver->accumulator + stride;
+    memset(convolver->accumulator, 0, 2 * stride * sizeof(float));
+
+    // Partition p of the filter meets the input from p blocks ago
+    const float* filter = convolver->filters + (size_t) c * partitions * 2 * stride;
+    for (uint32_t p = 0; p < partitions; p++) {
+      uint32_t slot = convolver->head >= p ? convolver->head - p : convolver->head + partitions - p;
+      const float* x = convolver->history + (size_t) slot * 2 * stride;
+      const float* h = filter + (size_t) p * 2 * stride;
+      mix_complex_madd(re, im, x, x + stride, h, h + stride, stride);
+    }
+
+    for (uint32_t k = 0; k < bins; k++) {
+      convolver->spectrum[2 * k + 0] = re[k];
+      convolver->spectrum[2 * k + 1] = im[k];
+    }
+
+    // Only the second half of the circular convolution is free of wraparound
+    dsp_fft_inverse(&convolver->fft, convolver->spectrum, convolver->time);
+    for (uint32_t i = 0; i < blockSize; i++) {
+      output[i * convolver->channels + c] = convolver->time[blockSize + i];
+    }
+  }
+
+  convolver->head = convolver->head + 1 == partitions ? 0 : convolver->head + 1;
+}
+
+// Biquad
+
+void dsp_biquad_design(dsp_biquad* filter, FilterType type, float frequency, float q, float gain, float sampleRate) {
+  double A = pow(10., gain / 40.);
+  double w = 2. * M_PI * CLAMP(frequency, 1.f, sampleRate * .49f) / sampleRate;
+  double cosw = cos(w);
+  double alpha = sin(w) / (2. * MAX(q, .001f));
+  double b0, b1, b2, a0, a1, a2;
+
+  switch (type) {
+    case FILTER_LOWPASS:
+      b0 = (1. - cosw) / 2., b1 = 1. - cosw, b2 = (1. - cosw) / 2.;
+      a0 = 1. + alpha, a1 = -2. * cosw, a2 = 1. - alpha;
+      break;
+    case FILTER_HIGHPASS:
+      b0 = (1. + cosw) / 2., b1 = -(1. + cosw), b2 = (1. + cosw) / 2.;
+      a0 = 1. + alpha, a1 = -2. * cosw, a2 = 1. - alpha;
+      break;
+    case FILTER_BANDPASS:
+      b0 = alpha, b1 = 0., b2 = -alpha;
+      a0 = 1. + alpha, a1 = -2. * cosw, a2 = 1. - alpha;
+      break;
+    case FILTER_NOTCH:
+      b0 = 1., b1 = -2. * cosw, b2 = 1.;
+      a0 = 1. + alpha, a1 = -2. * cosw, a2 = 1. - alpha;
+      break;
+    case FILTER_PEAK:
+      b0 = 1. + alpha * A, b1 = -2. * cosw, b2 = 1. - alpha * A;
+      a0 = 1. + alpha / A, a1 = -2. * cosw, a2 = 1. - alpha / A;
+      break;
+    case FILTER_LOWSHELF: {
+      double s = 2. * sqrt(A) * alpha;
+      b0 = A * ((A + 1.) - (A - 1.) * cosw + s);
+      b1 = 2. * A * ((A - 1.) - (A + 1.) * cosw);
+      b2 = A * ((A + 1.) - (A - 1.) * cosw - s);
+      a0 = (A + 1.) + (A - 1.) * cosw + s;
+      a1 = -2. * ((A - 1.) + (A + 1.) * cosw);
+      a2 = (A + 1.) + (A - 1.) * cosw - s;
+      break;
+    }
+    case FILTER_HIGHSHELF: {
+      double s = 2. * sqrt(A) * alpha;
+      b0 = A * ((A + 1.) + (A - 1.) * cosw + s);
+      b1 = -2. * A * ((A - 1.) + (A + 1.) * cosw);
+      b2 = A * ((A + 1.) + (A - 1.) * cosw - s);
+      a0 = (A + 1.) - (A - 1.) * cosw + s;
+      a1 = 2. * ((A - 1.) - (A + 1.) * cosw);
+      a2 = (A + 1.) - (A - 1.) * cosw - s;
+      break;
+    }
+    default:
+      b0 = 1., b1 = b2 = a1 = a2 = 0., a0 = 1.;
+      break;
+  }
+
+  filter->b0 = (float) (b0 / a0);
+  filter->b1 = (float) (b1 / a0);
+  filter->b2 = (float) (b2 / a0);
+  filter->a1 = (float) (a1 / a0);
+  filter->a2 = (float) (a2 / a0);
+}
+
+void dsp_biquad_process(dsp_biquad* filter, float* stereo, uint32_t frames) {
+  float b0 = filter->b0, b1 = filter->b1, b2 = filter->b2, a1 = filter->a1, a2 = filter->a2;
+  for (uint32_t c = 0; c < 2; c++) {
+    float z1 = filter->z[c][0];
+    float z2 = filter->z[c][1];
+    for (uint32_t i = 0; i < frames; i++) {
+      float x = stereo[2 * i + c];
+      float y = b0 * x + z1;
+      z1 = b1 * x - a1 * y + z2;
+      z2 = b2 * x - a2 * y;
+      stereo[2 * i + c] = y;
+    }
+    filter->z[c][0] = z1;
+    filter->z[c][1] = z2;
+  }
+}
+
+// Compressor
+
+void dsp_compressor_design(dsp_compressor* compressor, float threshold, float ratio, float attack, float release, float makeup, float sampleRate) {
+  compressor->threshold = threshold;
+  compressor->slope = 1.f - 1.f / MAX(ratio, 1.f);
+  compressor->attack = attack > 0.f ? expf(-1.f / (attack * sampleRate)) : 0.f;
+  compressor->release = release > 0.f ? expf(-1.f / (release * sampleRate)) : 0.f;
+  compressor->makeup = makeup;
+}
+
+// The envelope follows how far the signal is over the threshold, in decibels
+void dsp_compressor_process(dsp_compressor* compressor, float* stereo, uint32_t frames) {
+  float envelope = compressor->envelope;
+  for (uint32_t i = 0; i < frames; i++) {
+    float peak = MAX(fabsf(stereo[2 * i + 0]), fabsf(stereo[2 * i + 1]));
+    float over = 20.f * log10f(peak + 1e-9f) - compressor->threshold;
+    over = MAX(over, 0.f);
+    float coefficient = over > envelope ? compressor->attack : compressor->release;
+    envelope = over + coefficient * (envelope - over);
+    float gain = powf(10.f, (compressor->makeup - envelope * compressor->slope) / 20.f);
+    stereo[2 * i + 0] *= gain;
+    stereo[2 * i + 1] *= gain;
+  }
+  compressor->envelope = envelope;
+}
@@ -0,0 +1,59 @@
+#include "audio/audio.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#pragma once
+
+// DSP building blocks for the mixer's buses and the spatializers.  Nothing here allocates or locks
+// except the create/init functions, so the process functions are safe to call on the audio thread.
+
+// Real FFT of a power of two size (at least 4).  Spectra hold size / 2 + 1 complex bins as
+// interleaved real/imaginary pairs (size + 2 floats).  The inverse transform is scaled by 1 / size,
+// so a round trip gives back the input.  Transforms use scratch space in the dsp_fft, so one dsp_fft
+// can't be used by multiple threads at once.
+typedef struct {
+  uint32_t size;
+  uint32_t* reverse;
+  float* twiddles;
+  float* split;
+  float* work;
+} dsp_fft;
+
+bool dsp_fft_init(dsp_fft* fft, uint32_t size);
+void dsp_fft_destroy(dsp_fft* fft);
+void dsp_fft_forward(const dsp_fft* fft, const float* input, float* spectrum);
+void dsp_fft_inverse(const dsp_fft* fft, float* spectrum, float* output);
+
+// Uniformly partitioned convolution (overlap-save).  The impulse response is split into blocks of
+// blockSize frames, and each block of input is convolved with every partition in the frequency
+// domain, so the latency is one block regardless of the impulse response length.  Input is mono and
+// the output has one interleaved channel for each channel of the impulse response.
+typedef struct dsp_convolver dsp_convolver;
+
+dsp_convolver* dsp_convolver_create(uint32_t blockSize, const float* ir, uint32_t frames, uint32_t channels);
+void dsp_convolver_destroy(dsp_convolver* convolver);
+uint32_t dsp_convolver_get_channel_count(dsp_convolver* convolver);
+void dsp_convolver_process(dsp_convolver* convolver, const float* input, float* output);
+
+// Stereo biquad filter (transposed direct form II), with coefficients from the Audio EQ Cookbook.
+typedef struct {
+  float b0, b1, b2, a1, a2;
+  float z[2][2];
+} dsp_biquad;
+
+void dsp_biquad_design(dsp_biquad* filter, FilterType type, float frequency, float q, float gain, float sampleRate);
+void dsp_biquad_process(dsp_biquad* filter, float* stereo, uint32_t frames);
+
+// Stereo-linked feed-forward compressor with a peak envelope.  threshold and makeup are in
+// decibels, attack and release are in seconds.
+typedef struct {
+  float threshold;
+  float slope;
+  float attack;
+  float release;
+  float makeup;
+  float envelope;
+} dsp_compressor;
+
+void dsp_compressor_design(dsp_compressor* compressor, float threshold, float ratio, float attack, float release, float makeup, float sampleRate);
+void dsp_compressor_process(dsp_compressor* compressor, float* stereo, uint32_t frames);
@@ -0,0 +1,170 @@
+#include "audio/mix.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIX_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIX_NEON
+#endif
+
+static float clampf(float x, float min, float max) {
+  return x < min ? min : (x > max ? max : x);
+}
+
+void mix_add(float* dst, const float* src, uint32_t count, float gain) {
+  uint32_t i = 0;
+#if defined(MIX_SSE)
+  __m128 g = _mm_set1_ps(gain);
+  for (; i + 8 <= count; i += 8) {
+    __m128 a = _mm_add_ps(_mm_loadu_ps(dst + i + 0), _mm_mul_ps(_mm_loadu_ps(src + i + 0), g));
+    __m128 b = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+    _mm_storeu_ps(dst + i + 0, a);
+    _mm_storeu_ps(dst + i + 4, b);
+  }
+#elif defined(MIX_NEON)
+  for (; i + 8 <= count; i += 8) {
+    float32x4_t a = vmlaq_n_f32(vld1q_f32(dst + i + 0), vld1q_f32(src + i + 0), gain);
+    float32x4_t b = vmlaq_n_f32(vld1q_f32(dst + i + 4), vld1q_f32(src + i + 4), gain);
+    vst1q_f32(dst + i + 0, a);
+    vst1q_f32(dst + i + 4, b);
+  }
+#endif
+  for (; i < count; i++) {
+    dst[i] += src[i] * gain;
+  }
+}
+
+void mix_add_ramp(float* dst, const float* src, uint32_t frames, float from, float to) {
+  if (from == to || frames == 0) {
+    mix_add(dst, src, frames * 2, to);
+    return;
+  }
+
+  float delta = (to - from) / frames;
+  uint32_t i = 0;
+#if defined(MIX_SSE)
+  __m128 g = _mm_setr_ps(from, from, from + delta, from + delta);
+  __m128 step = _mm_set1_ps(2.f * delta);
+  for (; i + 2 <= frames; i += 2) {
+    __m128 x = _mm_add_ps(_mm_loadu_ps(dst + 2 * i), _mm_mul_ps(_mm_loadu_ps(src + 2 * i), g));
+    _mm_storeu_ps(dst + 2 * i, x);
+    g = _mm_add_ps(g, step);
+  }
+#elif defined(MIX_NEON)
+  float32x4_t g = vld1q_f32((float[4]) { from, from, from + delta, from + delta });
+  float32x4_t step = vdupq_n_f32(2.f * delta);
+  for (; i + 2 <= frames; i += 2) {
+    vst1q_f32(dst + 2 * i, vmlaq_f32(vld1q_f32(dst + 2 * i), vld1q_f32(src + 2 * i), g));
+    g = vaddq_f32(g, step);
+  }
+#endif
+  for (; i < frames; i++) {
+    float gain = from + delta * i;
+    dst[2 * i + 0] += src[2 * i + 0] * gain;
+    dst[2 * i + 1] += src[2 * i + 1] * gain;
+  }
+}
+
+// The gain of a channel at frame i is its starting gain plus rate * i in the direction of the
+// target, clamped to the range between the two.  Computing it from i instead of accumulating it
+// means the vector and scalar paths agree.
+void mix_pan(float* dst, const float* src, uint32_t frames, float gain[2], const float target[2], float rate) {
+  float step[2], lo[2], hi[2];
+  for (uint32_t c = 0; c < 2; c++) {
+    step[c] = target[c] > gain[c] ? rate : -rate;
+    lo[c] = gain[c] < target[c] ? gain[c] : target[c];
+    hi[c] = gain[c] < target[c] ? target[c] : gain[c];
+  }
+
+  uint32_t i = 0;
+#if defined(MIX_SSE)
+  __m128 base = _mm_setr_ps(gain[0], gain[1], gain[0], gain[1]);
+  __m128 slope = _mm_setr_ps(step[0], step[1], step[0], step[1]);
+  __m128 min = _mm_setr_ps(lo[0], lo[1], lo[0], lo[1]);
+  __m128 max = _mm_setr_ps(hi[0], hi[1], hi[0], hi[1]);
+  __m128 index = _mm_setr_ps(0.f, 0.f, 1.f, 1.f);
+  __m128 two = _mm_set1_ps(2.f);
+  for (; i + 4 <= frames; i += 4) {
+    __m128 x = _mm_loadu_ps(src + i);
+    __m128 g0 = _mm_min_ps(_mm_max_ps(_mm_add_ps(base, _mm_mul_ps(slope, index)), min), max);
+    index = _mm_add_ps(index, two);
+    __m128 g1 = _mm_min_ps(_mm_max_ps(_mm_add_ps(base, _mm_mul_ps(slope, index)), min), max);
+    index = _mm_add_ps(index, two);
+    _mm_storeu_ps(dst + 2 * i + 0, _mm_mul_ps(_mm_unpacklo_ps(x, x), g0));
+    _mm_storeu_ps(dst + 2 * i + 4, _mm_mul_ps(_mm_unpackhi_ps(x, x), g1));
+  }
+#elif defined(MIX_NEON)
+  float32x4_t base = vld1q_f32((float[4]) { gain[0], gain[1], gain[0], gain[1] });
+  float32x4_t slope = vld1q_f32((float[4]) { step[0], step[1], step[0], step[1] });
+  float32x4_t min = vld1q_f32((float[4]) { lo[0], lo[1], lo[0], lo[1] });
+  float32x4_t max = vld1q_f32((float[4]) { hi[0], hi[1], hi[0], hi[1] });
+  float32x4_t index = vld1q_f32((float[4]) { 0.f, 0.f, 1.f, 1.f });
+  float32x4_t two = vdupq_n_f32(2.f);
+  for (; i + 4 <= frames; i += 4) {
+    float32x4x2_t x = vzipq_f32(vld1q_f32(src + i), vld1q_f32(src + i));
+    float32x4_t g0 = vminq_f32(vmaxq_f32(vmlaq_f32(base, slope, index), min), max);
+    index = vaddq_f32(index, two);
+    float32x4_t g1 = vminq_f32(vmaxq_f32(vmlaq_f32(base, slope, index), min), max);
+    index = vaddq_f32(index, two);
+    vst1q_f32(dst + 2 * i + 0, vmulq_f32(x.val[0], g0));
+    vst1q_f32(dst + 2 * i + 4, vmulq_f32(x.val[1], g1));
+  }
+#endif
+  for (; i < frames; i++) {
+    dst[2 * i + 0] = src[i] * clampf(gain[0] + step[0] * i, lo[0], hi[0]);
+    dst[2 * i + 1] = src[i] * clampf(gain[1] + step[1] * i, lo[1], hi[1]);
+  }
+
+  gain[0] = clampf(gain[0] + step[0] * frames, lo[0], hi[0]);
+  gain[1] = clampf(gain[1] + step[1] * frames, lo[1], hi[1]);
+}
+
+void mix_complex_madd(float* re, float* im, const float* ar, const float* ai, const float* br, const float* bi, uint32_t count) {
+  uint32_t i = 0;
+#if defined(MIX_SSE)
+  for (; i + 4 <= count; i += 4) {
+    __m128 xr = _mm_loadu_ps(ar + i), xi = _mm_loadu_ps(ai + i);
+    __m128 yr = _mm_loadu_ps(br + i), yi = _mm_loadu_ps(bi + i);
+    __m128 r = _mm_sub_ps(_mm_mul_ps(xr, yr), _mm_mul_ps(xi, yi));
+    __m128 j = _mm_add_ps(_mm_mul_ps(xr, yi), _mm_mul_ps(xi, yr));
+    _mm_storeu_ps(re + i, _mm_add_ps(_mm_loadu_ps(re + i), r));
+    _mm_storeu_ps(im + i, _mm_add_ps(_mm_loadu_ps(im + i), j));
+  }
+#elif defined(MIX_NEON)
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t xr = vld1q_f32(ar + i), xi = vld1q_f32(ai + i);
+    float32x4_t yr = vld1q_f32(br + i), yi = vld1q_f32(bi + i);
+    vst1q_f32(re + i, vmlsq_f32(vmlaq_f32(vld1q_f32(re + i), xr, yr), xi, yi));
+    vst1q_f32(im + i, vmlaq_f32(vmlaq_f32(vld1q_f32(im + i), xr, yi), xi, yr));
+  }
+#endif
+  for (; i < count; i++) {
+    re[i] += ar[i] * br[i] - ai[i] * bi[i];
+    im[i] += ar[i] * bi[i] + ai[i] * br[i];
+  }
+}
+
+void mix_convert_i16(float* dst, const int16_t* src, uint32_t count) {
+  const float scale = 1.f / 32768.f;
+  uint32_t i = 0;
+#if defined(MIX_SSE)
+  __m128 s = _mm_set1_ps(scale);
+  for (; i + 8 <= count; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*) (src + i));
+    __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+    __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+    _mm_storeu_ps(dst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(a), s));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), s));
+  }
+#elif defined(MIX_NEON)
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t x = vld1q_s16(src + i);
+    vst1q_f32(dst + i + 0, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+    vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+  }
+#endif
+  for (; i < count; i++) {
+    dst[i] = src[i] * scale;
+  }
+}
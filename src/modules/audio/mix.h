@@ -0,0 +1,23 @@
+#include <stdint.h>
+
+#pragma once
+
+// Mixing kernels used by the audio callback and the spatializers.  Buffers hold float samples,
+// and stereo buffers are interleaved.  There are SSE2 and NEON versions, with a scalar fallback for
+// other targets and for leftover samples.  Buffers don't need to be aligned.
+
+// Adds src to dst, scaled by gain.
+void mix_add(float* dst, const float* src, uint32_t count, float gain);
+
+// Adds stereo frames from src to dst, with the gain moving linearly from `from` to `to`.
+void mix_add_ramp(float* dst, const float* src, uint32_t frames, float from, float to);
+
+// Writes mono src to stereo dst, with each channel's gain moving towards its target by rate per
+// frame (and stopping once it gets there).  gain is updated with the gains after the last frame.
+void mix_pan(float* dst, const float* src, uint32_t frames, float gain[2], const float target[2], float rate);
+
+// Complex multiply-accumulate on planar spectra: (re + i im) += (ar + i ai) * (br + i bi).
+void mix_complex_madd(float* re, float* im, const float* ar, const float* ai, const float* br, const float* bi, uint32_t count);
+
+// Converts 16 bit samples to floats in [-1, 1).
+void mix_convert_i16(float* dst, const int16_t* src, uint32_t count);
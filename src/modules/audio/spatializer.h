@@ -1,8 +1,14 @@
 #include "audio.h"
+#include "dsp.h"
 
 // Private Source functions for spatializer use
 intptr_t* lovrSourceGetSpatializerMemoField(Source* source);
 uint32_t lovrSourceGetIndex(Source* source);
+void lovrSourceGetRenderPose(Source* source, float position[4], float orientation[4]);
+float lovrSourceGetRenderVolume(Source* source);
+float lovrSourceGetRenderRadius(Source* source);
+void lovrSourceGetRenderDirectivity(Source* source, float* weight, float* power);
+bool lovrSourceIsRenderEffectEnabled(Source* source, Effect effect);
 
 typedef struct {
   bool (*init)(void);
@@ -17,6 +23,15 @@ typedef struct {
   uint32_t (*tail)(float* scratch, float* output, uint32_t frames);
   void (*setListenerPose)(float position[4], float orientation[4]);
   bool (*setGeometry)(float* vertices, uint32_t* indices, uint32_t vertexCount, uint32_t indexCount, AudioMaterial material);
+  // optional, takes ownership of a reverb (or NULL to remove it) and returns the previous one.
+  // Sources with the reverb effect are sent to it with the given gain and it's mixed in the tail.
+  dsp_convolver* (*setReverb)(dsp_convolver* convolver, float gain);
+  // optional, replaces the set of head related impulse responses.  hrirs has length interleaved
+  // stereo frames for each direction, and directions are unit vectors in the listener's space.
+  bool (*setHRTF)(const float* hrirs, const float* directions, uint32_t count, uint32_t length);
+  // sourceCreate is called on the creating thread when a Source is created, with the audio lock held.
+  // sourceDestroy is called by the audio callback when a Source stops being rendered and gives up
+  // its index, so anything kept per index can be reset for the next Source that uses it.
   void (*sourceCreate)(Source* source);
   void (*sourceDestroy)(Source* source);
   const char* name;
@@ -29,3 +44,6 @@ extern Spatializer phononSpatializer;
 extern Spatializer oculusSpatializer;
 #endif
 extern Spatializer simpleSpatializer;
+#ifdef LOVR_ENABLE_HRTF_SPATIALIZER
+extern Spatializer hrtfSpatializer;
+#endif
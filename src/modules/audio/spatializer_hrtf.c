@@ -0,0 +1,367 @@
+#include "spatializer.h"
+#include "mix.h"
+#include "core/maf.h"
+#include "util.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Binaural spatializer that convolves each Source with a head related impulse response (HRIR) for
+// each ear.  HRIRs are at most BUFFER_SIZE frames, so a single overlap-save partition of twice the
+// buffer size is enough and the convolution adds no latency.  The spectra of all the HRIRs are
+// computed up front, and the filter for a direction is blended from the spectra of the 3 closest
+// measured directions (the transform is linear, so this is the same as blending the HRIRs).  When
+// a Source moves, the outputs of the old and new filters are crossfaded over a buffer.
+//
+// Until a set is loaded with lovrAudioSetHRTF, the HRIRs come from a spherical head model (Brown
+// and Duda, "A Structural Model for Binaural Sound Synthesis"), which has the interaural time and
+// level differences of a real head but no pinna or elevation cues.
+
+#define BINS (BUFFER_SIZE + 1)
+#define STRIDE ((BINS + 3) & ~3)
+#define MODEL_LENGTH 128
+#define HEAD_RADIUS .0875f
+#define SPEED_OF_SOUND 343.f
+
+typedef struct {
+  float input[2 * BUFFER_SIZE];
+  float filters[2][2][2 * STRIDE];
+  float direction[4];
+  float gain;
+  uint32_t slot;
+  bool valid;
+} hrtf_source;
+
+static struct {
+  float position[4];
+  float orientation[4];
+  float* spectra;
+  float* directions;
+  uint32_t count;
+  dsp_fft fft;
+  float spectrum[2 * BINS];
+  float planar[2 * STRIDE];
+  float accumulator[2 * STRIDE];
+  float time[2 * BUFFER_SIZE];
+  float ears[2][2][BUFFER_SIZE];
+  hrtf_source sources[MAX_SOURCES];
+} state;
+
+// Stores the real FFT of a zero padded signal as planar spectra
+static void transform(const float* signal, float* planar) {
+  dsp_fft_forward(&state.fft, signal, state.spectrum);
+  for (uint32_t k = 0; k < BINS; k++) {
+    planar[k] = state.spectrum[2 * k + 0];
+    planar[STRIDE + k] = state.spectrum[2 * k + 1];
+  }
+}
+
+// Filters the input in state.planar, keeping the part of the circular convolution without wraparound
+static void convolve(const float* filter, float* output) {
+  float* re = state.accumulator;
+  float* im = state.accumulator + STRIDE;
+  memset(state.accumulator, 0, sizeof(state.accumulator));
+  mix_complex_madd(re, im, state.planar, state.planar + STRIDE, filter, filter + STRIDE, STRIDE);
+
+  for (uint32_t k = 0; k < BINS; k++) {
+    state.spectrum[2 * k + 0] = re[k];
+    state.spectrum[2 * k + 1] = im[k];
+  }
+
+  dsp_fft_inverse(&state.fft, state.spectrum, state.time);
+  memcpy(output, state.time + BUFFER_SIZE, BUFFER_SIZE * sizeof(float));
+}
+
+// Blends the spectra of the closest directions, weighted by inverse distance
+static void design(float direction[4], float filters[2][2 * STRIDE]) {
+  uint32_t nearest[3] = { 0, 0, 0 };
+  float dots[3] = { -2.f, -2.f, -2.f };
+  uint32_t n = MIN(state.count, 3);
+
+  for (uint32_t i = 0; i < state.count; i++) {
+    float dot = vec3_dot(direction, state.directions + 3 * i);
+    for (uint32_t j = 0; j < n; j++) {
+      if (dot > dots[j]) {
+        for (uint32_t k = n - 1; k > j; k--) {
+          dots[k] = dots[k - 1];
+          nearest[k] = nearest[k - 1];
+        }
+        dots[j] = dot;
+        nearest[j] = i;
+        break;
+      }
+    }
+  }
+
+  float weights[3] = { 0.f };
+  float total = 0.f;
+  for (uint32_t j = 0; j < n; j++) {
+    float distance = sqrtf(MAX(2.f - 2.f * dots[j], 0.f));
+    if (distance < 1e-4f) {
+      memset(weights, 0, sizeof(weights));
+      weights[j] = total = 1.f;
+      break;
+    }
+    weights[j] = 1.f / distance;
+    total += weights[j];
+  }
+
+  for (uint32_t ear = 0; ear < 2; ear++) {
+    memset(filters[ear], 0, 2 * STRIDE * sizeof(float));
+    for (uint32_t j = 0; j < n; j++) {
+      if (weights[j] == 0.f) continue;
+      const float* spectrum = state.spectra + ((size_t) nearest[j] * 2 + ear) * 2 * STRIDE;
+      mix_add(filters[ear], spectrum, 2 * STRIDE, weights[j] / total);
+    }
+  }
+}
+
+// Replaces the HRIR set, transforming each ear's impulse response.  Impulse responses longer than
+// BUFFER_SIZE frames are truncated.
+static bool hrtf_setHRTF(const float* hrirs, const float* directions, uint32_t count, uint32_t length) {
+  uint32_t clamped = MIN(length, BUFFER_SIZE);
+  float* newSpectra = malloc((size_t) count * 2 * 2 * STRIDE * sizeof(float));
+  float* newDirections = malloc((size_t) count * 3 * sizeof(float));
+
+  if (!newSpectra || !newDirections) {
+    free(newSpectra);
+    free(newDirections);
+    return false;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    for (uint32_t ear = 0; ear < 2; ear++) {
+      float* spectrum = newSpectra + ((size_t) i * 2 + ear) * 2 * STRIDE;
+      memset(state.time, 0, sizeof(state.time));
+      for (uint32_t j = 0; j < clamped; j++) {
+        state.time[j] = hrirs[((size_t) i * length + j) * 2 + ear];
+      }
+      memset(spectrum, 0, 2 * STRIDE * sizeof(float));
+      transform(state.time, spectrum);
+    }
+    float direction[4] = { directions[3 * i + 0], directions[3 * i + 1], directions[3 * i + 2] };
+    vec3_normalize(direction);
+    memcpy(newDirections + 3 * i, direction, 3 * sizeof(float));
+  }
+
+  free(state.spectra);
+  free(state.directions);
+  state.spectra = newSpectra;
+  state.directions = newDirections;
+  state.count = count;
+
+  for (uint32_t i = 0; i < MAX_SOURCES; i++) {
+    state.sources[i].valid = false;
+  }
+
+  return true;
+}
+
+// Each ear's delay follows Woodworth's formula for a spherical head, and a one-pole one-zero head
+// shadow filter boosts highs on the near side and cuts them on the far side.
+static bool generateModel(float sampleRate) {
+  uint32_t elevations = 13;
+  uint32_t azimuths = 36;
+  uint32_t count = elevations * azimuths + 1;
+  float* hrirs = calloc((size_t) count * MODEL_LENGTH * 2, sizeof(float));
+  float* directions = malloc((size_t) count * 3 * sizeof(float));
+
+  if (!hrirs || !directions) {
+    free(hrirs);
+    free(directions);
+    return false;
+  }
+
+  float w0 = SPEED_OF_SOUND / HEAD_RADIUS;
+  float K = sampleRate / w0;
+  float a1 = (1.f - K) / (1.f + K);
+
+  for (uint32_t i = 0; i < count; i++) {
+    float* direction = directions + 3 * i;
+
+    if (i == count - 1) {
+      vec3_set(direction, 0.f, 1.f, 0.f);
+    } else {
+      float elevation = (-40.f + 10.f * (i / azimuths)) * (float) M_PI / 180.f;
+      float azimuth = (10.f * (i % azimuths)) * (float) M_PI / 180.f;
+      vec3_set(direction, -sinf(azimuth) * cosf(elevation), sinf(elevation), -cosf(azimuth) * cosf(elevation));
+    }
+
+    for (uint32_t ear = 0; ear < 2; ear++) {
+      float* hrir = hrirs + (size_t) i * MODEL_LENGTH * 2;
+      float side = ear == 0 ? -1.f : 1.f;
+      float theta = acosf(CLAMP(direction[0] * side, -1.f, 1.f));
+
+      float delay = HEAD_RADIUS / SPEED_OF_SOUND;
+      if (theta < (float) M_PI / 2.f) {
+        delay -= HEAD_RADIUS / SPEED_OF_SOUND * cosf(theta);
+      } else {
+        delay += HEAD_RADIUS / SPEED_OF_SOUND * (theta - (float) M_PI / 2.f);
+      }
+
+      float alpha = 1.05f + .95f * cosf(theta * 180.f / 150.f);
+      float b0 = (1.f + alpha * K) / (1.f + K);
+      float b1 = (1.f - alpha * K) / (1.f + K);
+
+      // Fractional delay with linear interpolation, then the shadow filter
+      float samples = delay * sampleRate;
+      uint32_t start = (uint32_t) samples;
+      float fraction = samples - start;
+      float x1 = 0.f, y1 = 0.f;
+      for (uint32_t j = 0; j < MODEL_LENGTH; j++) {
+        float x = j == start ? 1.f - fraction : (j == start + 1 ? fraction : 0.f);
+        float y = b0 * x + b1 * x1 - a1 * y1;
+        hrir[j * 2 + ear] = y;
+        x1 = x;
+        y1 = y;
+      }
+    }
+  }
+
+  bool success = hrtf_setHRTF(hrirs, directions, count, MODEL_LENGTH);
+  free(hrirs);
+  free(directions);
+  return success;
+}
+
+static bool hrtf_init(void) {
+  if (!dsp_fft_init(&state.fft, 2 * BUFFER_SIZE)) {
+    return false;
+  }
+
+  if (!generateModel(lovrAudioGetSampleRate())) {
+    dsp_fft_destroy(&state.fft);
+    return false;
+  }
+
+  vec3_set(state.position, 0.f, 0.f, 0.f);
+  quat_identity(state.orientation);
+  return true;
+}
+
+static void hrtf_destroy(void) {
+  dsp_fft_destroy(&state.fft);
+  free(state.spectra);
+  free(state.directions);
+  memset(&state, 0, sizeof(state));
+}
+
+static uint32_t hrtf_apply(Source* source, const float* input, float* output, uint32_t frames, uint32_t _frames) {
+  hrtf_source* s = &state.sources[lovrSourceGetIndex(source)];
+
+  memcpy(s->input, s->input + BUFFER_SIZE, BUFFER_SIZE * sizeof(float));
+  memcpy(s->input + BUFFER_SIZE, input, BUFFER_SIZE * sizeof(float));
+  transform(s->input, state.planar);
+
+  float sourcePos[4], sourceOrientation[4];
+  lovrSourceGetRenderPose(source, sourcePos, sourceOrientation);
+
+  // Direction to the Source in the listener's space
+  float inverse[4], local[4];
+  quat_conjugate(quat_init(inverse, state.orientation));
+  vec3_sub(vec3_init(local, sourcePos), state.position);
+  float distance = vec3_length(local);
+  quat_rotate(inverse, local);
+
+  float direction[4] = { 0.f, 0.f, -1.f };
+  if (lovrSourceIsRenderEffectEnabled(source, EFFECT_SPATIALIZATION) && distance > 1e-3f) {
+    vec3_scale(vec3_init(direction, local), 1.f / distance);
+  }
+
+  float target = 1.f;
+
+  float weight, power;
+  lovrSourceGetRenderDirectivity(source, &weight, &power);
+  if (weight > 0.f && power > 0.f && distance > 1e-3f) {
+    float sourceDirection[4];
+    float sourceToListener[4];
+    quat_getDirection(sourceOrientation, sourceDirection);
+    vec3_scale(vec3_sub(vec3_init(sourceToListener, state.position), sourcePos), 1.f / distance);
+    float dot = vec3_dot(sourceToListener, sourceDirection);
+    target *= powf(fabsf(1.f - weight + weight * dot), power);
+  }
+
+  if (lovrSourceIsRenderEffectEnabled(source, EFFECT_ATTENUATION)) {
+    target *= 1.f / MAX(distance, 1.f);
+  }
+
+  // Redesign when the direction moves more than about a degree
+  bool fade = false;
+  if (!s->valid || vec3_dot(direction, s->direction) < .99985f) {
+    uint32_t next = s->valid ? !s->slot : s->slot;
+    design(direction, s->filters[next]);
+    vec3_init(s->direction, direction);
+    fade = s->valid;
+    s->valid = true;
+    s->slot = next;
+  }
+
+  for (uint32_t ear = 0; ear < 2; ear++) {
+    convolve(s->filters[s->slot][ear], state.ears[0][ear]);
+    if (fade) {
+      convolve(s->filters[!s->slot][ear], state.ears[1][ear]);
+    }
+  }
+
+  float from = s->gain;
+  float step = (target - from) / BUFFER_SIZE;
+  float* left = state.ears[0][0];
+  float* right = state.ears[0][1];
+
+  if (fade) {
+    const float* oldLeft = state.ears[1][0];
+    const float* oldRight = state.ears[1][1];
+    for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
+      float t = (i + 1) / (float) BUFFER_SIZE;
+      left[i] = oldLeft[i] + (left[i] - oldLeft[i]) * t;
+      right[i] = oldRight[i] + (right[i] - oldRight[i]) * t;
+    }
+  }
+
+  for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
+    float gain = from + step * (i + 1);
+    output[2 * i + 0] = left[i] * gain;
+    output[2 * i + 1] = right[i] * gain;
+  }
+
+  s->gain = target;
+  return frames;
+}
+
+static uint32_t hrtf_tail(float* scratch, float* output, uint32_t frames) {
+  return 0;
+}
+
+static void hrtf_setListenerPose(float position[4], float orientation[4]) {
+  vec3_init(state.position, position);
+  quat_init(state.orientation, orientation);
+}
+
+static bool hrtf_setGeometry(float* vertices, uint32_t* indices, uint32_t vertexCount, uint32_t indexCount, AudioMaterial material) {
+  return false;
+}
+
+static void hrtf_sourceCreate(Source* source) {
+  //
+}
+
+static void hrtf_sourceDestroy(Source* source) {
+  hrtf_source* s = &state.sources[lovrSourceGetIndex(source)];
+  memset(s->input, 0, sizeof(s->input));
+  s->gain = 0.f;
+  s->slot = 0;
+  s->valid = false;
+}
+
+Spatializer hrtfSpatializer = {
+  .init = hrtf_init,
+  .destroy = hrtf_destroy,
+  .apply = hrtf_apply,
+  .tail = hrtf_tail,
+  .setListenerPose = hrtf_setListenerPose,
+  .setGeometry = hrtf_setGeometry,
+  .setHRTF = hrtf_setHRTF,
+  .sourceCreate = hrtf_sourceCreate,
+  .sourceDestroy = hrtf_sourceDestroy,
+  .name = "hrtf"
+};
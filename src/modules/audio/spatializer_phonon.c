@@ -203,7 +203,7 @@ uint32_t phonon_apply(Source* source, const float* input, float* output, uint32_
 
   // TODO maybe this should use a matrix
   float position[4], orientation[4];
-  lovrSourceGetPose(source, position, orientation);
+  lovrSourceGetRenderPose(source, position, orientation);
   vec3_set(x, 1.f, 0.f, 0.f);
   vec3_set(y, 0.f, 1.f, 0.f);
   vec3_set(z, 0.f, 0.f, -1.f);
@@ -212,7 +212,7 @@ uint32_t phonon_apply(Source* source, const float* input, float* output, uint32_
   quat_rotate(orientation, z);
 
   float weight, power;
-  lovrSourceGetDirectivity(source, &weight, &power);
+  lovrSourceGetRenderDirectivity(source, &weight, &power);
 
   IPLSource iplSource = {
     .position = (IPLVector3) { position[0], position[1], position[2] },
@@ -231,10 +231,10 @@ uint32_t phonon_apply(Source* source, const float* input, float* output, uint32_
   float radius = 0.f;
   IPLint32 rays = 0;
 
-  if (state.mesh && lovrSourceIsEffectEnabled(source, EFFECT_OCCLUSION)) {
-    bool transmission = lovrSourceIsEffectEnabled(source, EFFECT_TRANSMISSION);
+  if (state.mesh && lovrSourceIsRenderEffectEnabled(source, EFFECT_OCCLUSION)) {
+    bool transmission = lovrSourceIsRenderEffectEnabled(source, EFFECT_TRANSMISSION);
     occlusion = transmission ? IPL_DIRECTOCCLUSION_TRANSMISSIONBYFREQUENCY : IPL_DIRECTOCCLUSION_NOTRANSMISSION;
-    radius = lovrSourceGetRadius(source);
+    radius = lovrSourceGetRenderRadius(source);
 
     if (radius > 0.f) {
       volumetric = IPL_DIRECTOCCLUSION_VOLUMETRIC;
@@ -245,8 +245,8 @@ uint32_t phonon_apply(Source* source, const float* input, float* output, uint32_
   IPLDirectSoundPath path = phonon_iplGetDirectSoundPath(state.environment, listener, forward, up, iplSource, radius, rays, occlusion, volumetric);
 
   IPLDirectSoundEffectOptions options = {
-    .applyDistanceAttenuation = lovrSourceIsEffectEnabled(source, EFFECT_ATTENUATION) ? IPL_TRUE : IPL_FALSE,
-    .applyAirAbsorption = lovrSourceIsEffectEnabled(source, EFFECT_ABSORPTION) ? IPL_TRUE : IPL_FALSE,
+    .applyDistanceAttenuation = lovrSourceIsRenderEffectEnabled(source, EFFECT_ATTENUATION) ? IPL_TRUE : IPL_FALSE,
+    .applyAirAbsorption = lovrSourceIsRenderEffectEnabled(source, EFFECT_ABSORPTION) ? IPL_TRUE : IPL_FALSE,
     .applyDirectivity = weight > 0.f && power > 0.f ? IPL_TRUE : IPL_FALSE,
     .directOcclusionMode = occlusion
   };
@@ -257,7 +257,7 @@ uint32_t phonon_apply(Source* source, const float* input, float* output, uint32_
   IPLHrtfInterpolation interpolation = IPL_HRTFINTERPOLATION_NEAREST;
   phonon_iplApplyBinauralEffect(state.binauralEffect[index], state.binauralRenderer, tmp, path.direction, interpolation, blend, out);
 
-  if (state.mesh && lovrSourceIsEffectEnabled(source, EFFECT_REVERB)) {
+  if (state.mesh && lovrSourceIsRenderEffectEnabled(source, EFFECT_REVERB)) {
     phonon_iplSetDryAudioForConvolutionEffect(state.convolutionEffect[index], iplSource, in);
   }
 
@@ -370,8 +370,17 @@ fail:
   return false;
 }
 
+// Sources don't have an index until they're rendered, and creating effects isn't safe to do in the
+// audio callback, so each new Source makes sure there are effects for one more index instead.
 void phonon_sourceCreate(Source* source) {
-  uint32_t index = lovrSourceGetIndex(source);
+  uint32_t index = 0;
+  while (index < MAX_SOURCES && state.binauralEffect[index] && state.directSoundEffect[index] && state.convolutionEffect[index]) {
+    index++;
+  }
+
+  if (index == MAX_SOURCES) {
+    return;
+  }
 
   if (!state.binauralEffect[index]) {
     phonon_iplCreateBinauralEffect(state.binauralRenderer, MONO, STEREO, &state.binauralEffect[index]);
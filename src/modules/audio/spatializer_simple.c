@@ -1,11 +1,16 @@
 #include "spatializer.h"
+#include "mix.h"
 #include "core/maf.h"
 #include "util.h"
 #include <math.h>
+#include <string.h>
 
 static struct {
   float listener[16];
   float gain[MAX_SOURCES][2];
+  dsp_convolver* reverb;
+  float reverbGain;
+  float send[BUFFER_SIZE];
 } state;
 
 static bool simple_init(void) {
@@ -14,18 +19,19 @@ static bool simple_init(void) {
 }
 
 static void simple_destroy(void) {
-  //
+  dsp_convolver_destroy(state.reverb);
+  state.reverb = NULL;
 }
 
 static uint32_t simple_apply(Source* source, const float* input, float* output, uint32_t frames, uint32_t _frames) {
   float sourcePos[4], sourceOrientation[4];
-  lovrSourceGetPose(source, sourcePos, sourceOrientation);
+  lovrSourceGetRenderPose(source, sourcePos, sourceOrientation);
 
   float listenerPos[4] = { 0.f };
   mat4_transform(state.listener, listenerPos);
 
   float target[2] = { 1.f, 1.f };
-  if (lovrSourceIsEffectEnabled(source, EFFECT_SPATIALIZATION)) {
+  if (lovrSourceIsRenderEffectEnabled(source, EFFECT_SPATIALIZATION)) {
     float leftEar[4] = { -0.1f, 0.0f, 0.0f, 1.0f };
     float rightEar[4] = { 0.1f, 0.0f, 0.0f, 1.0f };
     mat4_transform(state.listener, leftEar);
@@ -37,7 +43,7 @@ static uint32_t simple_apply(Source* source, const float* input, float* output,
   }
 
   float weight, power;
-  lovrSourceGetDirectivity(source, &weight, &power);
+  lovrSourceGetRenderDirectivity(source, &weight, &power);
   if (weight > 0.f && power > 0.f) {
     float sourceDirection[4];
     float sourceToListener[4];
@@ -49,7 +55,7 @@ static uint32_t simple_apply(Source* source, const float* input, float* output,
     target[1] *= factor;
   }
 
-  if (lovrSourceIsEffectEnabled(source, EFFECT_ATTENUATION)) {
+  if (lovrSourceIsRenderEffectEnabled(source, EFFECT_ATTENUATION)) {
     float distance = vec3_distance(sourcePos, listenerPos);
     float attenuation = 1.f / MAX(distance, 1.f);
     target[0] *= attenuation;
@@ -63,27 +69,31 @@ static uint32_t simple_apply(Source* source, const float* input, float* output,
   float lerpFrames = lovrAudioGetSampleRate() * lerpDuration;
   float lerpRate = 1.f / lerpFrames;
 
-  for (uint32_t c = 0; c < 2; c++) {
-    float sign = target[c] > gain[c] ? 1.f : -1.f;
-
-    uint32_t lerpCount = fabsf(target[c] - gain[c]) / lerpRate;
-    lerpCount = MIN(lerpCount, frames);
-
-    for (uint32_t i = 0; i < lerpCount; i++) {
-      output[i * 2 + c] = input[i] * gain[c];
-      gain[c] += lerpRate * sign;
-    }
+  mix_pan(output, input, frames, gain, target, lerpRate);
 
-    for (uint32_t i = lerpCount; i < frames; i++) {
-      output[i * 2 + c] = input[i] * gain[c];
-    }
+  if (state.reverb && lovrSourceIsRenderEffectEnabled(source, EFFECT_REVERB)) {
+    mix_add(state.send, input, frames, lovrSourceGetRenderVolume(source) * state.reverbGain);
   }
 
   return frames;
 }
 
+// The reverb keeps running when nothing is sent to it, so it rings out after Sources stop
 static uint32_t simple_tail(float* scratch, float* output, uint32_t frames) {
-  return 0;
+  if (!state.reverb) {
+    return 0;
+  }
+
+  if (dsp_convolver_get_channel_count(state.reverb) == 2) {
+    dsp_convolver_process(state.reverb, state.send, output);
+  } else {
+    float gain[2] = { 1.f, 1.f };
+    dsp_convolver_process(state.reverb, state.send, scratch);
+    mix_pan(output, scratch, frames, gain, gain, 0.f);
+  }
+
+  memset(state.send, 0, sizeof(state.send));
+  return frames;
 }
 
 static void simple_setListenerPose(float position[4], float orientation[4]) {
@@ -96,14 +106,24 @@ static bool simple_setGeometry(float* vertices, uint32_t* indices, uint32_t vert
   return false;
 }
 
+static dsp_convolver* simple_setReverb(dsp_convolver* convolver, float gain) {
+  dsp_convolver* previous = state.reverb;
+  if (convolver != previous) {
+    memset(state.send, 0, sizeof(state.send));
+  }
+  state.reverb = convolver;
+  state.reverbGain = gain;
+  return previous;
+}
+
 static void simple_sourceCreate(Source* source) {
-  uint32_t index = lovrSourceGetIndex(source);
-  state.gain[index][0] = 0.f;
-  state.gain[index][1] = 0.f;
+  //
 }
 
 static void simple_sourceDestroy(Source* source) {
-  //
+  uint32_t index = lovrSourceGetIndex(source);
+  state.gain[index][0] = 0.f;
+  state.gain[index][1] = 0.f;
 }
 
 Spatializer simpleSpatializer = {
@@ -113,6 +133,7 @@ Spatializer simpleSpatializer = {
   .tail = simple_tail,
   .setListenerPose = simple_setListenerPose,
   .setGeometry = simple_setGeometry,
+  .setReverb = simple_setReverb,
   .sourceCreate = simple_sourceCreate,
   .sourceDestroy = simple_sourceDestroy,
   .name = "simple"
@@ -1,4 +1,5 @@
 #include "data/blob.h"
+#include "core/fs.h"
 #include "util.h"
 #include <stdlib.h>
 
@@ -14,6 +15,10 @@ Blob* lovrBlobCreate(void* data, size_t size, const char* name) {
 
 void lovrBlobDestroy(void* ref) {
   Blob* blob = ref;
-  free(blob->data);
+  if (blob->mapped) {
+    fs_unmap(blob->data, blob->size);
+  } else {
+    free(blob->data);
+  }
   free(blob);
 }
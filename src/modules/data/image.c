@@ -79,6 +79,54 @@ static size_t measure(uint32_t w, uint32_t h, TextureFormat format) {
   }
 }
 
+// KTX1 stores formats as OpenGL enums
+static const struct { uint32_t type, format, internalFormat, srgbInternalFormat; } ktxFormats[] = {
+  [FORMAT_R8]         = { 0x1401, 0x1903, 0x8229, 0 },
+  [FORMAT_RG8]        = { 0x1401, 0x8227, 0x822B, 0 },
+  [FORMAT_RGBA8]      = { 0x1401, 0x1908, 0x8058, 0x8C43 },
+  [FORMAT_R16]        = { 0x1403, 0x1903, 0x822A, 0 },
+  [FORMAT_RG16]       = { 0x1403, 0x8227, 0x822C, 0 },
+  [FORMAT_RGBA16]     = { 0x1403, 0x1908, 0x805B, 0 },
+  [FORMAT_R16F]       = { 0x140B, 0x1903, 0x822D, 0 },
+  [FORMAT_RG16F]      = { 0x140B, 0x8227, 0x822F, 0 },
+  [FORMAT_RGBA16F]    = { 0x140B, 0x1908, 0x881A, 0 },
+  [FORMAT_R32F]       = { 0x1406, 0x1903, 0x822E, 0 },
+  [FORMAT_RG32F]      = { 0x1406, 0x8227, 0x8230, 0 },
+  [FORMAT_RGBA32F]    = { 0x1406, 0x1908, 0x8814, 0 },
+  [FORMAT_RGB565]     = { 0x8363, 0x1907, 0x8D62, 0 },
+  [FORMAT_RGB5A1]     = { 0x8034, 0x1908, 0x8057, 0 },
+  [FORMAT_RGB10A2]    = { 0x8368, 0x1908, 0x8059, 0 },
+  [FORMAT_RG11B10F]   = { 0x8C3A, 0x1907, 0x8C3A, 0 },
+  [FORMAT_D16]        = { 0x1403, 0x1902, 0x81A5, 0 },
+  [FORMAT_D32F]       = { 0x1406, 0x1902, 0x8CAC, 0 },
+  [FORMAT_D24S8]      = { 0x84FA, 0x84F9, 0x88F0, 0 },
+  [FORMAT_D32FS8]     = { 0x8DAD, 0x84F9, 0x8CAD, 0 },
+  [FORMAT_BC1]        = { 0x0000, 0x0000, 0x83F1, 0x8C4D },
+  [FORMAT_BC2]        = { 0x0000, 0x0000, 0x83F2, 0x8C4E },
+  [FORMAT_BC3]        = { 0x0000, 0x0000, 0x83F3, 0x8C4F },
+  [FORMAT_BC4U]       = { 0x0000, 0x0000, 0x8DBB, 0 },
+  [FORMAT_BC4S]       = { 0x0000, 0x0000, 0x8DBC, 0 },
+  [FORMAT_BC5U]       = { 0x0000, 0x0000, 0x8DBD, 0 },
+  [FORMAT_BC5S]       = { 0x0000, 0x0000, 0x8DBE, 0 },
+  [FORMAT_BC6UF]      = { 0x0000, 0x0000, 0x8E8F, 0 },
+  [FORMAT_BC6SF]      = { 0x0000, 0x0000, 0x8E8E, 0 },
+  [FORMAT_BC7]        = { 0x0000, 0x0000, 0x8E8C, 0x8E8D },
+  [FORMAT_ASTC_4x4]   = { 0x0000, 0x0000, 0x93B0, 0x93D0 },
+  [FORMAT_ASTC_5x4]   = { 0x0000, 0x0000, 0x93B1, 0x93D1 },
+  [FORMAT_ASTC_5x5]   = { 0x0000, 0x0000, 0x93B2, 0x93D2 },
+  [FORMAT_ASTC_6x5]   = { 0x0000, 0x0000, 0x93B3, 0x93D3 },
+  [FORMAT_ASTC_6x6]   = { 0x0000, 0x0000, 0x93B4, 0x93D4 },
+  [FORMAT_ASTC_8x5]   = { 0x0000, 0x0000, 0x93B5, 0x93D5 },
+  [FORMAT_ASTC_8x6]   = { 0x0000, 0x0000, 0x93B6, 0x93D6 },
+  [FORMAT_ASTC_8x8]   = { 0x0000, 0x0000, 0x93B7, 0x93D7 },
+  [FORMAT_ASTC_10x5]  = { 0x0000, 0x0000, 0x93B8, 0x93D8 },
+  [FORMAT_ASTC_10x6]  = { 0x0000, 0x0000, 0x93B9, 0x93D9 },
+  [FORMAT_ASTC_10x8]  = { 0x0000, 0x0000, 0x93BA, 0x93DA },
+  [FORMAT_ASTC_10x10] = { 0x0000, 0x0000, 0x93BB, 0x93DB },
+  [FORMAT_ASTC_12x10] = { 0x0000, 0x0000, 0x93BC, 0x93DC },
+  [FORMAT_ASTC_12x12] = { 0x0000, 0x0000, 0x93BD, 0x93DD }
+};
+
 Image* lovrImageCreateRaw(uint32_t width, uint32_t height, TextureFormat format) {
   lovrCheck(width > 0 && height > 0, "Image dimensions must be positive");
   lovrCheck(format < FORMAT_BC1, "Blank images cannot be compressed");
@@ -440,6 +488,55 @@ Blob* lovrImageEncode(Image* image) {
   return lovrBlobCreate(data - size, size, "Encoded Image");
 }
 
+Blob* lovrImageEncodeKTX(Image* image) {
+  bool cube = image->flags & IMAGE_CUBEMAP;
+  bool srgb = (image->flags & IMAGE_SRGB) && ktxFormats[image->format].srgbInternalFormat;
+
+  uint8_t magic[] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+  uint32_t header[13] = {
+    [0] = 0x04030201,
+    [1] = ktxFormats[image->format].type,
+    [2] = image->format < FORMAT_BC1 ? 1 : 0,
+    [3] = ktxFormats[image->format].format,
+    [4] = srgb ? ktxFormats[image->format].srgbInternalFormat : ktxFormats[image->format].internalFormat,
+    [5] = ktxFormats[image->format].format,
+    [6] = image->width,
+    [7] = image->height,
+    [8] = 0,
+    [9] = cube || image->layers == 1 ? 0 : image->layers,
+    [10] = cube ? 6 : 1,
+    [11] = image->levels,
+    [12] = 0
+  };
+
+  size_t size = sizeof(magic) + sizeof(header);
+  for (uint32_t i = 0; i < image->levels; i++) {
+    size += 4 + image->mipmaps[i].size * image->layers;
+  }
+
+  uint8_t* data = malloc(size);
+  lovrAssert(data, "Out of memory");
+  uint8_t* p = data;
+
+  memcpy(p, magic, sizeof(magic));
+  memcpy(p + sizeof(magic), header, sizeof(header));
+  p += sizeof(magic) + sizeof(header);
+
+  // Cubemap levels store the size of a single face, array levels store the size of all layers
+  for (uint32_t i = 0; i < image->levels; i++) {
+    uint32_t levelSize = (uint32_t) (image->mipmaps[i].size * (cube ? 1 : image->layers));
+    memcpy(p, &levelSize, 4);
+    p += 4;
+
+    for (uint32_t j = 0; j < image->layers; j++) {
+      memcpy(p, lovrImageGetLayerData(image, i, j), image->mipmaps[i].size);
+      p += image->mipmaps[i].size;
+    }
+  }
+
+  return lovrBlobCreate(data, size, "Encoded Image");
+}
+
 static Image* loadDDS(Blob* blob) {
   enum { DDPF_FOURCC = 0x4, DDPF_RGB = 0x40 };
   enum { DDSD_DEPTH = 0x800000 };
@@ -962,60 +1059,13 @@ static Image* loadKTX1(Blob* blob) {
 
   // Format
 
-  struct { uint32_t type, format, internalFormat, srgbInternalFormat; } lookup[] = {
-    [FORMAT_R8]         = { 0x1401, 0x1903, 0x8229, 0 },
-    [FORMAT_RG8]        = { 0x1401, 0x8227, 0x822B, 0 },
-    [FORMAT_RGBA8]      = { 0x1401, 0x1908, 0x8058, 0x8C43 },
-    [FORMAT_R16]        = { 0x1403, 0x1903, 0x822A, 0 },
-    [FORMAT_RG16]       = { 0x1403, 0x8227, 0x822C, 0 },
-    [FORMAT_RGBA16]     = { 0x1403, 0x1908, 0x805B, 0 },
-    [FORMAT_R16F]       = { 0x140B, 0x1903, 0x822D, 0 },
-    [FORMAT_RG16F]      = { 0x140B, 0x8227, 0x822F, 0 },
-    [FORMAT_RGBA16F]    = { 0x140B, 0x1908, 0x881A, 0 },
-    [FORMAT_R32F]       = { 0x1406, 0x1903, 0x822E, 0 },
-    [FORMAT_RG32F]      = { 0x1406, 0x8227, 0x8230, 0 },
-    [FORMAT_RGBA32F]    = { 0x1406, 0x1908, 0x8814, 0 },
-    [FORMAT_RGB565]     = { 0x8363, 0x1907, 0x8D62, 0 },
-    [FORMAT_RGB5A1]     = { 0x8034, 0x1908, 0x8057, 0 },
-    [FORMAT_RGB10A2]    = { 0x8368, 0x1908, 0x8059, 0 },
-    [FORMAT_RG11B10F]   = { 0x8C3A, 0x1907, 0x8C3A, 0 },
-    [FORMAT_D16]        = { 0x1403, 0x1902, 0x81A5, 0 },
-    [FORMAT_D32F]       = { 0x1406, 0x1902, 0x8CAC, 0 },
-    [FORMAT_D24S8]      = { 0x84FA, 0x84F9, 0x88F0, 0 },
-    [FORMAT_D32FS8]     = { 0x8DAD, 0x84F9, 0x8CAD, 0 },
-    [FORMAT_BC1]        = { 0x0000, 0x0000, 0x83F1, 0x8C4D },
-    [FORMAT_BC2]        = { 0x0000, 0x0000, 0x83F2, 0x8C4E },
-    [FORMAT_BC3]        = { 0x0000, 0x0000, 0x83F3, 0x8C4F },
-    [FORMAT_BC4U]       = { 0x0000, 0x0000, 0x8DBB, 0 },
-    [FORMAT_BC4S]       = { 0x0000, 0x0000, 0x8DBC, 0 },
-    [FORMAT_BC5U]       = { 0x0000, 0x0000, 0x8DBD, 0 },
-    [FORMAT_BC5S]       = { 0x0000, 0x0000, 0x8DBE, 0 },
-    [FORMAT_BC6UF]      = { 0x0000, 0x0000, 0x8E8F, 0 },
-    [FORMAT_BC6SF]      = { 0x0000, 0x0000, 0x8E8E, 0 },
-    [FORMAT_BC7]        = { 0x0000, 0x0000, 0x8E8C, 0x8E8D },
-    [FORMAT_ASTC_4x4]   = { 0x0000, 0x0000, 0x93B0, 0x93D0 },
-    [FORMAT_ASTC_5x4]   = { 0x0000, 0x0000, 0x93B1, 0x93D1 },
-    [FORMAT_ASTC_5x5]   = { 0x0000, 0x0000, 0x93B2, 0x93D2 },
-    [FORMAT_ASTC_6x5]   = { 0x0000, 0x0000, 0x93B3, 0x93D3 },
-    [FORMAT_ASTC_6x6]   = { 0x0000, 0x0000, 0x93B4, 0x93D4 },
-    [FORMAT_ASTC_8x5]   = { 0x0000, 0x0000, 0x93B5, 0x93D5 },
-    [FORMAT_ASTC_8x6]   = { 0x0000, 0x0000, 0x93B6, 0x93D6 },
-    [FORMAT_ASTC_8x8]   = { 0x0000, 0x0000, 0x93B7, 0x93D7 },
-    [FORMAT_ASTC_10x5]  = { 0x0000, 0x0000, 0x93B8, 0x93D8 },
-    [FORMAT_ASTC_10x6]  = { 0x0000, 0x0000, 0x93B9, 0x93D9 },
-    [FORMAT_ASTC_10x8]  = { 0x0000, 0x0000, 0x93BA, 0x93DA },
-    [FORMAT_ASTC_10x10] = { 0x0000, 0x0000, 0x93BB, 0x93DB },
-    [FORMAT_ASTC_12x10] = { 0x0000, 0x0000, 0x93BC, 0x93DC },
-    [FORMAT_ASTC_12x12] = { 0x0000, 0x0000, 0x93BD, 0x93DD }
-  };
-
   image->format = ~0u;
-  for (uint32_t i = 0; i < COUNTOF(lookup); i++) {
-    if (header.glType == lookup[i].type && header.glFormat == lookup[i].format) {
-      if (header.glInternalFormat == lookup[i].internalFormat) {
+  for (uint32_t i = 0; i < COUNTOF(ktxFormats); i++) {
+    if (header.glType == ktxFormats[i].type && header.glFormat == ktxFormats[i].format) {
+      if (header.glInternalFormat == ktxFormats[i].internalFormat) {
         image->format = i;
         break;
-      } else if (lookup[i].srgbInternalFormat && header.glInternalFormat == lookup[i].srgbInternalFormat) {
+      } else if (ktxFormats[i].srgbInternalFormat && header.glInternalFormat == ktxFormats[i].srgbInternalFormat) {
         image->format = i;
         image->flags |= IMAGE_SRGB;
         break;
@@ -76,3 +76,4 @@ void lovrImageSetPixel(Image* image, uint32_t x, uint32_t y, float pixel[4]);
 void lovrImageCopy(Image* src, Image* dst, uint32_t srcOffset[2], uint32_t dstOffset[2], uint32_t extent[2]);
 void lovrImageClear(Image* image);
 struct Blob* lovrImageEncode(Image* image);
+struct Blob* lovrImageEncodeKTX(Image* image);
@@ -20,11 +20,13 @@ ModelData* lovrModelDataCreate(Blob* source, ModelDataIO* io) {
   lovrAssert(model, "Out of memory");
   model->ref = 1;
 
-  if (!lovrModelDataInitGltf(model, source, io)) {
-    if (!lovrModelDataInitObj(model, source, io)) {
-      if (!lovrModelDataInitStl(model, source, io)) {
-        lovrThrow("Unable to load model from '%s'", source->name);
-        return NULL;
+  if (!lovrModelDataInitCooked(model, source, io)) {
+    if (!lovrModelDataInitGltf(model, source, io)) {
+      if (!lovrModelDataInitObj(model, source, io)) {
+        if (!lovrModelDataInitStl(model, source, io)) {
+          lovrThrow("Unable to load model from '%s'", source->name);
+          return NULL;
+        }
       }
     }
   }
@@ -113,6 +115,11 @@ void lovrModelDataFinalize(ModelData* model) {
   for (uint32_t i = 0; i < model->primitiveCount; i++) {
     ModelPrimitive* primitive = &model->primitives[i];
 
+    // Primitives that aren't used by any node aren't skinned
+    if (primitive->skin == 0xaaaaaaaa) {
+      primitive->skin = ~0u;
+    }
+
     uint32_t vertexCount = primitive->attributes[ATTR_POSITION]->count;
     if (primitive->skin != ~0u) {
       model->skins[primitive->skin].vertexCount += vertexCount;
@@ -188,7 +195,7 @@ void lovrModelDataCopyAttribute(ModelData* data, ModelAttribute* attribute, char
           ((uint8_t*) dst)[j] = ((uint16_t*) src)[j] >> 8;
         }
         if (components == 4 && attribute->components == 3) {
-          ((float*) dst)[3] = 255;
+          ((uint8_t*) dst)[3] = 255;
         }
       }
     } else if (attribute->type == U16 && !attribute->normalized && !normalized) {
@@ -209,7 +216,7 @@ void lovrModelDataCopyAttribute(ModelData* data, ModelAttribute* attribute, char
           ((uint8_t*) dst)[j] = ((float*) src)[j] * 255.f + .5f;
         }
         if (components == 4 && attribute->components == 3) {
-          ((float*) dst)[3] = 255;
+          ((uint8_t*) dst)[3] = 255;
         }
       }
     } else {
@@ -208,12 +208,14 @@ typedef struct ModelData {
 typedef void* ModelDataIO(const char* filename, size_t* bytesRead);
 
 ModelData* lovrModelDataCreate(struct Blob* blob, ModelDataIO* io);
+ModelData* lovrModelDataInitCooked(ModelData* model, struct Blob* blob, ModelDataIO* io);
 ModelData* lovrModelDataInitGltf(ModelData* model, struct Blob* blob, ModelDataIO* io);
 ModelData* lovrModelDataInitObj(ModelData* model, struct Blob* blob, ModelDataIO* io);
 ModelData* lovrModelDataInitStl(ModelData* model, struct Blob* blob, ModelDataIO* io);
 void lovrModelDataDestroy(void* ref);
 void lovrModelDataAllocate(ModelData* model);
 void lovrModelDataFinalize(ModelData* model);
+struct Blob* lovrModelDataEncode(ModelData* model);
 void lovrModelDataCopyAttribute(ModelData* data, ModelAttribute* attribute, char* dst, AttributeType type, uint32_t components, bool normalized, uint32_t count, size_t stride, uint8_t clear);
 void lovrModelDataGetBoundingBox(ModelData* data, float box[6]);
 void lovrModelDataGetBoundingSphere(ModelData* data, float sphere[4]);
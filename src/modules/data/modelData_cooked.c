@@ -0,0 +1,533 @@
+#include "data/modelData.h"
+#include "data/blob.h"
+#include "data/image.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Cooked models are a snapshot of a finalized ModelData.  The file is a header, followed by the
+// ModelData arrays (written as-is, with pointers replaced by offsets), followed by a data section
+// containing vertex/index buffers (already converted to the formats that Models use), keyframes,
+// inverse bind matrices, and images (as KTX, so they are loaded without decoding).  Buffers
+// and keyframes point directly into the source Blob, which is usually memory mapped.  Images are
+// copied, since they can outlive the ModelData.
+//
+// Since structs are stored as-is, cooked files are only compatible with the version of LÖVR that
+// created them (on a platform with the same pointer size and endianness).
+
+#define MAGIC_LOVR 0x4d52564c // 'LVRM'
+#define COOKED_VERSION 1
+#define COOKED_ALIGN 16
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t pointerSize;
+  uint32_t rootNode;
+  uint32_t imageCount;
+  uint32_t bufferCount;
+  uint32_t attributeCount;
+  uint32_t primitiveCount;
+  uint32_t materialCount;
+  uint32_t animationCount;
+  uint32_t skinCount;
+  uint32_t nodeCount;
+  uint32_t channelCount;
+  uint32_t childCount;
+  uint32_t jointCount;
+  uint32_t charCount;
+  uint64_t metadataOffset;
+  uint64_t metadataSize;
+  uint64_t dataOffset;
+  uint64_t size;
+} CookedHeader;
+
+typedef struct {
+  uint64_t offset;
+  uint64_t size;
+} CookedImage;
+
+// Pointers are stored as an offset or index plus one, so NULL stays NULL
+#define PACK(x) ((void*) (uintptr_t) ((x) + 1))
+#define UNPACK(p) ((uintptr_t) (p) - 1)
+
+static const size_t typeSizes[] = {
+  [I8] = 1,
+  [U8] = 1,
+  [I16] = 2,
+  [U16] = 2,
+  [I32] = 4,
+  [U32] = 4,
+  [F32] = 4
+};
+
+typedef arr_t(char) Bytes;
+
+static size_t append(Bytes* bytes, const void* data, size_t size) {
+  size_t offset = ALIGN(bytes->length, COOKED_ALIGN);
+  arr_reserve(bytes, offset + size);
+  memset(bytes->data + bytes->length, 0, offset - bytes->length);
+  if (data) {
+    memcpy(bytes->data + offset, data, size);
+  } else {
+    memset(bytes->data + offset, 0, size);
+  }
+  bytes->length = offset + size;
+  return offset;
+}
+
+static const char* appendName(Bytes* chars, const char* name) {
+  if (!name) return NULL;
+  size_t offset = chars->length;
+  arr_append(chars, name, strlen(name) + 1);
+  return PACK(offset);
+}
+
+static uint32_t keyframeComponents(ModelAnimationChannel* channel) {
+  uint32_t components = channel->property == PROP_ROTATION ? 4 : 3;
+  return channel->smoothing == SMOOTH_CUBIC ? 3 * components : components;
+}
+
+ModelData* lovrModelDataInitCooked(ModelData* model, Blob* source, ModelDataIO* io) {
+  CookedHeader* header = source->data;
+
+  if (source->size < sizeof(CookedHeader) || header->magic != MAGIC_LOVR) {
+    return NULL;
+  }
+
+  lovrAssert(header->version == COOKED_VERSION && header->pointerSize == sizeof(void*), "Model '%s' was cooked by a different version of LÖVR and needs to be cooked again", source->name);
+  lovrAssert(header->size <= source->size && header->dataOffset <= header->size, "Cooked model '%s' is truncated", source->name);
+
+  // The arrays all come before the data section, so their sizes are bounded before allocating them
+  uint64_t arraySize =
+    (uint64_t) header->imageCount * sizeof(CookedImage) +
+    (uint64_t) header->primitiveCount * sizeof(ModelPrimitive) +
+    (uint64_t) header->bufferCount * sizeof(ModelBuffer) +
+    (uint64_t) header->attributeCount * sizeof(ModelAttribute) +
+    (uint64_t) header->materialCount * sizeof(ModelMaterial) +
+    (uint64_t) header->animationCount * sizeof(ModelAnimation) +
+    (uint64_t) header->skinCount * sizeof(ModelSkin) +
+    (uint64_t) header->nodeCount * sizeof(ModelNode) +
+    (uint64_t) header->channelCount * sizeof(ModelAnimationChannel) +
+    (uint64_t) header->childCount * sizeof(uint32_t) +
+    (uint64_t) header->jointCount * sizeof(uint32_t) +
+    (uint64_t) header->charCount;
+  lovrAssert(arraySize <= header->dataOffset, "Cooked model '%s' is corrupt", source->name);
+
+  model->blobCount = 1;
+  model->imageCount = header->imageCount;
+  model->bufferCount = header->bufferCount;
+  model->attributeCount = header->attributeCount;
+  model->primitiveCount = header->primitiveCount;
+  model->materialCount = header->materialCount;
+  model->animationCount = header->animationCount;
+  model->skinCount = header->skinCount;
+  model->nodeCount = header->nodeCount;
+  model->channelCount = header->channelCount;
+  model->childCount = header->childCount;
+  model->jointCount = header->jointCount;
+  model->charCount = header->charCount;
+  model->rootNode = header->rootNode;
+  lovrModelDataAllocate(model);
+
+  model->blobs[0] = source;
+  lovrRetain(source);
+
+  char* base = source->data;
+  char* data = base + header->dataOffset;
+  uint64_t dataSize = header->size - header->dataOffset;
+  size_t cursor = sizeof(CookedHeader);
+
+  // Everything read from the file is checked against the sizes of the arrays and the data section,
+  // so a damaged or malicious file can't make the loader read out of bounds
+#define CHECK(x) lovrAssert(x, "Cooked model '%s' is corrupt", source->name)
+#define IN_DATA(offset, size) ((uint64_t) (offset) <= dataSize && (uint64_t) (size) <= dataSize - (uint64_t) (offset))
+#define IN_ARRAY(index, count, total) ((uint64_t) (index) <= (total) && (uint64_t) (count) <= (total) - (uint64_t) (index))
+
+#define READ(dst, count) \
+  cursor = ALIGN(cursor, COOKED_ALIGN); \
+  CHECK(cursor + (count) * sizeof(*(dst)) <= header->dataOffset); \
+  memcpy(dst, base + cursor, (count) * sizeof(*(dst))); \
+  cursor += (count) * sizeof(*(dst));
+
+  cursor = ALIGN(cursor, COOKED_ALIGN);
+  CHECK(cursor + model->imageCount * sizeof(CookedImage) <= header->dataOffset);
+  CookedImage* images = (CookedImage*) (base + cursor);
+  cursor += model->imageCount * sizeof(CookedImage);
+  READ(model->primitives, model->primitiveCount);
+  READ(model->buffers, model->bufferCount);
+  READ(model->attributes, model->attributeCount);
+  READ(model->materials, model->materialCount);
+  READ(model->animations, model->animationCount);
+  READ(model->skins, model->skinCount);
+  READ(model->nodes, model->nodeCount);
+  READ(model->channels, model->channelCount);
+  READ(model->children, model->childCount);
+  READ(model->joints, model->jointCount);
+  READ(model->chars, model->charCount);
+#undef READ
+
+  // Names are offsets into chars, the last one being terminated means they all are
+  CHECK(model->charCount == 0 || model->chars[model->charCount - 1] == '\0');
+  CHECK(model->nodeCount == 0 || model->rootNode < model->nodeCount);
+
+  // Images get a copy of their pixels, since Images can outlive the ModelData (and the mapping)
+  for (uint32_t i = 0; i < model->imageCount; i++) {
+    if (images[i].size > 0) {
+      CHECK(IN_DATA(images[i].offset, images[i].size));
+      void* pixels = malloc(images[i].size);
+      lovrAssert(pixels, "Out of memory");
+      memcpy(pixels, data + images[i].offset, images[i].size);
+      Blob* blob = lovrBlobCreate(pixels, images[i].size, source->name);
+      model->images[i] = lovrImageCreateFromFile(blob);
+      lovrRelease(blob, lovrBlobDestroy);
+    }
+  }
+
+  for (uint32_t i = 0; i < model->bufferCount; i++) {
+    CHECK(IN_DATA(model->buffers[i].offset, model->buffers[i].size));
+    model->buffers[i].data = data + model->buffers[i].offset;
+  }
+
+  for (uint32_t i = 0; i < model->attributeCount; i++) {
+    ModelAttribute* attribute = &model->attributes[i];
+    CHECK(attribute->buffer < model->bufferCount && attribute->type <= F32 && attribute->components > 0);
+    size_t size = attribute->components * typeSizes[attribute->type];
+    size_t stride = attribute->stride ? attribute->stride : size;
+    size_t extent = attribute->count > 0 ? (attribute->count - 1) * (uint64_t) stride + size : 0;
+    CHECK(IN_ARRAY(attribute->offset, extent, model->buffers[attribute->buffer].size));
+  }
+
+  for (uint32_t i = 0; i < model->primitiveCount; i++) {
+    ModelPrimitive* primitive = &model->primitives[i];
+    for (uint32_t j = 0; j < MAX_DEFAULT_ATTRIBUTES; j++) {
+      if (primitive->attributes[j]) {
+        CHECK(UNPACK(primitive->attributes[j]) < model->attributeCount);
+        primitive->attributes[j] = &model->attributes[UNPACK(primitive->attributes[j])];
+      }
+    }
+    CHECK(primitive->attributes[ATTR_POSITION]);
+    if (primitive->indices) {
+      CHECK(UNPACK(primitive->indices) < model->attributeCount);
+      primitive->indices = &model->attributes[UNPACK(primitive->indices)];
+    }
+    CHECK(primitive->material == ~0u || primitive->material < model->materialCount);
+  }
+
+  for (uint32_t i = 0; i < model->materialCount; i++) {
+    ModelMaterial* material = &model->materials[i];
+    uint32_t textures[] = {
+      material->texture,
+      material->glowTexture,
+      material->metalnessTexture,
+      material->roughnessTexture,
+      material->clearcoatTexture,
+      material->occlusionTexture,
+      material->normalTexture
+    };
+    for (uint32_t j = 0; j < COUNTOF(textures); j++) {
+      CHECK(textures[j] == ~0u || textures[j] < model->imageCount);
+    }
+    if (material->name) {
+      CHECK(UNPACK(material->name) < model->charCount);
+      material->name = model->chars + UNPACK(material->name);
+      map_set(&model->materialMap, hash64(material->name, strlen(material->name)), i);
+    }
+  }
+
+  for (uint32_t i = 0; i < model->animationCount; i++) {
+    ModelAnimation* animation = &model->animations[i];
+    if (animation->channelCount > 0) {
+      CHECK(animation->channels && IN_ARRAY(UNPACK(animation->channels), animation->channelCount, model->channelCount));
+      animation->channels = model->channels + UNPACK(animation->channels);
+    } else {
+      animation->channels = NULL;
+    }
+    if (animation->name) {
+      CHECK(UNPACK(animation->name) < model->charCount);
+      animation->name = model->chars + UNPACK(animation->name);
+      map_set(&model->animationMap, hash64(animation->name, strlen(animation->name)), i);
+    }
+  }
+
+  for (uint32_t i = 0; i < model->channelCount; i++) {
+    ModelAnimationChannel* channel = &model->channels[i];
+    CHECK(channel->nodeIndex < model->nodeCount && channel->property <= PROP_SCALE && channel->smoothing <= SMOOTH_CUBIC);
+    uint64_t count = channel->keyframeCount;
+    CHECK(channel->times && IN_DATA(UNPACK(channel->times), count * sizeof(float)));
+    CHECK(channel->data && IN_DATA(UNPACK(channel->data), count * keyframeComponents(channel) * sizeof(float)));
+    channel->times = (float*) (data + UNPACK(channel->times));
+    channel->data = (float*) (data + UNPACK(channel->data));
+  }
+
+  for (uint32_t i = 0; i < model->skinCount; i++) {
+    ModelSkin* skin = &model->skins[i];
+    if (skin->jointCount > 0) {
+      CHECK(skin->joints && IN_ARRAY(UNPACK(skin->joints), skin->jointCount, model->jointCount));
+      skin->joints = model->joints + UNPACK(skin->joints);
+    } else {
+      skin->joints = NULL;
+    }
+    if (skin->inverseBindMatrices) {
+      CHECK(IN_DATA(UNPACK(skin->inverseBindMatrices), skin->jointCount * 16ull * sizeof(float)));
+      skin->inverseBindMatrices = (float*) (data + UNPACK(skin->inverseBindMatrices));
+    }
+  }
+
+  for (uint32_t i = 0; i < model->nodeCount; i++) {
+    ModelNode* node = &model->nodes[i];
+    if (node->childCount > 0) {
+      CHECK(node->children && IN_ARRAY(UNPACK(node->children), node->childCount, model->childCount));
+      node->children = model->children + UNPACK(node->children);
+    } else {
+      node->children = NULL;
+    }
+    CHECK(IN_ARRAY(node->primitiveIndex, node->primitiveCount, model->primitiveCount));
+    CHECK(node->skin == ~0u || node->skin < model->skinCount);
+    if (node->name) {
+      CHECK(UNPACK(node->name) < model->charCount);
+      node->name = model->chars + UNPACK(node->name);
+      map_set(&model->nodeMap, hash64(node->name, strlen(node->name)), i);
+    }
+  }
+
+  for (uint32_t i = 0; i < model->childCount; i++) {
+    CHECK(model->children[i] < model->nodeCount);
+  }
+
+  for (uint32_t i = 0; i < model->jointCount; i++) {
+    CHECK(model->joints[i] < model->nodeCount);
+  }
+
+  if (header->metadataSize > 0) {
+    CHECK(IN_DATA(header->metadataOffset, header->metadataSize));
+    model->metadata = malloc(header->metadataSize);
+    lovrAssert(model->metadata, "Out of memory");
+    memcpy(model->metadata, data + header->metadataOffset, header->metadataSize);
+    model->metadataSize = header->metadataSize;
+  }
+
+#undef CHECK
+#undef IN_DATA
+#undef IN_ARRAY
+
+  return model;
+}
+
+// Converts vertex attributes to the types Models use, so they can be copied with memcpy
+static void cookAttribute(ModelData* model, ModelAttribute* attribute, DefaultAttribute slot, ModelAttribute* cooked, ModelBuffer* buffer, Bytes* data) {
+  AttributeType type = F32;
+  uint32_t components = attribute->components;
+  bool normalized = false;
+
+  switch (slot) {
+    case ATTR_COLOR: type = U8, components = 4, normalized = true; break;
+    case ATTR_JOINTS: type = U8, components = 4; break;
+    case ATTR_WEIGHTS: type = U8, components = 4, normalized = true; break;
+    default: break;
+  }
+
+  size_t stride = components * (type == F32 ? 4 : 1);
+  buffer->size = attribute->count * stride;
+  buffer->offset = append(data, NULL, buffer->size);
+  lovrModelDataCopyAttribute(model, attribute, data->data + buffer->offset, type, components, normalized, attribute->count, stride, 0);
+
+  *cooked = *attribute;
+  cooked->offset = 0;
+  cooked->stride = 0;
+  cooked->type = type;
+  cooked->components = components;
+  cooked->normalized = normalized;
+  cooked->matrix = false;
+}
+
+// Indices all use the ModelData's index type, since Models copy them directly
+static void cookIndices(ModelData* model, ModelAttribute* attribute, ModelAttribute* cooked, ModelBuffer* buffer, Bytes* data) {
+  AttributeType type = model->indexType == U32 ? U32 : U16;
+  buffer->size = attribute->count * (type == U32 ? 4 : 2);
+  buffer->offset = append(data, NULL, buffer->size);
+  char* src = model->buffers[attribute->buffer].data + attribute->offset;
+  char* dst = data->data + buffer->offset;
+
+  for (uint32_t i = 0; i < attribute->count; i++) {
+    uint32_t index;
+    switch (attribute->type) {
+      case U8: index = ((uint8_t*) src)[i]; break;
+      case U16: index = ((uint16_t*) src)[i]; break;
+      case U32: index = ((uint32_t*) src)[i]; break;
+      default: lovrThrow("Unsupported index type");
+    }
+
+    if (type == U32) {
+      ((uint32_t*) dst)[i] = index;
+    } else {
+      ((uint16_t*) dst)[i] = (uint16_t) index;
+    }
+  }
+
+  *cooked = *attribute;
+  cooked->offset = 0;
+  cooked->stride = 0;
+  cooked->type = type;
+}
+
+// Note: the arrays are patched in place right after they are appended, before file grows again
+Blob* lovrModelDataEncode(ModelData* model) {
+  Bytes file, data, chars;
+  arr_init(&file, arr_alloc);
+  arr_init(&data, arr_alloc);
+  arr_init(&chars, arr_alloc);
+
+  CookedHeader header = {
+    .magic = MAGIC_LOVR,
+    .version = COOKED_VERSION,
+    .pointerSize = sizeof(void*),
+    .rootNode = model->rootNode,
+    .imageCount = model->imageCount,
+    .primitiveCount = model->primitiveCount,
+    .materialCount = model->materialCount,
+    .animationCount = model->animationCount,
+    .skinCount = model->skinCount,
+    .nodeCount = model->nodeCount,
+    .channelCount = model->channelCount,
+    .childCount = model->childCount,
+    .jointCount = model->jointCount
+  };
+
+  append(&file, NULL, sizeof(CookedHeader));
+
+  // Images
+
+  size_t offset = append(&file, NULL, model->imageCount * sizeof(CookedImage));
+  CookedImage* images = (CookedImage*) (file.data + offset);
+  for (uint32_t i = 0; i < model->imageCount; i++) {
+    if (model->images[i]) {
+      Blob* blob = lovrImageEncodeKTX(model->images[i]);
+      images[i].offset = append(&data, blob->data, blob->size);
+      images[i].size = blob->size;
+      lovrRelease(blob, lovrBlobDestroy);
+    }
+  }
+
+  // Buffers, attributes, primitives.  Every attribute used by a primitive gets its own tightly
+  // packed buffer.  Attributes only used by animations and skins aren't needed after loading.
+
+  uint32_t capacity = MAX(model->attributeCount, 1);
+  uint32_t* remap = malloc(capacity * sizeof(uint32_t));
+  ModelBuffer* buffers = calloc(capacity, sizeof(ModelBuffer));
+  ModelAttribute* attributes = malloc(capacity * sizeof(ModelAttribute));
+  lovrAssert(remap && buffers && attributes, "Out of memory");
+  memset(remap, 0xff, capacity * sizeof(uint32_t));
+  uint32_t attributeCount = 0;
+
+  offset = append(&file, model->primitives, model->primitiveCount * sizeof(ModelPrimitive));
+  ModelPrimitive* primitives = (ModelPrimitive*) (file.data + offset);
+  for (uint32_t i = 0; i < model->primitiveCount; i++) {
+    for (uint32_t j = 0; j <= MAX_DEFAULT_ATTRIBUTES; j++) {
+      ModelAttribute** slot = j == MAX_DEFAULT_ATTRIBUTES ? &primitives[i].indices : &primitives[i].attributes[j];
+
+      if (!*slot) {
+        continue;
+      }
+
+      uint32_t index = (uint32_t) (*slot - model->attributes);
+
+      if (remap[index] == ~0u) {
+        uint32_t cooked = remap[index] = attributeCount++;
+        if (j == MAX_DEFAULT_ATTRIBUTES) {
+          cookIndices(model, *slot, &attributes[cooked], &buffers[cooked], &data);
+        } else {
+          cookAttribute(model, *slot, j, &attributes[cooked], &buffers[cooked], &data);
+        }
+        attributes[cooked].buffer = cooked;
+      }
+
+      *slot = PACK(remap[index]);
+    }
+  }
+
+  header.bufferCount = attributeCount;
+  header.attributeCount = attributeCount;
+  append(&file, buffers, attributeCount * sizeof(ModelBuffer));
+  append(&file, attributes, attributeCount * sizeof(ModelAttribute));
+  free(attributes);
+  free(buffers);
+  free(remap);
+
+  // Materials
+
+  offset = append(&file, model->materials, model->materialCount * sizeof(ModelMaterial));
+  ModelMaterial* materials = (ModelMaterial*) (file.data + offset);
+  for (uint32_t i = 0; i < model->materialCount; i++) {
+    materials[i].name = appendName(&chars, materials[i].name);
+  }
+
+  // Animations
+
+  offset = append(&file, model->animations, model->animationCount * sizeof(ModelAnimation));
+  ModelAnimation* animations = (ModelAnimation*) (file.data + offset);
+  for (uint32_t i = 0; i < model->animationCount; i++) {
+    animations[i].name = appendName(&chars, animations[i].name);
+    animations[i].channels = animations[i].channels ? PACK(animations[i].channels - model->channels) : NULL;
+  }
+
+  // Skins
+
+  offset = append(&file, model->skins, model->skinCount * sizeof(ModelSkin));
+  ModelSkin* skins = (ModelSkin*) (file.data + offset);
+  for (uint32_t i = 0; i < model->skinCount; i++) {
+    ModelSkin* skin = &skins[i];
+    if (skin->inverseBindMatrices) {
+      skin->inverseBindMatrices = PACK(append(&data, skin->inverseBindMatrices, skin->jointCount * 16 * sizeof(float)));
+    }
+    skin->joints = skin->joints ? PACK(skin->joints - model->joints) : NULL;
+    skin->vertexCount = 0;
+  }
+
+  // Nodes
+
+  offset = append(&file, model->nodes, model->nodeCount * sizeof(ModelNode));
+  ModelNode* nodes = (ModelNode*) (file.data + offset);
+  for (uint32_t i = 0; i < model->nodeCount; i++) {
+    nodes[i].name = appendName(&chars, nodes[i].name);
+    nodes[i].children = nodes[i].children ? PACK(nodes[i].children - model->children) : NULL;
+  }
+
+  // Channels
+
+  offset = append(&file, model->channels, model->channelCount * sizeof(ModelAnimationChannel));
+  ModelAnimationChannel* channels = (ModelAnimationChannel*) (file.data + offset);
+  for (uint32_t i = 0; i < model->channelCount; i++) {
+    ModelAnimationChannel* channel = &channels[i];
+    size_t count = channel->keyframeCount;
+    channel->times = PACK(append(&data, channel->times, count * sizeof(float)));
+    channel->data = PACK(append(&data, channel->data, count * keyframeComponents(channel) * sizeof(float)));
+  }
+
+  // Children, joints, names
+
+  append(&file, model->children, model->childCount * sizeof(uint32_t));
+  append(&file, model->joints, model->jointCount * sizeof(uint32_t));
+  append(&file, chars.data, chars.length);
+  header.charCount = (uint32_t) chars.length;
+  arr_free(&chars);
+
+  // Metadata
+
+  if (model->metadataSize > 0) {
+    header.metadataOffset = append(&data, model->metadata, model->metadataSize);
+    header.metadataSize = model->metadataSize;
+  }
+
+  // Data, page aligned so it stays aligned when the file is mapped
+
+  header.dataOffset = ALIGN(file.length, 4096);
+  arr_reserve(&file, header.dataOffset + data.length);
+  memset(file.data + file.length, 0, header.dataOffset - file.length);
+  memcpy(file.data + header.dataOffset, data.data, data.length);
+  file.length = header.dataOffset + data.length;
+  header.size = file.length;
+  memcpy(file.data, &header, sizeof(header));
+  arr_free(&data);
+
+  return lovrBlobCreate(file.data, file.length, "Cooked Model");
+}
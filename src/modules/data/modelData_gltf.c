@@ -2,6 +2,7 @@
 #include "data/blob.h"
 #include "data/image.h"
 #include "lib/jsmn/jsmn.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -54,6 +55,16 @@ typedef struct {
   uint32_t image;
 } gltfTexture;
 
+typedef struct {
+  uint32_t buffer;
+  uint32_t offset;
+  uint32_t size;
+  uint32_t stride;
+  uint32_t count;
+  gltfString mode;
+  gltfString filter;
+} gltfMeshopt;
+
 typedef struct {
   uint32_t node;
   uint32_t nodeCount;
@@ -127,6 +138,329 @@ static void* decodeBase64(char* str, size_t length, size_t* decodedLength) {
   return data;
 }
 
+// EXT_meshopt_compression
+
+#define MESHOPT_IS(k) (STR_EQ(k, "EXT_meshopt_compression") || STR_EQ(k, "KHR_meshopt_compression"))
+
+static jsmntok_t* nomMeshopt(const char* json, jsmntok_t* token, gltfMeshopt* meshopt) {
+  for (int k = (token++)->size; k > 0; k--) {
+    gltfString key = NOM_STR(json, token);
+    if (STR_EQ(key, "buffer")) { meshopt->buffer = NOM_INT(json, token); }
+    else if (STR_EQ(key, "byteOffset")) { meshopt->offset = NOM_INT(json, token); }
+    else if (STR_EQ(key, "byteLength")) { meshopt->size = NOM_INT(json, token); }
+    else if (STR_EQ(key, "byteStride")) { meshopt->stride = NOM_INT(json, token); }
+    else if (STR_EQ(key, "count")) { meshopt->count = NOM_INT(json, token); }
+    else if (STR_EQ(key, "mode")) { meshopt->mode = NOM_STR(json, token); }
+    else if (STR_EQ(key, "filter")) { meshopt->filter = NOM_STR(json, token); }
+    else { token += NOM_VALUE(json, token); }
+  }
+  return token;
+}
+
+// Attribute data is split into blocks of vertices.  Each byte of the vertex is stored separately
+// for all vertices in the block, delta encoded from the previous vertex and zigzagged.  Deltas are
+// stored in groups of 16 that use 0, 2, 4, or 8 bits per delta (2 and 4 bit groups store the max
+// value as a sentinel, meaning the actual byte follows the group).
+static const uint8_t* decodeMeshoptGroup(const uint8_t* data, uint8_t* dst, int bits) {
+  if (bits == 0) {
+    memset(dst, 0, 16);
+    return data;
+  } else if (bits == 8) {
+    memcpy(dst, data, 16);
+    return data + 16;
+  }
+
+  const uint8_t* extra = data + bits * 2;
+  uint8_t sentinel = (1 << bits) - 1;
+  for (uint32_t i = 0; i < 16; i++) {
+    uint8_t byte = data[i * bits / 8];
+    uint8_t value = (byte >> (8 - bits - (i * bits) % 8)) & sentinel;
+    dst[i] = value == sentinel ? *extra++ : value;
+  }
+
+  return extra;
+}
+
+static bool decodeMeshoptAttributes(uint8_t* dst, uint32_t count, uint32_t stride, const uint8_t* data, size_t size) {
+  const uint8_t* end = data + size;
+  size_t tail = MAX(stride, 32);
+
+  if (stride == 0 || stride > 256 || stride % 4 != 0 || size < 1 + tail || *data++ != 0xa0) {
+    return false;
+  }
+
+  uint8_t last[256];
+  memcpy(last, end - stride, stride);
+
+  uint32_t blockSize = (8192 / stride) & ~15u;
+  blockSize = MIN(blockSize, 256);
+  uint8_t deltas[256];
+
+  for (uint32_t base = 0; base < count; base += blockSize) {
+    uint32_t vertexCount = MIN(blockSize, count - base);
+    uint32_t groupCount = (vertexCount + 15) / 16;
+
+    for (uint32_t k = 0; k < stride; k++) {
+      const uint8_t* header = data;
+      if ((size_t) (end - data) < (groupCount + 3) / 4) return false;
+      data += (groupCount + 3) / 4;
+
+      for (uint32_t i = 0; i < groupCount; i++) {
+        if (end - data < 24) return false;
+        int bits = (header[i / 4] >> ((i % 4) * 2)) & 3;
+        data = decodeMeshoptGroup(data, deltas + i * 16, (int[]) { 0, 2, 4, 8 }[bits]);
+      }
+
+      uint8_t* p = dst + base * stride + k;
+      uint8_t value = last[k];
+      for (uint32_t i = 0; i < vertexCount; i++, p += stride) {
+        value += (uint8_t) (-(deltas[i] & 1) ^ (deltas[i] >> 1));
+        *p = value;
+      }
+      last[k] = value;
+    }
+  }
+
+  return (size_t) (end - data) == tail;
+}
+
+static uint32_t decodeVarint(const uint8_t** data) {
+  uint32_t result = 0;
+  for (uint32_t shift = 0; shift < 35; shift += 7) {
+    uint8_t byte = *(*data)++;
+    result |= (uint32_t) (byte & 127) << shift;
+    if (byte < 128) break;
+  }
+  return result;
+}
+
+static uint32_t decodeDelta(const uint8_t** data, uint32_t last) {
+  uint32_t v = decodeVarint(data);
+  return last + ((v >> 1) ^ -(v & 1));
+}
+
+static void writeIndex(void* dst, uint32_t stride, uint32_t i, uint32_t index) {
+  if (stride == 2) {
+    ((uint16_t*) dst)[i] = (uint16_t) index;
+  } else {
+    ((uint32_t*) dst)[i] = index;
+  }
+}
+
+// Triangles are encoded using a FIFO of recent edges and a FIFO of recent vertices.  Each triangle
+// has a code byte that references an edge and a vertex (or a new/explicitly encoded vertex).
+// Triangles that don't share an edge use a second code byte, either from a 16 entry table stored
+// at the end of the data or stored inline.
+static bool decodeMeshoptTriangles(void* dst, uint32_t count, uint32_t stride, const uint8_t* data, size_t size) {
+  if (count % 3 != 0 || size < 1 + count / 3 + 16 || (data[0] & 0xf0) != 0xe0 || (data[0] & 0x0f) > 1) {
+    return false;
+  }
+
+  uint32_t edges[16][2];
+  uint32_t vertices[16];
+  uint32_t edgeOffset = 0;
+  uint32_t vertexOffset = 0;
+  memset(edges, 0xff, sizeof(edges));
+  memset(vertices, 0xff, sizeof(vertices));
+
+  uint32_t next = 0;
+  uint32_t last = 0;
+  uint32_t fecmax = (data[0] & 0x0f) >= 1 ? 13 : 15;
+
+  const uint8_t* code = data + 1;
+  const uint8_t* table = data + size - 16;
+  data = code + count / 3;
+
+#define PUSH_EDGE(a, b) edges[edgeOffset][0] = a, edges[edgeOffset][1] = b, edgeOffset = (edgeOffset + 1) & 15
+#define PUSH_VERTEX(v, cond) vertices[vertexOffset] = v, vertexOffset = (vertexOffset + (cond)) & 15
+
+  for (uint32_t i = 0; i < count; i += 3) {
+    if (data > table) return false;
+
+    uint8_t codetri = *code++;
+    uint32_t a, b, c;
+
+    if (codetri < 0xf0) {
+      uint32_t fe = codetri >> 4;
+      uint32_t fec = codetri & 15;
+      a = edges[(edgeOffset - 1 - fe) & 15][0];
+      b = edges[(edgeOffset - 1 - fe) & 15][1];
+
+      if (fec < fecmax) {
+        c = fec == 0 ? next++ : vertices[(vertexOffset - 1 - fec) & 15];
+        PUSH_VERTEX(c, fec == 0);
+      } else {
+        // 13 and 14 encode a delta of -1 and 1 from the last explicitly encoded index
+        last = c = fec != 15 ? last + (fec == 13 ? -1 : 1) : decodeDelta(&data, last);
+        PUSH_VERTEX(c, 1);
+      }
+
+      PUSH_EDGE(c, b);
+      PUSH_EDGE(a, c);
+    } else {
+      uint8_t codeaux;
+      uint32_t fea;
+
+      if (codetri < 0xfe) {
+        codeaux = table[codetri & 15];
+        fea = 0;
+      } else {
+        codeaux = *data++;
+        fea = codetri == 0xfe ? 0 : 15;
+        if (codeaux == 0) next = 0;
+      }
+
+      uint32_t feb = codeaux >> 4;
+      uint32_t fec = codeaux & 15;
+
+      a = fea == 0 ? next++ : 0;
+      b = feb == 0 ? next++ : vertices[(vertexOffset - feb) & 15];
+      c = fec == 0 ? next++ : vertices[(vertexOffset - fec) & 15];
+
+      if (fea == 15) last = a = decodeDelta(&data, last);
+      if (feb == 15) last = b = decodeDelta(&data, last);
+      if (fec == 15) last = c = decodeDelta(&data, last);
+
+      PUSH_VERTEX(a, 1);
+      PUSH_VERTEX(b, feb == 0 || feb == 15);
+      PUSH_VERTEX(c, fec == 0 || fec == 15);
+      PUSH_EDGE(b, a);
+      PUSH_EDGE(c, b);
+      PUSH_EDGE(a, c);
+    }
+
+    writeIndex(dst, stride, i + 0, a);
+    writeIndex(dst, stride, i + 1, b);
+    writeIndex(dst, stride, i + 2, c);
+  }
+
+#undef PUSH_EDGE
+#undef PUSH_VERTEX
+
+  return data == table;
+}
+
+// Index sequences are deltas from one of two previous indices (the low bit picks which one)
+static bool decodeMeshoptIndices(void* dst, uint32_t count, uint32_t stride, const uint8_t* data, size_t size) {
+  if (size < 1 + count + 4 || (data[0] & 0xf0) != 0xd0 || (data[0] & 0x0f) > 1) {
+    return false;
+  }
+
+  const uint8_t* end = data + size - 4;
+  uint32_t last[2] = { 0, 0 };
+  data++;
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (data >= end) return false;
+    uint32_t v = decodeVarint(&data);
+    uint32_t baseline = v & 1;
+    v >>= 1;
+    last[baseline] += (v >> 1) ^ -(v & 1);
+    writeIndex(dst, stride, i, last[baseline]);
+  }
+
+  return data == end;
+}
+
+// Filters are simple per element transforms, written as plain loops so they vectorize well
+
+static void filterOctahedral8(int8_t* data, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++, data += 4) {
+    float x = data[0];
+    float y = data[1];
+    float z = data[2] - fabsf(x) - fabsf(y);
+    float t = z >= 0.f ? 0.f : z;
+    x += x >= 0.f ? t : -t;
+    y += y >= 0.f ? t : -t;
+    float s = 127.f / sqrtf(x * x + y * y + z * z);
+    data[0] = (int8_t) (x * s + (x >= 0.f ? .5f : -.5f));
+    data[1] = (int8_t) (y * s + (y >= 0.f ? .5f : -.5f));
+    data[2] = (int8_t) (z * s + (z >= 0.f ? .5f : -.5f));
+  }
+}
+
+static void filterOctahedral16(int16_t* data, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++, data += 4) {
+    float x = data[0];
+    float y = data[1];
+    float z = data[2] - fabsf(x) - fabsf(y);
+    float t = z >= 0.f ? 0.f : z;
+    x += x >= 0.f ? t : -t;
+    y += y >= 0.f ? t : -t;
+    float s = 32767.f / sqrtf(x * x + y * y + z * z);
+    data[0] = (int16_t) (x * s + (x >= 0.f ? .5f : -.5f));
+    data[1] = (int16_t) (y * s + (y >= 0.f ? .5f : -.5f));
+    data[2] = (int16_t) (z * s + (z >= 0.f ? .5f : -.5f));
+  }
+}
+
+// The 3 smallest components are stored, the index of the largest one is in the low 2 bits of w
+static void filterQuaternion(int16_t* data, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++, data += 4) {
+    float scale = 1.f / sqrtf(2.f) / (float) (data[3] | 3);
+    float x = data[0] * scale;
+    float y = data[1] * scale;
+    float z = data[2] * scale;
+    float ww = 1.f - x * x - y * y - z * z;
+    float w = sqrtf(ww >= 0.f ? ww : 0.f);
+    int largest = data[3] & 3;
+    data[(largest + 1) & 3] = (int16_t) (x * 32767.f + (x >= 0.f ? .5f : -.5f));
+    data[(largest + 2) & 3] = (int16_t) (y * 32767.f + (y >= 0.f ? .5f : -.5f));
+    data[(largest + 3) & 3] = (int16_t) (z * 32767.f + (z >= 0.f ? .5f : -.5f));
+    data[(largest + 0) & 3] = (int16_t) (w * 32767.f + .5f);
+  }
+}
+
+// Floats with a 24 bit signed mantissa and an 8 bit signed exponent
+static void filterExponential(uint32_t* data, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    int32_t mantissa = (int32_t) (data[i] << 8) >> 8;
+    int32_t exponent = (int32_t) data[i] >> 24;
+    union { float f; uint32_t u; } x = { .u = (uint32_t) (exponent + 127) << 23 };
+    x.f *= (float) mantissa;
+    data[i] = x.u;
+  }
+}
+
+static void decodeMeshopt(gltfMeshopt* meshopt, const uint8_t* src, void* dst) {
+  uint32_t count = meshopt->count;
+  uint32_t stride = meshopt->stride;
+  bool success;
+
+  if (STR_EQ(meshopt->mode, "ATTRIBUTES")) {
+    success = decodeMeshoptAttributes(dst, count, stride, src, meshopt->size);
+  } else if (STR_EQ(meshopt->mode, "TRIANGLES")) {
+    lovrAssert(stride == 2 || stride == 4, "meshopt index data must use 2 or 4 byte indices");
+    success = decodeMeshoptTriangles(dst, count, stride, src, meshopt->size);
+  } else if (STR_EQ(meshopt->mode, "INDICES")) {
+    lovrAssert(stride == 2 || stride == 4, "meshopt index data must use 2 or 4 byte indices");
+    success = decodeMeshoptIndices(dst, count, stride, src, meshopt->size);
+  } else {
+    lovrThrow("Unknown meshopt compression mode '%.*s'", (int) meshopt->mode.length, meshopt->mode.data);
+  }
+
+  lovrAssert(success, "Failed to decode meshopt compressed data (it may be corrupt or use an unsupported version)");
+
+  if (!meshopt->filter.data || STR_EQ(meshopt->filter, "NONE")) {
+    return;
+  } else if (STR_EQ(meshopt->filter, "OCTAHEDRAL")) {
+    lovrAssert(stride == 4 || stride == 8, "meshopt octahedral filter requires a stride of 4 or 8");
+    if (stride == 4) {
+      filterOctahedral8(dst, count);
+    } else {
+      filterOctahedral16(dst, count);
+    }
+  } else if (STR_EQ(meshopt->filter, "QUATERNION")) {
+    lovrAssert(stride == 8, "meshopt quaternion filter requires a stride of 8");
+    filterQuaternion(dst, count);
+  } else if (STR_EQ(meshopt->filter, "EXPONENTIAL")) {
+    lovrAssert(stride % 4 == 0, "meshopt exponential filter requires a stride that is a multiple of 4");
+    filterExponential(dst, count * stride / 4);
+  } else {
+    lovrThrow("Unknown meshopt filter '%.*s'", (int) meshopt->filter.length, meshopt->filter.data);
+  }
+}
+
 static jsmntok_t* nomTexture(const char* json, jsmntok_t* token, uint32_t* imageIndex, gltfTexture* textures, ModelMaterial* material) {
   for (int k = (token++)->size; k > 0; k--) {
     gltfString key = NOM_STR(json, token);
@@ -277,6 +611,7 @@ ModelData* lovrModelDataInitGltf(ModelData* model, Blob* source, ModelDataIO* io
     jsmntok_t* scenes;
     jsmntok_t* skins;
     int sceneCount;
+    int meshoptCount;
   } info;
 
   memset(&info, 0, sizeof(info));
@@ -353,7 +688,26 @@ ModelData* lovrModelDataInitGltf(ModelData* model, Blob* source, ModelDataIO* io
     } else if (STR_EQ(key, "bufferViews")) {
       info.bufferViews = token;
       model->bufferCount = token->size;
-      token += NOM_VALUE(json, token);
+      for (int i = (token++)->size; i > 0; i--) {
+        for (int k = (token++)->size; k > 0; k--) {
+          gltfString key = NOM_STR(json, token);
+          if (STR_EQ(key, "extensions")) {
+            for (int k2 = (token++)->size; k2 > 0; k2--) {
+              gltfString key = NOM_STR(json, token);
+              if (MESHOPT_IS(key)) { info.meshoptCount++; }
+              token += NOM_VALUE(json, token);
+            }
+          } else {
+            token += NOM_VALUE(json, token);
+          }
+        }
+      }
+
+    } else if (STR_EQ(key, "extensionsRequired")) {
+      for (int i = (token++)->size; i > 0; i--) {
+        gltfString extension = NOM_STR(json, token);
+        lovrAssert(!STR_EQ(extension, "KHR_draco_mesh_compression"), "glTF files compressed with Draco are not supported (meshopt compression can be used instead)");
+      }
 
     } else if (STR_EQ(key, "images")) {
       model->imageCount = token->size;
@@ -496,6 +850,10 @@ ModelData* lovrModelDataInitGltf(ModelData* model, Blob* source, ModelDataIO* io
     model->nodeCount++;
   }
 
+  // Each meshopt compressed buffer view is decoded into its own Blob, after the glTF buffers
+  uint32_t decodedBlob = model->blobCount;
+  model->blobCount += info.meshoptCount;
+
   // Allocate memory, then revisit all of the tokens that were recorded during the prepass and write
   // their data into this memory.
   lovrModelDataAllocate(model);
@@ -508,15 +866,33 @@ ModelData* lovrModelDataInitGltf(ModelData* model, Blob* source, ModelDataIO* io
       gltfString uri;
       memset(&uri, 0, sizeof(uri));
       size_t size = 0;
+      bool fallback = false;
 
       for (int k = (token++)->size; k > 0; k--) {
         gltfString key = NOM_STR(json, token);
         if (STR_EQ(key, "byteLength")) { size = NOM_INT(json, token); }
         else if (STR_EQ(key, "uri")) { uri = NOM_STR(json, token); }
+        else if (STR_EQ(key, "extensions")) {
+          for (int k2 = (token++)->size; k2 > 0; k2--) {
+            gltfString key = NOM_STR(json, token);
+            if (MESHOPT_IS(key)) {
+              for (int k3 = (token++)->size; k3 > 0; k3--) {
+                gltfString key = NOM_STR(json, token);
+                if (STR_EQ(key, "fallback")) { fallback = NOM_BOOL(json, token); }
+                else { token += NOM_VALUE(json, token); }
+              }
+            } else {
+              token += NOM_VALUE(json, token);
+            }
+          }
+        }
         else { token += NOM_VALUE(json, token); }
       }
 
-      if (uri.data) {
+      // Fallback buffers are only used by loaders that don't support meshopt, so they aren't loaded
+      if (fallback) {
+        *blob = NULL;
+      } else if (uri.data) {
         if (uri.length >= 5 && !strncmp("data:", uri.data, 5)) {
           size_t decodedLength;
           void* bufferData = decodeBase64(uri.data, uri.length, &decodedLength);
@@ -543,16 +919,50 @@ ModelData* lovrModelDataInitGltf(ModelData* model, Blob* source, ModelDataIO* io
     jsmntok_t* token = info.bufferViews;
     ModelBuffer* buffer = model->buffers;
     for (int i = (token++)->size; i > 0; i--, buffer++) {
+      gltfMeshopt meshopt = { 0 };
+      bool compressed = false;
+
       for (int k = (token++)->size; k > 0; k--) {
         gltfString key = NOM_STR(json, token);
         if (STR_EQ(key, "buffer")) { buffer->blob = NOM_INT(json, token); }
         else if (STR_EQ(key, "byteOffset")) { buffer->offset = NOM_INT(json, token); }
         else if (STR_EQ(key, "byteLength")) { buffer->size = NOM_INT(json, token); }
         else if (STR_EQ(key, "byteStride")) { buffer->stride = NOM_INT(json, token); }
+        else if (STR_EQ(key, "extensions")) {
+          for (int k2 = (token++)->size; k2 > 0; k2--) {
+            gltfString key = NOM_STR(json, token);
+            if (MESHOPT_IS(key)) {
+              token = nomMeshopt(json, token, &meshopt);
+              compressed = true;
+            } else {
+              token += NOM_VALUE(json, token);
+            }
+          }
+        }
         else { token += NOM_VALUE(json, token); }
       }
 
+      if (compressed) {
+        lovrAssert(meshopt.buffer < decodedBlob, "Invalid meshopt buffer index");
+        Blob* blob = model->blobs[meshopt.buffer];
+        size_t offset = meshopt.offset + ((glb && blob == source) ? binOffset : 0);
+        lovrAssert(blob && offset + meshopt.size <= blob->size, "meshopt compressed data is out of bounds");
+
+        size_t size = (size_t) meshopt.count * meshopt.stride;
+        void* data = malloc(MAX(size, 1));
+        lovrAssert(data, "Out of memory");
+        decodeMeshopt(&meshopt, (uint8_t*) blob->data + offset, data);
+
+        model->blobs[decodedBlob] = lovrBlobCreate(data, size, NULL);
+        buffer->blob = decodedBlob++;
+        buffer->offset = 0;
+        buffer->size = size;
+        buffer->data = data;
+        continue;
+      }
+
       Blob* blob = model->blobs[buffer->blob];
+      lovrAssert(blob, "Buffer view uses a meshopt fallback buffer without being compressed");
 
       // If this is the glb binary data, increment the offset to account for the file header
       if (glb && blob == source) {
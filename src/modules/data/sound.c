@@ -6,6 +6,7 @@
 #define MINIMP3_FLOAT_OUTPUT
 #define MINIMP3_NO_STDIO
 #include "lib/minimp3/minimp3_ex.h"
+#include "lib/tinycthread/tinycthread.h"
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
@@ -21,6 +22,7 @@ struct Sound {
   void* callbackMemo; // When using lovrSoundCreateFromCallback, any state the read callback uses should be stored here
   SoundDestroyCallback* callbackMemoDestroy; // This should be used to free the callbackMemo pointer (if appropriate)
   Blob* blob;
+  Blob* retired; // Cached Blob this Sound used before it was written to (see unshare)
   void* decoder;
   void* stream;
   SampleFormat format;
@@ -28,6 +30,7 @@ struct Sound {
   uint32_t sampleRate;
   uint32_t frames;
   uint32_t cursor;
+  bool shared;
 };
 
 // Readers
@@ -310,14 +313,194 @@ static bool loadMP3(Sound* sound, Blob* blob, bool decode) {
   }
 }
 
+// Decoded cache
+
+// Decoded samples are cached by the size and hash of the encoded file, so loading the same file
+// again shares the samples instead of decoding them again.  Sounds using a cached Blob copy it
+// before they're written to.  The least recently used entries are evicted to stay under the limit.
+// Entries are only looked up and added under the lock, so loading Sounds on multiple threads
+// doesn't serialize the decoding.  The lock is created the first time it's used.  The cache holds
+// its own reference to each Blob, so decoded samples stay in memory (up to the limit) after every
+// Sound using them is destroyed.
+
+#define MAX_CACHED_SOUNDS 256
+
+typedef struct {
+  uint64_t hash;
+  size_t size;
+  Blob* blob;
+  SampleFormat format;
+  ChannelLayout layout;
+  uint32_t sampleRate;
+  uint32_t frames;
+  uint64_t lastUsed;
+} CachedSound;
+
+static struct {
+  once_flag once;
+  mtx_t lock;
+  CachedSound entries[MAX_CACHED_SOUNDS];
+  uint32_t count;
+  size_t bytes;
+  size_t limit;
+  uint64_t tick;
+} cache = { .once = ONCE_FLAG_INIT, .limit = 64 << 20 };
+
+static void cacheInit(void) {
+  lovrAssert(mtx_init(&cache.lock, mtx_plain) == thrd_success, "Failed to create Sound cache mutex");
+}
+
+static void cacheLock(void) {
+  call_once(&cache.once, cacheInit);
+  mtx_lock(&cache.lock);
+}
+
+static void cacheUnlock(void) {
+  mtx_unlock(&cache.lock);
+}
+
+// Evicts entries until there's room for another one of the given size.  Must hold the lock.
+static void cacheEvict(size_t size) {
+  while (cache.count > 0 && (cache.bytes + size > cache.limit || cache.count == MAX_CACHED_SOUNDS)) {
+    uint32_t oldest = 0;
+    for (uint32_t i = 1; i < cache.count; i++) {
+      if (cache.entries[i].lastUsed < cache.entries[oldest].lastUsed) {
+        oldest = i;
+      }
+    }
+
+    cache.bytes -= cache.entries[oldest].blob->size;
+    lovrRelease(cache.entries[oldest].blob, lovrBlobDestroy);
+    cache.entries[oldest] = cache.entries[--cache.count];
+  }
+}
+
+// Hashing a long compressed file is only worth it when it's going to be decoded anyway, or when
+// there's an entry with the same size.  hash is left at zero when the file wasn't hashed.
+static bool cacheLoad(Sound* sound, Blob* blob, bool decode, uint64_t* hash) {
+  bool candidate = false;
+  cacheLock();
+  for (uint32_t i = 0; i < cache.count && !candidate; i++) {
+    candidate = cache.entries[i].size == blob->size;
+  }
+  cacheUnlock();
+
+  if (!candidate) {
+    *hash = decode ? hash64(blob->data, blob->size) : 0;
+    return false;
+  }
+
+  *hash = hash64(blob->data, blob->size);
+
+  cacheLock();
+  for (uint32_t i = 0; i < cache.count; i++) {
+    CachedSound* entry = &cache.entries[i];
+    if (entry->hash == *hash && entry->size == blob->size) {
+      entry->lastUsed = ++cache.tick;
+      lovrRetain(entry->blob);
+      sound->blob = entry->blob;
+      sound->format = entry->format;
+      sound->layout = entry->layout;
+      sound->sampleRate = entry->sampleRate;
+      sound->frames = entry->frames;
+      sound->read = lovrSoundReadRaw;
+      sound->shared = true;
+      cacheUnlock();
+      return true;
+    }
+  }
+  cacheUnlock();
+
+  return false;
+}
+
+static void cacheSave(Sound* sound, Blob* blob, uint64_t hash) {
+  cacheLock();
+  size_t limit = cache.limit;
+  cacheUnlock();
+
+  if (sound->decoder || sound->blob->size > limit) {
+    return;
+  }
+
+  if (hash == 0) {
+    hash = hash64(blob->data, blob->size);
+  }
+
+  cacheLock();
+
+  for (uint32_t i = 0; i < cache.count; i++) {
+    if (cache.entries[i].hash == hash && cache.entries[i].size == blob->size) {
+      cacheUnlock();
+      return;
+    }
+  }
+
+  cacheEvict(sound->blob->size);
+
+  // The name of the decoded Blob may point into the encoded one, which doesn't live as long
+  sound->blob->name = "Sound";
+  lovrRetain(sound->blob);
+  sound->shared = true;
+
+  cache.entries[cache.count++] = (CachedSound) {
+    .hash = hash,
+    .size = blob->size,
+    .blob = sound->blob,
+    .format = sound->format,
+    .layout = sound->layout,
+    .sampleRate = sound->sampleRate,
+    .frames = sound->frames,
+    .lastUsed = ++cache.tick
+  };
+
+  cache.bytes += sound->blob->size;
+  cacheUnlock();
+}
+
+// Gives a Sound its own copy of its samples before they're modified.  The audio or decoder thread
+// may still be reading from the shared Blob, so the Sound keeps its reference to it until it's
+// destroyed, in case it was the last one.
+static void unshare(Sound* sound) {
+  if (!sound->shared) return;
+  Blob* blob = sound->blob;
+  void* data = malloc(blob->size);
+  lovrAssert(data, "Out of memory");
+  memcpy(data, blob->data, blob->size);
+  sound->blob = lovrBlobCreate(data, blob->size, blob->name);
+  sound->retired = blob;
+  sound->shared = false;
+}
+
+size_t lovrSoundGetCacheLimit(size_t* bytes) {
+  cacheLock();
+  size_t limit = cache.limit;
+  *bytes = cache.bytes;
+  cacheUnlock();
+  return limit;
+}
+
+void lovrSoundSetCacheLimit(size_t limit) {
+  cacheLock();
+  cache.limit = limit;
+  cacheEvict(0);
+  cacheUnlock();
+}
+
 Sound* lovrSoundCreateFromFile(Blob* blob, bool decode) {
   Sound* sound = calloc(1, sizeof(Sound));
   lovrAssert(sound, "Out of memory");
   sound->ref = 1;
 
-  if (loadOgg(sound, blob, decode)) return sound;
-  if (loadWAV(sound, blob, decode)) return sound;
-  if (loadMP3(sound, blob, decode)) return sound;
+  uint64_t hash;
+  if (cacheLoad(sound, blob, decode, &hash)) {
+    return sound;
+  }
+
+  if (loadOgg(sound, blob, decode) || loadWAV(sound, blob, decode) || loadMP3(sound, blob, decode)) {
+    cacheSave(sound, blob, hash);
+    return sound;
+  }
 
   lovrThrow("Could not load sound from '%s': Audio format not recognized", blob->name);
 }
@@ -340,6 +523,7 @@ void lovrSoundDestroy(void* ref) {
   Sound* sound = (Sound*) ref;
   if (sound->callbackMemoDestroy) sound->callbackMemoDestroy(sound);
   lovrRelease(sound->blob, lovrBlobDestroy);
+  lovrRelease(sound->retired, lovrBlobDestroy);
   if (sound->read == lovrSoundReadOgg) stb_vorbis_close(sound->decoder);
   if (sound->read == lovrSoundReadMp3) mp3dec_ex_close(sound->decoder), free(sound->decoder);
   ma_pcm_rb_uninit(sound->stream);
@@ -410,6 +594,7 @@ uint32_t lovrSoundWrite(Sound* sound, uint32_t offset, uint32_t count, const voi
       frames += chunk;
     }
   } else {
+    unshare(sound);
     count = MIN(count, sound->frames - offset);
     memcpy((char*) sound->blob->data + offset * stride, data, count * stride);
     frames = count;
@@ -437,6 +622,7 @@ uint32_t lovrSoundCopy(Sound* src, Sound* dst, uint32_t count, uint32_t srcOffse
       frames += read;
     }
   } else {
+    unshare(dst);
     count = MIN(count, dst->frames - dstOffset);
     size_t stride = lovrSoundGetStride(src);
     char* data = (char*) dst->blob->data + dstOffset * stride;
@@ -44,3 +44,8 @@ uint32_t lovrSoundRead(Sound* sound, uint32_t offset, uint32_t count, void* data
 uint32_t lovrSoundWrite(Sound* sound, uint32_t offset, uint32_t count, const void* data);
 uint32_t lovrSoundCopy(Sound* src, Sound* dst, uint32_t frames, uint32_t srcOffset, uint32_t dstOffset);
 void *lovrSoundGetCallbackMemo(Sound* sound);
+
+// Decoded files are cached, up to 64MB by default.  Cached samples stay in memory after the Sounds
+// using them are destroyed, until they're evicted.  A limit of zero empties and disables the cache.
+size_t lovrSoundGetCacheLimit(size_t* bytes);
+void lovrSoundSetCacheLimit(size_t limit);
@@ -40,6 +40,7 @@ typedef struct Archive {
   bool (*stat)(struct Archive* archive, const char* path, FileInfo* info);
   void (*list)(struct Archive* archive, const char* path, fs_list_cb callback, void* context);
   bool (*read)(struct Archive* archive, const char* path, size_t bytes, size_t* bytesRead, void** data);
+  bool (*map)(struct Archive* archive, const char* path, size_t* size, void** data);
   void (*close)(struct Archive* archive);
   zip_state zip;
   strpool strings;
@@ -299,6 +300,20 @@ void* lovrFilesystemRead(const char* path, size_t bytes, size_t* bytesRead) {
   return NULL;
 }
 
+// Returns NULL if the file is missing or can't be mapped (e.g. it lives in a zip), in which case
+// callers fall back to reading it
+void* lovrFilesystemMap(const char* path, size_t* size) {
+  if (valid(path)) {
+    void* data;
+    FOREACH_ARCHIVE(archive) {
+      if (archive->map(archive, path, size, &data)) {
+        return data;
+      }
+    }
+  }
+  return NULL;
+}
+
 void lovrFilesystemGetDirectoryItems(const char* path, void (*callback)(void* context, const char* path), void* context) {
   if (valid(path)) {
     FOREACH_ARCHIVE(archive) {
@@ -567,6 +582,22 @@ static bool dir_read(Archive* archive, const char* path, size_t bytes, size_t* b
   return true;
 }
 
+// If the file exists but can't be mapped, this still returns true (with NULL data) so the file is
+// read from this archive instead of a lower priority one.
+static bool dir_map(Archive* archive, const char* path, size_t* size, void** data) {
+  char resolved[LOVR_PATH_MAX];
+  if (dir_resolve(archive, resolved, path) != PATH_PHYSICAL) {
+    return false;
+  }
+
+  if ((*data = fs_map(resolved, size)) != NULL) {
+    return true;
+  }
+
+  FileInfo info;
+  return fs_stat(resolved, &info) && info.type == FILE_REGULAR;
+}
+
 static void dir_close(Archive* archive) {
   arr_free(&archive->strings);
 }
@@ -580,6 +611,7 @@ static bool dir_init(Archive* archive, const char* path, const char* mountpoint,
   archive->stat = dir_stat;
   archive->list = dir_list;
   archive->read = dir_read;
+  archive->map = dir_map;
   archive->close = dir_close;
   return true;
 }
@@ -670,6 +702,14 @@ static bool zip_read(Archive* archive, const char* path, size_t bytes, size_t* b
   return true;
 }
 
+// Files in zips are not page aligned (and may be compressed), so they are never mapped.  This
+// still returns true if the file exists, so lower priority archives don't shadow it.
+static bool zip_map(Archive* archive, const char* path, size_t* size, void** data) {
+  if (!zip_lookup(archive, path)) return false;
+  *data = NULL;
+  return true;
+}
+
 static void zip_close(Archive* archive) {
   arr_free(&archive->nodes);
   map_free(&archive->lookup);
@@ -800,6 +840,7 @@ static bool zip_init(Archive* archive, const char* filename, const char* mountpo
   archive->stat = zip_stat;
   archive->list = zip_list;
   archive->read = zip_read;
+  archive->map = zip_map;
   archive->close = zip_close;
   return true;
 }
@@ -8,12 +8,14 @@
 #include "math/math.h"
 #include "core/gpu.h"
 #include "core/maf.h"
+#include "core/mesh.h"
 #include "core/spv.h"
 #include "core/os.h"
 #include "util.h"
 #include "monkey.h"
 #include "shaders.h"
 #include <math.h>
+#include <float.h>
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,6 +30,9 @@ const char** os_vk_get_instance_extensions(uint32_t* count);
 #define MAX_TRANSFORMS 16
 #define MAX_PIPELINES 4
 #define MAX_SHADER_RESOURCES 32
+#define MAX_CULL_VIEWS 6
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
 #define FLOAT_BITS(f) ((union { float f; uint32_t u; }) { f }).u
 
 typedef struct {
@@ -178,6 +183,11 @@ typedef struct {
     uint32_t count;
     void** pointer;
   } index;
+  struct {
+    Buffer* buffer;
+    uint32_t offset;
+    uint32_t count;
+  } indirect;
   uint32_t start;
   uint32_t count;
   uint32_t instances;
@@ -188,10 +198,33 @@ typedef struct {
   float properties[3][4];
 } NodeTransform;
 
+typedef struct {
+  float center[3];
+  uint32_t count;
+  struct {
+    uint32_t start;
+    uint32_t count;
+    float error;
+  } levels[MAX_MODEL_LODS];
+} LodChain;
+
+typedef struct {
+  uint32_t start;
+  uint32_t count;
+} MeshletRange;
+
 struct Model {
   uint32_t ref;
   ModelInfo info;
   Draw* draws;
+  LodChain* lods;
+  MeshletRange* meshlets;
+  Buffer* meshletBuffer;
+  Buffer* cullBuffer;
+  uint32_t cullCapacity;
+  uint32_t cullCursor;
+  uint32_t cullTick;
+  bool cullOverflow;
   Buffer* rawVertexBuffer;
   Buffer* vertexBuffer;
   Buffer* indexBuffer;
@@ -266,6 +299,14 @@ typedef struct {
   struct { float x, y, z; } tangent;
 } ModelVertex;
 
+typedef struct {
+  struct { float x, y, z; } position;
+  struct { int8_t x, y, z, w; } normal;
+  struct { uint16_t u, v; } uv;
+  struct { uint8_t r, g, b, a; } color;
+  struct { int8_t x, y, z, w; } tangent;
+} QuantizedModelVertex;
+
 enum {
   SHAPE_PLANE,
   SHAPE_BOX,
@@ -375,6 +416,7 @@ static struct {
   bool hasMaterialUpload;
   bool hasGlyphUpload;
   bool hasReskin;
+  bool hasCull;
   float background[4];
   TextureFormat depthFormat;
   Texture* window;
@@ -384,6 +426,7 @@ static struct {
   Texture* defaultTexture;
   Sampler* defaultSamplers[2];
   Shader* animator;
+  Shader* culler;
   Shader* timeWizard;
   Shader* defaultShaders[DEFAULT_SHADER_COUNT];
   gpu_vertex_format vertexFormats[VERTEX_FORMAX];
@@ -427,6 +470,7 @@ static void trackBuffer(Pass* pass, Buffer* buffer, gpu_phase phase, gpu_cache c
 static void trackTexture(Pass* pass, Texture* texture, gpu_phase phase, gpu_cache cache);
 static void trackMaterial(Pass* pass, Material* material, gpu_phase phase, gpu_cache cache);
 static void updateModelTransforms(Model* model, uint32_t nodeIndex, float* parent);
+static void optimizeModelMesh(ModelVertex* vertices, uint32_t* vertexCount, uint32_t* indices, uint32_t* indexCount, bool weld);
 static void checkShaderFeatures(uint32_t* features, uint32_t count);
 static void onResize(uint32_t width, uint32_t height);
 static void onMessage(void* context, const char* message, bool severe);
@@ -690,6 +734,7 @@ void lovrGraphicsDestroy() {
   lovrRelease(state.defaultSamplers[0], lovrSamplerDestroy);
   lovrRelease(state.defaultSamplers[1], lovrSamplerDestroy);
   lovrRelease(state.animator, lovrShaderDestroy);
+  lovrRelease(state.culler, lovrShaderDestroy);
   lovrRelease(state.timeWizard, lovrShaderDestroy);
   for (size_t i = 0; i < COUNTOF(state.defaultShaders); i++) {
     lovrRelease(state.defaultShaders[i], lovrShaderDestroy);
@@ -878,6 +923,14 @@ void lovrGraphicsSubmit(Pass** passes, uint32_t count) {
     state.hasReskin = false;
   }
 
+  if (state.hasCull) {
+    barriers[0].prev |= GPU_PHASE_SHADER_COMPUTE;
+    barriers[0].next |= GPU_PHASE_INDIRECT;
+    barriers[0].flush |= GPU_CACHE_STORAGE_WRITE;
+    barriers[0].clear |= GPU_CACHE_INDIRECT;
+    state.hasCull = false;
+  }
+
   // Finish passes
   for (uint32_t i = 0; i < count; i++) {
     Pass* pass = passes[i];
@@ -2637,13 +2690,188 @@ Model* lovrModelCreate(const ModelInfo* info) {
     model->materials[i] = lovrMaterialCreate(&material);
   }
 
+  // Sort primitives by their skin, so there is a single contiguous region of skinned vertices
+  size_t stack = tempPush();
+  uint64_t* map = tempAlloc(data->primitiveCount * sizeof(uint64_t));
+
+  for (uint32_t i = 0; i < data->primitiveCount; i++) {
+    map[i] = ((uint64_t) data->primitives[i].skin << 32) | i;
+  }
+
+  qsort(map, data->primitiveCount, sizeof(uint64_t), u64cmp);
+
+  // Vertices and indices are normally converted straight into the buffers.  Optimizing, quantizing,
+  // and generating LODs or meshlets stages them in CPU memory first, since the vertex/index counts
+  // change.  The animator reads full precision vertices, so skinned models are never quantized.
+  bool quantize = info->quantize && data->skinnedVertexCount == 0;
+  bool generateIndices = info->optimize || info->lodCount > 0 || info->meshlets;
+  bool staged = generateIndices || quantize;
+  uint32_t* vertexCounts = tempAlloc(data->primitiveCount * sizeof(uint32_t));
+  uint32_t* indexCounts = tempAlloc(data->primitiveCount * sizeof(uint32_t));
+  uint32_t vertexCount = data->vertexCount;
+  uint32_t indexCount = data->indexCount;
+  AttributeType indexType = data->indexType;
+  ModelVertex* stagingVertices = NULL;
+  uint32_t* stagingIndices = NULL;
+  arr_t(uint32_t) lodIndices;
+  arr_t(mesh_meshlet) meshlets;
+  arr_init(&lodIndices, arr_alloc);
+  arr_init(&meshlets, arr_alloc);
+
+  if (info->lodCount > 0) {
+    lovrCheck(info->lodCount <= MAX_MODEL_LODS, "Too many LODs (max is %d)", MAX_MODEL_LODS);
+    model->lods = calloc(data->primitiveCount, sizeof(LodChain));
+    lovrAssert(model->lods, "Out of memory");
+  }
+
+  if (info->meshlets) {
+    model->meshlets = calloc(data->primitiveCount, sizeof(MeshletRange));
+    lovrAssert(model->meshlets, "Out of memory");
+  }
+
+  for (uint32_t i = 0; i < data->primitiveCount; i++) {
+    ModelPrimitive* primitive = &data->primitives[i];
+    vertexCounts[i] = primitive->attributes[ATTR_POSITION]->count;
+    indexCounts[i] = primitive->indices ? primitive->indices->count : 0;
+  }
+
+  if (staged) {
+    uint32_t indexCapacity = 0;
+    for (uint32_t i = 0; i < data->primitiveCount; i++) {
+      bool generate = generateIndices && !data->primitives[i].indices && data->primitives[i].mode == DRAW_TRIANGLES;
+      indexCapacity += generate ? vertexCounts[i] : indexCounts[i];
+    }
+
+    stagingVertices = malloc(MAX(data->vertexCount, 1) * sizeof(ModelVertex));
+    stagingIndices = malloc(MAX(indexCapacity, 1) * sizeof(uint32_t));
+    lovrAssert(stagingVertices && stagingIndices, "Out of memory");
+
+    vertexCount = 0;
+    indexCount = 0;
+    uint32_t maxIndexedVertexCount = 0;
+
+    for (uint32_t i = 0; i < data->primitiveCount; i++) {
+      uint32_t index = map[i] & ~0u;
+      ModelPrimitive* primitive = &data->primitives[index];
+      ModelAttribute** attributes = primitive->attributes;
+      ModelVertex* vertices = stagingVertices + vertexCount;
+      uint32_t* indices = stagingIndices + indexCount;
+      uint32_t count = vertexCounts[index];
+      size_t stride = sizeof(ModelVertex);
+
+      lovrModelDataCopyAttribute(data, attributes[ATTR_POSITION], (char*) vertices + 0, F32, 3, false, count, stride, 0);
+      lovrModelDataCopyAttribute(data, attributes[ATTR_NORMAL], (char*) vertices + 12, F32, 3, false, count, stride, 0);
+      lovrModelDataCopyAttribute(data, attributes[ATTR_UV], (char*) vertices + 24, F32, 2, false, count, stride, 0);
+      lovrModelDataCopyAttribute(data, attributes[ATTR_COLOR], (char*) vertices + 32, U8, 4, true, count, stride, 255);
+      lovrModelDataCopyAttribute(data, attributes[ATTR_TANGENT], (char*) vertices + 36, F32, 3, false, count, stride, 0);
+
+      if (primitive->indices) {
+        ModelAttribute* attribute = primitive->indices;
+        char* src = data->buffers[attribute->buffer].data + attribute->offset;
+        switch (attribute->type) {
+          case U8: for (uint32_t j = 0; j < attribute->count; j++) indices[j] = ((uint8_t*) src)[j]; break;
+          case U16: for (uint32_t j = 0; j < attribute->count; j++) indices[j] = ((uint16_t*) src)[j]; break;
+          case U32: memcpy(indices, src, attribute->count * sizeof(uint32_t)); break;
+          default: lovrUnreachable();
+        }
+      } else if (generateIndices && primitive->mode == DRAW_TRIANGLES) {
+        for (uint32_t j = 0; j < count; j++) {
+          indices[j] = j;
+        }
+        indexCounts[index] = count;
+      }
+
+      // Skinned vertices can't be welded or compacted, since the skin data is stored separately
+      if (info->optimize && primitive->mode == DRAW_TRIANGLES) {
+        bool skinned = primitive->skin != ~0u;
+        optimizeModelMesh(vertices, &vertexCounts[index], indices, &indexCounts[index], !skinned);
+      }
+
+      // Each LOD is simplified from the previous one, stopping early once simplification stalls.
+      // LOD starts are relative to the LOD indices for now, they get offset later.
+      if (info->lodCount > 0 && primitive->mode == DRAW_TRIANGLES && indexCounts[index] > 0) {
+        LodChain* chain = &model->lods[index];
+        float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (uint32_t j = 0; j < vertexCounts[index]; j++) {
+          float* position = &vertices[j].position.x;
+          min[0] = MIN(min[0], position[0]), max[0] = MAX(max[0], position[0]);
+          min[1] = MIN(min[1], position[1]), max[1] = MAX(max[1], position[1]);
+          min[2] = MIN(min[2], position[2]), max[2] = MAX(max[2], position[2]);
+        }
+
+        chain->center[0] = (min[0] + max[0]) * .5f;
+        chain->center[1] = (min[1] + max[1]) * .5f;
+        chain->center[2] = (min[2] + max[2]) * .5f;
+
+        float error = 0.f;
+        size_t source = ~0u;
+        uint32_t sourceCount = indexCounts[index];
+
+        for (uint32_t j = 0; j < info->lodCount; j++) {
+          uint32_t target = (uint32_t) (indexCounts[index] * CLAMP(info->lodRatios[j], 0.f, 1.f)) / 3 * 3;
+          size_t start = lodIndices.length;
+          arr_expand(&lodIndices, sourceCount);
+          uint32_t* src = source == ~0u ? indices : lodIndices.data + source;
+          uint32_t* dst = lodIndices.data + start;
+
+          float levelError;
+          uint32_t count = mesh_simplify(dst, src, sourceCount, &vertices->position.x, sizeof(ModelVertex), vertexCounts[index], target, &levelError);
+
+          if (count == 0 || (uint64_t) count * 16 > (uint64_t) sourceCount * 15) {
+            break;
+          }
+
+          if (info->optimize) {
+            mesh_optimize_vertex_cache(dst, count, vertexCounts[index]);
+          }
+
+          error += levelError;
+          chain->levels[j].start = (uint32_t) start;
+          chain->levels[j].count = count;
+          chain->levels[j].error = error;
+          chain->count++;
+          lodIndices.length += count;
+          sourceCount = count;
+          source = start;
+        }
+      }
+
+      // Meshlets reorder the primitive's triangles, so each meshlet is a contiguous range of indices.
+      // Skinned vertices move around, which would invalidate the meshlet bounds.
+      if (info->meshlets && primitive->mode == DRAW_TRIANGLES && primitive->skin == ~0u && indexCounts[index] > 0) {
+        uint32_t bound = mesh_meshlet_bound(indexCounts[index], MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+        arr_expand(&meshlets, bound);
+        mesh_meshlet* meshlet = meshlets.data + meshlets.length;
+        uint32_t count = mesh_build_meshlets(meshlet, indices, indexCounts[index], &vertices->position.x, sizeof(ModelVertex), vertexCounts[index], MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+
+        for (uint32_t j = 0; j < count; j++) {
+          meshlet[j].start += indexCount;
+        }
+
+        model->meshlets[index].start = (uint32_t) meshlets.length;
+        model->meshlets[index].count = count;
+        meshlets.length += count;
+      }
+
+      if (indexCounts[index] > 0) {
+        maxIndexedVertexCount = MAX(maxIndexedVertexCount, vertexCounts[index]);
+      }
+
+      vertexCount += vertexCounts[index];
+      indexCount += indexCounts[index];
+    }
+
+    indexType = maxIndexedVertexCount > 0xffff ? U32 : U16;
+  }
+
   // Buffers
   char* vertices = NULL;
   char* indices = NULL;
   char* skinData = NULL;
 
   BufferInfo vertexBufferInfo = {
-    .length = data->vertexCount,
+    .length = vertexCount,
     .stride = sizeof(ModelVertex),
     .fieldCount = 5,
     .fields[0] = { 0, 10, FIELD_F32x3, offsetof(ModelVertex, position) },
@@ -2653,6 +2881,19 @@ Model* lovrModelCreate(const ModelInfo* info) {
     .fields[4] = { 0, 14, FIELD_F32x3, offsetof(ModelVertex, tangent) }
   };
 
+  if (quantize) {
+    vertexBufferInfo = (BufferInfo) {
+      .length = vertexCount,
+      .stride = sizeof(QuantizedModelVertex),
+      .fieldCount = 5,
+      .fields[0] = { 0, 10, FIELD_F32x3, offsetof(QuantizedModelVertex, position) },
+      .fields[1] = { 0, 11, FIELD_SN8x4, offsetof(QuantizedModelVertex, normal) },
+      .fields[2] = { 0, 12, FIELD_F16x2, offsetof(QuantizedModelVertex, uv) },
+      .fields[3] = { 0, 13, FIELD_UN8x4, offsetof(QuantizedModelVertex, color) },
+      .fields[4] = { 0, 14, FIELD_SN8x4, offsetof(QuantizedModelVertex, tangent) }
+    };
+  }
+
   model->vertexBuffer = lovrBufferCreate(&vertexBufferInfo, (void**) &vertices);
 
   if (data->skinnedVertexCount > 0) {
@@ -2680,26 +2921,45 @@ Model* lovrModelCreate(const ModelInfo* info) {
     gpu_sync(state.stream, &barrier, 1);
   }
 
-  uint32_t indexSize = data->indexType == U32 ? 4 : 2;
+  uint32_t indexSize = indexType == U32 ? 4 : 2;
+
+  // LOD indices go after all of the regular indices
+  for (uint32_t i = 0; model->lods && i < data->primitiveCount; i++) {
+    for (uint32_t j = 0; j < model->lods[i].count; j++) {
+      model->lods[i].levels[j].start += indexCount;
+    }
+  }
 
-  if (data->indexCount > 0) {
+  if (indexCount + lodIndices.length > 0) {
     model->indexBuffer = lovrBufferCreate(&(BufferInfo) {
-      .length = data->indexCount,
+      .length = indexCount + (uint32_t) lodIndices.length,
       .stride = indexSize,
       .fieldCount = 1,
-      .fields[0] = { 0, 0, data->indexType == U32 ? FIELD_INDEX32 : FIELD_INDEX16, 0 }
+      .fields[0] = { 0, 0, indexType == U32 ? FIELD_INDEX32 : FIELD_INDEX16, 0 }
     }, (void**) &indices);
   }
 
-  // Sort primitives by their skin, so there is a single contiguous region of skinned vertices
-  size_t stack = tempPush();
-  uint64_t* map = tempAlloc(data->primitiveCount * sizeof(uint64_t));
+  if (meshlets.length > 0) {
+    void* meshletData = NULL;
 
-  for (uint32_t i = 0; i < data->primitiveCount; i++) {
-    map[i] = ((uint64_t) data->primitives[i].skin << 32) | i;
+    model->meshletBuffer = lovrBufferCreate(&(BufferInfo) {
+      .length = (uint32_t) meshlets.length,
+      .stride = sizeof(mesh_meshlet),
+      .label = "Meshlets"
+    }, &meshletData);
+
+    memcpy(meshletData, meshlets.data, meshlets.length * sizeof(mesh_meshlet));
+
+    beginFrame();
+    gpu_barrier barrier;
+    barrier.prev = GPU_PHASE_TRANSFER;
+    barrier.next = GPU_PHASE_SHADER_COMPUTE;
+    barrier.flush = GPU_CACHE_TRANSFER_WRITE;
+    barrier.clear = GPU_CACHE_STORAGE_READ;
+    gpu_sync(state.stream, &barrier, 1);
   }
 
-  qsort(map, data->primitiveCount, sizeof(uint64_t), u64cmp);
+  arr_free(&meshlets);
 
   // Draws
   model->draws = calloc(data->primitiveCount, sizeof(Draw));
@@ -2718,45 +2978,96 @@ Model* lovrModelCreate(const ModelInfo* info) {
     draw->material = primitive->material == ~0u ? NULL: model->materials[primitive->material];
     draw->vertex.buffer = model->vertexBuffer;
 
-    if (primitive->indices) {
+    if (indexCounts[map[i] & ~0u] > 0) {
       draw->index.buffer = model->indexBuffer;
       draw->start = indexCursor;
-      draw->count = primitive->indices->count;
+      draw->count = indexCounts[map[i] & ~0u];
       draw->base = vertexCursor;
       indexCursor += draw->count;
     } else {
       draw->start = vertexCursor;
-      draw->count = primitive->attributes[ATTR_POSITION]->count;
+      draw->count = vertexCounts[map[i] & ~0u];
     }
 
-    vertexCursor += primitive->attributes[ATTR_POSITION]->count;
+    vertexCursor += vertexCounts[map[i] & ~0u];
   }
 
   // Vertices
-  for (uint32_t i = 0; i < data->primitiveCount; i++) {
+  if (staged) {
+    if (quantize) {
+      QuantizedModelVertex* vertex = (QuantizedModelVertex*) vertices;
+      for (uint32_t i = 0; i < vertexCount; i++, vertex++) {
+        ModelVertex* v = &stagingVertices[i];
+        vertex->position.x = v->position.x;
+        vertex->position.y = v->position.y;
+        vertex->position.z = v->position.z;
+        vertex->normal.x = (int8_t) roundf(CLAMP(v->normal.x, -1.f, 1.f) * 127.f);
+        vertex->normal.y = (int8_t) roundf(CLAMP(v->normal.y, -1.f, 1.f) * 127.f);
+        vertex->normal.z = (int8_t) roundf(CLAMP(v->normal.z, -1.f, 1.f) * 127.f);
+        vertex->normal.w = 0;
+        vertex->uv.u = float32to16(v->uv.u);
+        vertex->uv.v = float32to16(v->uv.v);
+        vertex->color.r = v->color.r;
+        vertex->color.g = v->color.g;
+        vertex->color.b = v->color.b;
+        vertex->color.a = v->color.a;
+        vertex->tangent.x = (int8_t) roundf(CLAMP(v->tangent.x, -1.f, 1.f) * 127.f);
+        vertex->tangent.y = (int8_t) roundf(CLAMP(v->tangent.y, -1.f, 1.f) * 127.f);
+        vertex->tangent.z = (int8_t) roundf(CLAMP(v->tangent.z, -1.f, 1.f) * 127.f);
+        vertex->tangent.w = 0;
+      }
+    } else {
+      memcpy(vertices, stagingVertices, vertexCount * sizeof(ModelVertex));
+    }
+
+    if (indexType == U32) {
+      memcpy(indices, stagingIndices, indexCount * sizeof(uint32_t));
+      memcpy(indices + indexCount * 4, lodIndices.data, lodIndices.length * sizeof(uint32_t));
+    } else {
+      for (uint32_t i = 0; i < indexCount; i++) {
+        ((uint16_t*) indices)[i] = (uint16_t) stagingIndices[i];
+      }
+      for (uint32_t i = 0; i < lodIndices.length; i++) {
+        ((uint16_t*) indices)[indexCount + i] = (uint16_t) lodIndices.data[i];
+      }
+    }
+
+    free(stagingVertices);
+    free(stagingIndices);
+    arr_free(&lodIndices);
+  } else {
+    for (uint32_t i = 0; i < data->primitiveCount; i++) {
+      ModelPrimitive* primitive = &data->primitives[map[i] & ~0u];
+      ModelAttribute** attributes = primitive->attributes;
+      uint32_t count = attributes[ATTR_POSITION]->count;
+      size_t stride = sizeof(ModelVertex);
+
+      lovrModelDataCopyAttribute(data, attributes[ATTR_POSITION], vertices + 0, F32, 3, false, count, stride, 0);
+      lovrModelDataCopyAttribute(data, attributes[ATTR_NORMAL], vertices + 12, F32, 3, false, count, stride, 0);
+      lovrModelDataCopyAttribute(data, attributes[ATTR_UV], vertices + 24, F32, 2, false, count, stride, 0);
+      lovrModelDataCopyAttribute(data, attributes[ATTR_COLOR], vertices + 32, U8, 4, true, count, stride, 255);
+      lovrModelDataCopyAttribute(data, attributes[ATTR_TANGENT], vertices + 36, F32, 3, false, count, stride, 0);
+      vertices += count * stride;
+
+      if (primitive->indices) {
+        char* indexData = data->buffers[primitive->indices->buffer].data + primitive->indices->offset;
+        memcpy(indices, indexData, primitive->indices->count * indexSize);
+        indices += primitive->indices->count * indexSize;
+      }
+    }
+  }
+
+  // Skin data (skinned primitives are sorted first and are never compacted, so this lines up)
+  for (uint32_t i = 0; i < data->primitiveCount && data->skinnedVertexCount > 0; i++) {
     ModelPrimitive* primitive = &data->primitives[map[i] & ~0u];
     ModelAttribute** attributes = primitive->attributes;
     uint32_t count = attributes[ATTR_POSITION]->count;
-    size_t stride = sizeof(ModelVertex);
 
-    lovrModelDataCopyAttribute(data, attributes[ATTR_POSITION], vertices + 0, F32, 3, false, count, stride, 0);
-    lovrModelDataCopyAttribute(data, attributes[ATTR_NORMAL], vertices + 12, F32, 3, false, count, stride, 0);
-    lovrModelDataCopyAttribute(data, attributes[ATTR_UV], vertices + 24, F32, 2, false, count, stride, 0);
-    lovrModelDataCopyAttribute(data, attributes[ATTR_COLOR], vertices + 32, U8, 4, true, count, stride, 255);
-    lovrModelDataCopyAttribute(data, attributes[ATTR_TANGENT], vertices + 36, F32, 3, false, count, stride, 0);
-    vertices += count * stride;
-
-    if (data->skinnedVertexCount > 0 && primitive->skin != ~0u) {
+    if (primitive->skin != ~0u) {
       lovrModelDataCopyAttribute(data, attributes[ATTR_JOINTS], skinData + 0, U8, 4, false, count, 8, 0);
       lovrModelDataCopyAttribute(data, attributes[ATTR_WEIGHTS], skinData + 4, U8, 4, true, count, 8, 0);
       skinData += count * 8;
     }
-
-    if (primitive->indices) {
-      char* indexData = data->buffers[primitive->indices->buffer].data + primitive->indices->offset;
-      memcpy(indices, indexData, primitive->indices->count * indexSize);
-      indices += primitive->indices->count * indexSize;
-    }
   }
 
   for (uint32_t i = 0; i < data->skinCount; i++) {
@@ -2785,10 +3096,14 @@ void lovrModelDestroy(void* ref) {
   lovrRelease(model->vertexBuffer, lovrBufferDestroy);
   lovrRelease(model->indexBuffer, lovrBufferDestroy);
   lovrRelease(model->skinBuffer, lovrBufferDestroy);
+  lovrRelease(model->meshletBuffer, lovrBufferDestroy);
+  lovrRelease(model->cullBuffer, lovrBufferDestroy);
   lovrRelease(model->info.data, lovrModelDataDestroy);
   free(model->localTransforms);
   free(model->globalTransforms);
   free(model->draws);
+  free(model->lods);
+  free(model->meshlets);
   free(model->materials);
   free(model->textures);
   free(model);
@@ -4324,7 +4639,13 @@ static void lovrPassDraw(Pass* pass, Draw* draw) {
   uint32_t instances = MAX(draw->instances, 1);
   uint32_t id = pass->drawCount & 0xff;
 
-  if (draw->index.buffer || draw->index.count > 0) {
+  if (draw->indirect.buffer) {
+    uint32_t limit = MAX(state.limits.indirectDrawCount, 1);
+    for (uint32_t i = 0; i < draw->indirect.count; i += limit) {
+      uint32_t offset = draw->indirect.offset + i * 20;
+      gpu_draw_indirect_indexed(pass->stream, draw->indirect.buffer->gpu, offset, MIN(draw->indirect.count - i, limit), 20);
+    }
+  } else if (draw->index.buffer || draw->index.count > 0) {
     gpu_draw_indexed(pass->stream, count, instances, draw->start, draw->base, id);
   } else {
     gpu_draw(pass->stream, count, instances, draw->start, id);
@@ -5099,6 +5420,207 @@ void lovrPassMonkey(Pass* pass, float* transform) {
   memcpy(indices, monkey_indices, sizeof(monkey_indices));
 }
 
+// Picks the coarsest LOD whose error, projected to the screen, stays under the Model's LOD error.
+// With multiple views, the view that needs the most detail wins.  Returns false for full detail.
+static bool selectLod(Pass* pass, Model* model, LodChain* chain, Draw* draw) {
+  if (chain->count == 0 || pass->viewCount == 0) {
+    return false;
+  }
+
+  float m[16];
+  mat4_init(m, pass->transform);
+  if (draw->transform) mat4_mul(m, draw->transform);
+
+  float sx = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+  float sy = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+  float sz = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+  float scale = sqrtf(MAX(MAX(sx, sy), sz));
+
+  uint32_t level = chain->count;
+  for (uint32_t i = 0; i < pass->viewCount && level > 0; i++) {
+    float* projection = pass->cameras[i].projection;
+    float center[4] = { chain->center[0], chain->center[1], chain->center[2], 1.f };
+    mat4_transform(m, center);
+    mat4_transform(pass->cameras[i].view, center);
+    float w = projection[3] * center[0] + projection[7] * center[1] + projection[11] * center[2] + projection[15];
+    float pixels = fabsf(projection[5]) * pass->height * .5f * scale / MAX(w, 1e-6f);
+
+    uint32_t l = level;
+    while (l > 0 && chain->levels[l - 1].error * pixels > model->info.lodError) {
+      l--;
+    }
+
+    level = l;
+  }
+
+  if (level > 0) {
+    draw->start = chain->levels[level - 1].start;
+    draw->count = chain->levels[level - 1].count;
+  }
+
+  return level > 0;
+}
+
+// Culls a primitive's meshlets against the frustum and normal cones of each view, on the GPU.  The
+// compute shader writes an indirect draw for every meshlet, with 0 instances if it was culled.  The
+// indirect draws for a Model go in a buffer with room for a few culled draws per frame, it grows if
+// it overflows and the draw falls back to drawing all of the meshlets in the meantime.
+static bool cullMeshlets(Pass* pass, Model* model, MeshletRange* range, Draw* draw) {
+  if (range->count == 0 || pass->viewCount == 0 || pass->viewCount > MAX_CULL_VIEWS || draw->instances > 1 || !state.features.indirectDrawFirstInstance) {
+    return false;
+  }
+
+  if (model->cullTick != state.tick) {
+    if (!model->cullBuffer || model->cullOverflow) {
+      uint32_t meshletCount = model->meshletBuffer->info.length;
+      model->cullCapacity = model->cullBuffer ? model->cullCapacity * 2 : meshletCount * 4;
+      lovrRelease(model->cullBuffer, lovrBufferDestroy);
+      model->cullBuffer = lovrBufferCreate(&(BufferInfo) {
+        .length = model->cullCapacity,
+        .stride = 20,
+        .label = "Meshlet Draws"
+      }, NULL);
+      model->cullOverflow = false;
+    }
+
+    model->cullTick = state.tick;
+    model->cullCursor = 0;
+  }
+
+  if (model->cullCursor + range->count > model->cullCapacity) {
+    model->cullOverflow = true;
+    return false;
+  }
+
+  if (!state.culler) {
+    state.culler = lovrShaderCreate(&(ShaderInfo) {
+      .type = SHADER_COMPUTE,
+      .source[0] = { lovr_shader_cluster_comp, sizeof(lovr_shader_cluster_comp) },
+      .flags = &(ShaderFlag) { NULL, 0, state.device.subgroupSize },
+      .flagCount = 1,
+      .label = "culler"
+    });
+  }
+
+  float m[16];
+  mat4_init(m, pass->transform);
+  if (draw->transform) mat4_mul(m, draw->transform);
+
+  // Culling happens in the Model's local space: frustum planes come from the model-view-projection
+  // matrix and the eye position comes from the inverse model-view matrix.  Mirroring transforms
+  // flip the winding, and the cone test doesn't work for orthographic projections.
+  struct { float planes[6][4]; float eye[4]; } views[MAX_CULL_VIEWS];
+  float determinant = m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+  bool counterclockwise = (pass->pipeline->info.rasterizer.winding == GPU_WINDING_CCW) != (pass->cameras[0].projection[5] > 0.f);
+  gpu_cull_mode cullMode = pass->pipeline->info.rasterizer.cullMode;
+  float coneSign = cullMode == GPU_CULL_NONE ? 0.f : 1.f;
+  if (!counterclockwise) coneSign = -coneSign;
+  if (cullMode == GPU_CULL_FRONT) coneSign = -coneSign;
+  if (determinant < 0.f) coneSign = -coneSign;
+
+  for (uint32_t i = 0; i < pass->viewCount; i++) {
+    float mvp[16];
+    mat4_init(mvp, pass->cameras[i].projection);
+    mat4_mul(mvp, pass->cameras[i].view);
+    mat4_mul(mvp, m);
+
+    float rows[4][4];
+    for (uint32_t r = 0; r < 4; r++) {
+      for (uint32_t c = 0; c < 4; c++) {
+        rows[r][c] = mvp[4 * c + r];
+      }
+    }
+
+    for (uint32_t j = 0; j < 4; j++) {
+      views[i].planes[0][j] = rows[3][j] + rows[0][j];
+      views[i].planes[1][j] = rows[3][j] - rows[0][j];
+      views[i].planes[2][j] = rows[3][j] + rows[1][j];
+      views[i].planes[3][j] = rows[3][j] - rows[1][j];
+      views[i].planes[4][j] = rows[2][j];
+      views[i].planes[5][j] = rows[3][j] - rows[2][j];
+    }
+
+    // Infinite far planes have no normal, they never cull anything
+    for (uint32_t j = 0; j < 6; j++) {
+      float* plane = views[i].planes[j];
+      float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+      if (length > 0.f) {
+        plane[0] /= length, plane[1] /= length, plane[2] /= length, plane[3] /= length;
+      } else {
+        plane[0] = plane[1] = plane[2] = 0.f, plane[3] = 1.f;
+      }
+    }
+
+    float inverse[16];
+    mat4_init(inverse, pass->cameras[i].view);
+    mat4_mul(inverse, m);
+    mat4_invert(inverse);
+    views[i].eye[0] = inverse[12];
+    views[i].eye[1] = inverse[13];
+    views[i].eye[2] = inverse[14];
+    views[i].eye[3] = 1.f;
+
+    if (pass->cameras[i].projection[15] != 0.f) {
+      coneSign = 0.f;
+    }
+  }
+
+  gpu_pipeline* pipeline = state.pipelines.data[state.culler->computePipelineIndex];
+  gpu_layout* layout = state.layouts.data[state.culler->layout].gpu;
+  gpu_shader* shader = state.culler->gpu;
+  gpu_buffer* uniforms = tempAlloc(gpu_sizeof_buffer());
+
+  uint32_t size = pass->viewCount * sizeof(views[0]);
+  void* data = gpu_map(uniforms, size, state.limits.uniformBufferAlign, GPU_MAP_STREAM);
+  memcpy(data, views, size);
+
+  gpu_binding bindings[] = {
+    { 0, GPU_SLOT_STORAGE_BUFFER, .buffer = { model->meshletBuffer->gpu, 0, model->meshletBuffer->size } },
+    { 1, GPU_SLOT_STORAGE_BUFFER, .buffer = { model->cullBuffer->gpu, 0, model->cullBuffer->size } },
+    { 2, GPU_SLOT_UNIFORM_BUFFER, .buffer = { uniforms, 0, size } }
+  };
+
+  gpu_bundle* bundle = getBundle(state.culler->layout);
+  gpu_bundle_info bundleInfo = { layout, bindings, COUNTOF(bindings) };
+  gpu_bundle_write(&bundle, &bundleInfo, 1);
+
+  struct {
+    uint32_t first;
+    uint32_t count;
+    uint32_t offset;
+    int32_t baseVertex;
+    uint32_t instances;
+    uint32_t drawId;
+    uint32_t viewCount;
+    float coneSign;
+  } constants = {
+    range->start,
+    range->count,
+    model->cullCursor,
+    (int32_t) draw->base,
+    MAX(draw->instances, 1),
+    pass->drawCount & 0xff,
+    pass->viewCount,
+    coneSign
+  };
+
+  uint32_t subgroupSize = state.device.subgroupSize;
+
+  gpu_compute_begin(state.stream);
+  gpu_bind_pipeline(state.stream, pipeline, true);
+  gpu_bind_bundles(state.stream, shader, &bundle, 0, 1, NULL, 0);
+  gpu_push_constants(state.stream, shader, &constants, sizeof(constants));
+  gpu_compute(state.stream, (range->count + subgroupSize - 1) / subgroupSize, 1, 1);
+  gpu_compute_end(state.stream);
+  state.hasCull = true;
+
+  draw->indirect.buffer = model->cullBuffer;
+  draw->indirect.offset = model->cullCursor * 20;
+  draw->indirect.count = range->count;
+  model->cullCursor += range->count;
+  return true;
+}
+
 static void renderNode(Pass* pass, Model* model, uint32_t index, bool recurse, uint32_t instances) {
   ModelNode* node = &model->info.data->nodes[index];
   mat4 globalTransform = model->globalTransforms + 16 * index;
@@ -5106,7 +5628,9 @@ static void renderNode(Pass* pass, Model* model, uint32_t index, bool recurse, u
   for (uint32_t i = 0; i < node->primitiveCount; i++) {
     Draw draw = model->draws[node->primitiveIndex + i];
     if (node->skin == ~0u) draw.transform = globalTransform;
+    bool lod = model->lods && selectLod(pass, model, &model->lods[node->primitiveIndex + i], &draw);
     draw.instances = instances;
+    if (model->meshlets && !lod) cullMeshlets(pass, model, &model->meshlets[node->primitiveIndex + i], &draw);
     lovrPassDraw(pass, &draw);
   }
 
@@ -5856,6 +6380,33 @@ static void updateModelTransforms(Model* model, uint32_t nodeIndex, float* paren
   }
 }
 
+// Welding and fetch reordering compact the vertices to the front of the array, updating the counts
+static void optimizeModelMesh(ModelVertex* vertices, uint32_t* vertexCount, uint32_t* indices, uint32_t* indexCount, bool weld) {
+  if (weld) {
+    *indexCount = mesh_weld(indices, *indexCount, vertices, *vertexCount, sizeof(ModelVertex));
+  }
+
+  mesh_optimize_vertex_cache(indices, *indexCount, *vertexCount);
+  mesh_optimize_overdraw(indices, *indexCount, &vertices->position.x, sizeof(ModelVertex), *vertexCount, 1.05f);
+
+  if (weld) {
+    size_t stack = tempPush();
+    uint32_t* remap = tempAlloc(*vertexCount * sizeof(uint32_t));
+    ModelVertex* original = tempAlloc(*vertexCount * sizeof(ModelVertex));
+    memcpy(original, vertices, *vertexCount * sizeof(ModelVertex));
+    uint32_t count = mesh_optimize_vertex_fetch(remap, indices, *indexCount, *vertexCount);
+
+    for (uint32_t i = 0; i < *vertexCount; i++) {
+      if (remap[i] != ~0u) {
+        vertices[remap[i]] = original[i];
+      }
+    }
+
+    *vertexCount = count;
+    tempPop(stack);
+  }
+}
+
 // Only an explicit set of SPIR-V capabilities are allowed
 // Some capabilities require a GPU feature to be supported
 // Some common unsupported capabilities are checked directly, to provide better error messages
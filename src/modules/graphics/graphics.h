@@ -400,9 +400,17 @@ void lovrFontGetVertices(Font* font, ColoredString* strings, uint32_t count, flo
 
 // Model
 
+#define MAX_MODEL_LODS 4
+
 typedef struct {
   struct ModelData* data;
   bool mipmaps;
+  bool optimize;
+  bool quantize;
+  bool meshlets;
+  uint32_t lodCount;
+  float lodRatios[MAX_MODEL_LODS];
+  float lodError;
 } ModelInfo;
 
 typedef enum {
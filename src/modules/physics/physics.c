@@ -1,15 +1,40 @@
 #include "physics.h"
 #include "core/maf.h"
+#include "core/mesh.h"
+#include "core/os.h"
 #include "util.h"
 #include <ode/ode.h>
 #include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  dJointID joint;
+  uint32_t event;
+} ContactJoint;
 
 struct World {
   uint32_t ref;
   dWorldID id;
   dSpaceID space;
   dJointGroupID contactGroup;
+  dThreadingImplementationID threading;
+  dThreadingThreadPoolID threadPool;
   arr_t(Shape*) overlaps;
+  arr_t(ContactEvent) events;
+  arr_t(ContactEvent) touching;
+  arr_t(ContactJoint) contactJoints;
+  arr_t(dJointFeedback) feedback;
+  map_t eventLookup;
+  map_t touchingLookup;
+  uint32_t colliderCount;
+  float timestep;
+  uint32_t maxSteps;
+  float accumulator;
+  float alpha;
+  bool timed;
+  WorldStats stats;
+  arr_t(Collider*) islandStack;
+  uint32_t islandStamp;
   char* tags[MAX_TAGS];
   uint16_t masks[MAX_TAGS];
   Collider* head;
@@ -27,6 +52,11 @@ struct Collider {
   arr_t(Joint*) joints;
   float friction;
   float restitution;
+  bool isStatic;
+  bool wasKinematic;
+  float lastPosition[4];
+  float lastOrientation[4];
+  uint32_t islandStamp;
 };
 
 struct Shape {
@@ -40,6 +70,20 @@ struct Shape {
   bool sensor;
 };
 
+// ODE keeps pointers to a convex geom's planes, points, and polygons, so they live in one block
+// after this header, which is stored in the Shape's vertices field.  The mass properties are for a
+// density of 1.
+typedef struct {
+  uint32_t faceCount;
+  uint32_t pointCount;
+  dReal* planes;
+  dReal* points;
+  unsigned* polygons;
+  float volume;
+  float center[3];
+  float inertia[6];
+} ConvexData;
+
 struct Joint {
   uint32_t ref;
   JointType type;
@@ -57,6 +101,138 @@ static void customNearCallback(void* data, dGeomID shapeA, dGeomID shapeB) {
   arr_push(&world->overlaps, dGeomGetData(shapeB));
 }
 
+// Static shapes never need to be tested against each other.  They go in a category that doesn't
+// collide with itself, so the space rejects static pairs using the category and collide bits,
+// before testing bounding boxes or calling the near callback.
+#define CATEGORY_DYNAMIC 0x1
+#define CATEGORY_STATIC 0x2
+
+static void setShapeCategory(Shape* shape, bool isStatic) {
+  dGeomSetCategoryBits(shape->id, isStatic ? CATEGORY_STATIC : CATEGORY_DYNAMIC);
+  dGeomSetCollideBits(shape->id, isStatic ? ~(unsigned long) CATEGORY_STATIC : ~0ul);
+}
+
+static uint64_t pairKey(Shape* a, Shape* b) {
+  Shape* pair[2] = { a < b ? a : b, a < b ? b : a };
+  return hash64(pair, sizeof(pair));
+}
+
+// Contact events own a reference to both of their shapes, since END events can outlive the shapes'
+// colliders.  Events from the last update that were still touching become the set that this
+// update's contacts are compared against.  Every event's key is removed from the event lookup, so
+// no index into the old event list survives into the next update.
+static void resetContactEvents(World* world) {
+  for (size_t i = 0; i < world->touching.length; i++) {
+    ContactEvent* event = &world->touching.data[i];
+    map_remove(&world->touchingLookup, pairKey(event->a, event->b));
+    lovrRelease(event->a, lovrShapeDestroy);
+    lovrRelease(event->b, lovrShapeDestroy);
+  }
+
+  arr_clear(&world->touching);
+
+  for (size_t i = 0; i < world->events.length; i++) {
+    ContactEvent* event = &world->events.data[i];
+    map_remove(&world->eventLookup, pairKey(event->a, event->b));
+    if (event->type == CONTACT_END) {
+      lovrRelease(event->a, lovrShapeDestroy);
+      lovrRelease(event->b, lovrShapeDestroy);
+    } else {
+      map_set(&world->touchingLookup, pairKey(event->a, event->b), 1);
+      arr_push(&world->touching, *event);
+    }
+  }
+
+  arr_clear(&world->events);
+  arr_clear(&world->contactJoints);
+}
+
+// Releases every event without turning any of them into END events, for when the contact history
+// no longer applies
+static void clearContactEvents(World* world) {
+  for (size_t i = 0; i < world->touching.length; i++) {
+    ContactEvent* event = &world->touching.data[i];
+    map_remove(&world->touchingLookup, pairKey(event->a, event->b));
+    lovrRelease(event->a, lovrShapeDestroy);
+    lovrRelease(event->b, lovrShapeDestroy);
+  }
+
+  for (size_t i = 0; i < world->events.length; i++) {
+    ContactEvent* event = &world->events.data[i];
+    map_remove(&world->eventLookup, pairKey(event->a, event->b));
+    lovrRelease(event->a, lovrShapeDestroy);
+    lovrRelease(event->b, lovrShapeDestroy);
+  }
+
+  arr_clear(&world->touching);
+  arr_clear(&world->events);
+  arr_clear(&world->contactJoints);
+}
+
+static void recordContactEvent(World* world, Shape* a, Shape* b, dContact* contacts, int count, dJointID* joints) {
+  uint64_t key = pairKey(a, b);
+  uint64_t index = map_get(&world->eventLookup, key);
+
+  if (index == MAP_NIL) {
+    index = world->events.length;
+    map_set(&world->eventLookup, key, index);
+    lovrRetain(a);
+    lovrRetain(b);
+    arr_push(&world->events, ((ContactEvent) {
+      .type = map_get(&world->touchingLookup, key) == MAP_NIL ? CONTACT_BEGIN : CONTACT_PERSIST,
+      .a = a,
+      .b = b,
+      .depth = -INFINITY
+    }));
+  }
+
+  // The event reports the deepest contact point
+  ContactEvent* event = &world->events.data[index];
+  for (int i = 0; i < count; i++) {
+    dContactGeom* contact = &contacts[i].geom;
+    if (contact->depth > event->depth) {
+      event->position[0] = contact->pos[0];
+      event->position[1] = contact->pos[1];
+      event->position[2] = contact->pos[2];
+      event->normal[0] = contact->normal[0];
+      event->normal[1] = contact->normal[1];
+      event->normal[2] = contact->normal[2];
+      event->depth = contact->depth;
+    }
+
+    if (joints) {
+      arr_push(&world->contactJoints, ((ContactJoint) { joints[i], index }));
+    }
+  }
+}
+
+static void accumulateImpulses(World* world, float dt) {
+  for (size_t i = 0; i < world->contactJoints.length; i++) {
+    ContactJoint* contact = &world->contactJoints.data[i];
+    dJointFeedback* feedback = &world->feedback.data[i];
+    float f1 = sqrtf(feedback->f1[0] * feedback->f1[0] + feedback->f1[1] * feedback->f1[1] + feedback->f1[2] * feedback->f1[2]);
+    float f2 = sqrtf(feedback->f2[0] * feedback->f2[0] + feedback->f2[1] * feedback->f2[1] + feedback->f2[2] * feedback->f2[2]);
+    world->events.data[contact->event].impulse += MAX(f1, f2) * dt;
+  }
+
+  arr_clear(&world->contactJoints);
+}
+
+static void finishContactEvents(World* world) {
+  for (size_t i = 0; i < world->touching.length; i++) {
+    ContactEvent* event = &world->touching.data[i];
+    if (map_get(&world->eventLookup, pairKey(event->a, event->b)) == MAP_NIL) {
+      lovrRetain(event->a);
+      lovrRetain(event->b);
+      arr_push(&world->events, ((ContactEvent) {
+        .type = CONTACT_END,
+        .a = event->a,
+        .b = event->b
+      }));
+    }
+  }
+}
+
 typedef struct {
   RaycastCallback callback;
   void* userdata;
@@ -79,6 +255,129 @@ static void raycastCallback(void* data, dGeomID a, dGeomID b) {
   }
 }
 
+static void setHit(RaycastHit* hit, Shape* shape, dContactGeom* contact) {
+  hit->shape = shape;
+  hit->position[0] = contact->pos[0];
+  hit->position[1] = contact->pos[1];
+  hit->position[2] = contact->pos[2];
+  hit->normal[0] = contact->normal[0];
+  hit->normal[1] = contact->normal[1];
+  hit->normal[2] = contact->normal[2];
+  hit->distance = contact->depth;
+}
+
+typedef struct {
+  RaycastHit* hit;
+  uint32_t mask;
+  bool any;
+  bool done;
+} RaycastQuery;
+
+static void raycastQueryCallback(void* data, dGeomID ray, dGeomID b) {
+  RaycastQuery* query = data;
+  Shape* shape = dGeomGetData(b);
+
+  if (!shape || query->done) {
+    return;
+  }
+
+  uint32_t tag = shape->collider->tag;
+  if (query->mask != ~0u && (tag == NO_TAG || !(query->mask & (1u << tag)))) {
+    return;
+  }
+
+  // For rays, the depth of a contact is its distance from the start of the ray
+  RaycastHit* hit = query->hit;
+  dContactGeom contacts[MAX_CONTACTS];
+  int count = dCollide(ray, b, MAX_CONTACTS, contacts, sizeof(dContactGeom));
+  for (int i = 0; i < count; i++) {
+    if (contacts[i].depth < hit->distance) {
+      setHit(hit, shape, &contacts[i]);
+    }
+  }
+
+  // ODE can't stop a space query early, but remaining candidates are skipped once any hit is found.
+  // For closest hits, the ray is shortened so farther shapes are rejected by the narrowphase.
+  if (hit->shape) {
+    if (query->any) {
+      query->done = true;
+    } else {
+      dGeomRaySetLength(ray, hit->distance);
+    }
+  }
+}
+
+static bool raycastQuery(World* world, dGeomID ray, RaycastQuery* query) {
+  *query->hit = (RaycastHit) { .distance = INFINITY };
+  dGeomRaySetFirstContact(ray, query->any);
+  dGeomRaySetClosestHit(ray, !query->any);
+  dSpaceCollide2(ray, (dGeomID) world->space, query, raycastQueryCallback);
+  return query->hit->shape;
+}
+
+static void deepestHitCallback(void* data, dGeomID a, dGeomID b) {
+  RaycastHit* hit = data;
+  Shape* shape = dGeomGetData(b);
+
+  if (!shape) {
+    return;
+  }
+
+  dContactGeom contacts[MAX_CONTACTS];
+  int count = dCollide(a, b, MAX_CONTACTS, contacts, sizeof(dContactGeom));
+  for (int i = 0; i < count; i++) {
+    if (!hit->shape || contacts[i].depth > hit->distance) {
+      setHit(hit, shape, &contacts[i]);
+    }
+  }
+}
+
+static bool overlapsAt(World* world, dGeomID geom, float* start, float* delta, float t, RaycastHit* hit) {
+  dGeomSetPosition(geom, start[0] + delta[0] * t, start[1] + delta[1] * t, start[2] + delta[2] * t);
+  hit->shape = NULL;
+  dSpaceCollide2(geom, (dGeomID) world->space, hit, deepestHitCallback);
+  return hit->shape;
+}
+
+// ODE has no swept collision, so the geom is moved along the path in steps smaller than itself until
+// it touches something, then the time of impact is refined with a binary search.
+static bool sweep(World* world, dGeomID geom, float step, float* start, float* end, RaycastHit* hit) {
+  float delta[3] = { end[0] - start[0], end[1] - start[1], end[2] - start[2] };
+  float length = sqrtf(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+  uint32_t steps = (uint32_t) ceilf(length / step);
+
+  float lo = 0.f;
+  float hi = -1.f;
+  for (uint32_t i = 0; i <= steps; i++) {
+    float t = steps > 0 ? (float) i / steps : 0.f;
+    if (overlapsAt(world, geom, start, delta, t, hit)) {
+      hi = t;
+      break;
+    }
+    lo = t;
+  }
+
+  if (hi < 0.f) {
+    return false;
+  }
+
+  if (hi > 0.f) {
+    for (uint32_t i = 0; i < 12; i++) {
+      float t = (lo + hi) * .5f;
+      if (overlapsAt(world, geom, start, delta, t, hit)) {
+        hi = t;
+      } else {
+        lo = t;
+      }
+    }
+
+    overlapsAt(world, geom, start, delta, hi, hit);
+  }
+
+  hit->distance = hi * length;
+  return true;
+}
+
 // XXX slow, but probably fine (tag names are not on any critical path), could switch to hashing if needed
 static uint32_t findTag(World* world, const char* name) {
   for (uint32_t i = 0; i < MAX_TAGS && world->tags[i]; i++) {
@@ -124,21 +423,63 @@ void lovrPhysicsDestroy() {
   initialized = false;
 }
 
-World* lovrWorldCreate(float xg, float yg, float zg, bool allowSleep, const char** tags, uint32_t tagCount) {
+World* lovrWorldCreate(WorldInfo* info) {
   World* world = calloc(1, sizeof(World));
   lovrAssert(world, "Out of memory");
   world->ref = 1;
   world->id = dWorldCreate();
-  world->space = dHashSpaceCreate(0);
-  dHashSpaceSetLevels(world->space, -4, 8);
+
+  switch (info->broadphase) {
+    case BROADPHASE_HASH:
+      world->space = dHashSpaceCreate(0);
+      dHashSpaceSetLevels(world->space, -4, 8);
+      break;
+    case BROADPHASE_SAP:
+      world->space = dSweepAndPruneSpaceCreate(0, dSAP_AXES_XZY);
+      break;
+    case BROADPHASE_QUADTREE: {
+      lovrCheck(info->depth > 0, "Quadtree depth must be positive");
+      dVector3 center = { info->center[0], info->center[1], info->center[2] };
+      dVector3 extents = { info->extents[0], info->extents[1], info->extents[2] };
+      world->space = dQuadTreeSpaceCreate(0, center, extents, info->depth);
+      break;
+    }
+    default: lovrUnreachable();
+  }
+
+  // Islands are solved in parallel on a thread pool.  If ODE was built without its threading
+  // implementation, the allocation fails and the World is stepped on the calling thread.
+  if (info->threadCount > 1) {
+    world->threading = dThreadingAllocateMultiThreadedImplementation();
+    if (world->threading) {
+      world->threadPool = dThreadingAllocateThreadPool(info->threadCount, 0, dAllocateFlagBasicData, NULL);
+      if (world->threadPool) {
+        dThreadingThreadPoolServeMultiThreadedImplementation(world->threadPool, world->threading);
+        dWorldSetStepIslandsProcessingMaxThreadCount(world->id, info->threadCount);
+        dWorldSetStepThreadingImplementation(world->id, dThreadingImplementationGetFunctions(world->threading), world->threading);
+      } else {
+        dThreadingFreeImplementation(world->threading);
+        world->threading = NULL;
+      }
+    }
+  }
+
   world->contactGroup = dJointGroupCreate(0);
   arr_init(&world->overlaps, arr_alloc);
-  lovrWorldSetGravity(world, xg, yg, zg);
-  lovrWorldSetSleepingAllowed(world, allowSleep);
-  for (uint32_t i = 0; i < tagCount; i++) {
-    size_t size = strlen(tags[i]) + 1;
+  arr_init(&world->events, arr_alloc);
+  arr_init(&world->touching, arr_alloc);
+  arr_init(&world->contactJoints, arr_alloc);
+  arr_init(&world->feedback, arr_alloc);
+  arr_init(&world->islandStack, arr_alloc);
+  world->timed = info->stats;
+  map_init(&world->eventLookup, 0);
+  map_init(&world->touchingLookup, 0);
+  lovrWorldSetGravity(world, info->gravity[0], info->gravity[1], info->gravity[2]);
+  lovrWorldSetSleepingAllowed(world, info->allowSleep);
+  for (uint32_t i = 0; i < info->tagCount; i++) {
+    size_t size = strlen(info->tags[i]) + 1;
     world->tags[i] = malloc(size);
-    memcpy(world->tags[i], tags[i], size);
+    memcpy(world->tags[i], info->tags[i], size);
   }
   memset(world->masks, 0xff, sizeof(world->masks));
   return world;
@@ -148,6 +489,13 @@ void lovrWorldDestroy(void* ref) {
   World* world = ref;
   lovrWorldDestroyData(world);
   arr_free(&world->overlaps);
+  arr_free(&world->events);
+  arr_free(&world->touching);
+  arr_free(&world->contactJoints);
+  arr_free(&world->feedback);
+  arr_free(&world->islandStack);
+  map_free(&world->eventLookup);
+  map_free(&world->touchingLookup);
   for (uint32_t i = 0; i < MAX_TAGS && world->tags[i]; i++) {
     free(world->tags[i]);
   }
@@ -155,6 +503,8 @@ void lovrWorldDestroy(void* ref) {
 }
 
 void lovrWorldDestroyData(World* world) {
+  clearContactEvents(world);
+
   while (world->head) {
     Collider* next = world->head->next;
     lovrColliderDestroyData(world->head);
@@ -171,26 +521,157 @@ void lovrWorldDestroyData(World* world) {
     world->space = NULL;
   }
 
+  if (world->threading) {
+    dThreadingImplementationShutdownProcessing(world->threading);
+    dThreadingFreeThreadPool(world->threadPool);
+    dWorldSetStepThreadingImplementation(world->id, NULL, NULL);
+    dThreadingFreeImplementation(world->threading);
+    world->threading = NULL;
+    world->threadPool = NULL;
+  }
+
   if (world->id) {
     dWorldDestroy(world->id);
     world->id = NULL;
   }
 }
 
-void lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* userdata) {
+// Islands are the groups of awake bodies connected by joints (including contacts), which is how
+// ODE splits up the solver's work.  ODE doesn't report them, so they're counted with a flood fill.
+static void countIslands(World* world) {
+  uint32_t stamp = ++world->islandStamp;
+  world->stats.islandCount = 0;
+  world->stats.awakeCount = 0;
+
+  for (Collider* collider = world->head; collider; collider = collider->next) {
+    if (collider->islandStamp == stamp || !dBodyIsEnabled(collider->body) || dBodyIsKinematic(collider->body)) {
+      continue;
+    }
+
+    world->stats.islandCount++;
+    collider->islandStamp = stamp;
+    arr_clear(&world->islandStack);
+    arr_push(&world->islandStack, collider);
+
+    while (world->islandStack.length > 0) {
+      dBodyID body = arr_pop(&world->islandStack)->body;
+      world->stats.awakeCount++;
+
+      int jointCount = dBodyGetNumJoints(body);
+      for (int i = 0; i < jointCount; i++) {
+        dJointID joint = dBodyGetJoint(body, i);
+        for (int j = 0; j < 2; j++) {
+          dBodyID other = dJointGetBody(joint, j);
+          Collider* neighbor = other ? dBodyGetData(other) : NULL;
+          if (neighbor && neighbor->islandStamp != stamp && dBodyIsEnabled(other) && !dBodyIsKinematic(other)) {
+            neighbor->islandStamp = stamp;
+            arr_push(&world->islandStack, neighbor);
+          }
+        }
+      }
+    }
+  }
+}
+
+static void step(World* world, float dt, CollisionResolver resolver, void* userdata) {
+  bool timed = world->timed;
+  double start = timed ? os_get_time() : 0.;
+  double narrowphaseTime = world->stats.narrowphaseTime;
+
   if (resolver) {
     resolver(world, userdata);
   } else {
     dSpaceCollide(world->space, world, defaultNearCallback);
   }
 
+  // Narrowphase time is measured around each dCollide, broadphase is everything else
+  if (timed) {
+    double collisionTime = os_get_time() - start;
+    world->stats.broadphaseTime += collisionTime - (world->stats.narrowphaseTime - narrowphaseTime);
+    countIslands(world);
+  }
+
+  world->stats.stepCount++;
+
+  // Feedback is attached after collision since the array can't move once ODE has pointers into it
+  arr_clear(&world->feedback);
+  arr_expand(&world->feedback, world->contactJoints.length);
+  for (size_t i = 0; i < world->contactJoints.length; i++) {
+    world->feedback.data[i] = (dJointFeedback) { 0 };
+    dJointSetFeedback(world->contactJoints.data[i].joint, &world->feedback.data[i]);
+  }
+
   if (dt > 0) {
-    dWorldQuickStep(world->id, dt);
+    if (timed) {
+      start = os_get_time();
+      dWorldQuickStep(world->id, dt);
+      world->stats.solverTime += os_get_time() - start;
+    } else {
+      dWorldQuickStep(world->id, dt);
+    }
   }
 
+  accumulateImpulses(world, dt);
   dJointGroupEmpty(world->contactGroup);
 }
 
+uint32_t lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* userdata) {
+  memset(&world->stats, 0, sizeof(world->stats));
+
+  if (world->timestep <= 0.f) {
+    resetContactEvents(world);
+    step(world, dt, resolver, userdata);
+    finishContactEvents(world);
+    return 1;
+  }
+
+  world->accumulator += dt;
+  uint32_t steps = (uint32_t) (world->accumulator / world->timestep);
+
+  // Time that doesn't fit in the step limit is dropped, otherwise a slow frame makes the next frame
+  // even slower and the World never catches up
+  if (steps > world->maxSteps) {
+    steps = world->maxSteps;
+    world->accumulator = steps * world->timestep;
+  }
+
+  // Contact events cover all of the substeps.  When no step runs, the previous events are kept.
+  if (steps > 0) {
+    resetContactEvents(world);
+
+    for (uint32_t i = 0; i < steps; i++) {
+      for (Collider* collider = world->head; collider; collider = collider->next) {
+        lovrColliderGetPosition(collider, &collider->lastPosition[0], &collider->lastPosition[1], &collider->lastPosition[2]);
+        lovrColliderGetOrientation(collider, collider->lastOrientation);
+      }
+
+      step(world, world->timestep, resolver, userdata);
+      world->accumulator -= world->timestep;
+    }
+
+    finishContactEvents(world);
+  }
+
+  world->alpha = MAX(world->accumulator, 0.f) / world->timestep;
+  return steps;
+}
+
+void lovrWorldGetStats(World* world, WorldStats* stats) {
+  *stats = world->stats;
+}
+
+float lovrWorldGetTimestep(World* world, uint32_t* maxSteps) {
+  *maxSteps = world->maxSteps;
+  return world->timestep;
+}
+
+void lovrWorldSetTimestep(World* world, float timestep, uint32_t maxSteps) {
+  world->timestep = timestep;
+  world->maxSteps = maxSteps;
+  world->accumulator = 0.f;
+  world->alpha = 1.f;
+}
+
 int lovrWorldGetStepCount(World* world) {
   return dWorldGetQuickStepNumIterations(world->id);
 }
@@ -248,13 +729,30 @@ int lovrWorldCollide(World* world, Shape* a, Shape* b, float friction, float res
     }
   }
 
-  int contactCount = dCollide(a->id, b->id, MAX_CONTACTS, &contacts[0].geom, sizeof(dContact));
+  int contactCount;
+  if (world->timed) {
+    double start = os_get_time();
+    contactCount = dCollide(a->id, b->id, MAX_CONTACTS, &contacts[0].geom, sizeof(dContact));
+    world->stats.narrowphaseTime += os_get_time() - start;
+  } else {
+    contactCount = dCollide(a->id, b->id, MAX_CONTACTS, &contacts[0].geom, sizeof(dContact));
+  }
+  world->stats.pairCount++;
+
+  if (contactCount == 0) {
+    return 0;
+  }
 
   if (!a->sensor && !b->sensor) {
+    dJointID joints[MAX_CONTACTS];
     for (int c = 0; c < contactCount; c++) {
-      dJointID joint = dJointCreateContact(world->id, world->contactGroup, &contacts[c]);
-      dJointAttach(joint, colliderA->body, colliderB->body);
+      joints[c] = dJointCreateContact(world->id, world->contactGroup, &contacts[c]);
+      dJointAttach(joints[c], colliderA->body, colliderB->body);
     }
+    recordContactEvent(world, a, b, contacts, contactCount, joints);
+    world->stats.contactCount += contactCount;
+  } else {
+    recordContactEvent(world, a, b, contacts, contactCount, NULL);
   }
 
   return contactCount;
@@ -288,10 +786,258 @@ void lovrWorldRaycast(World* world, float x1, float y1, float z1, float x2, floa
   dGeomDestroy(ray);
 }
 
+bool lovrWorldRaycastFirst(World* world, float start[3], float end[3], uint32_t mask, bool any, RaycastHit* hit) {
+  float dx = end[0] - start[0];
+  float dy = end[1] - start[1];
+  float dz = end[2] - start[2];
+  float length = sqrtf(dx * dx + dy * dy + dz * dz);
+
+  if (length == 0.f) {
+    return false;
+  }
+
+  dGeomID ray = dCreateRay(0, length);
+  dGeomRaySet(ray, start[0], start[1], start[2], dx, dy, dz);
+  RaycastQuery query = { .hit = hit, .mask = mask, .any = any };
+  bool result = raycastQuery(world, ray, &query);
+  dGeomDestroy(ray);
+  return result;
+}
+
+uint32_t lovrWorldRaycastBatch(World* world, const float* rays, uint32_t count, uint32_t mask, RaycastHit* hits) {
+  uint32_t hitCount = 0;
+  dGeomID ray = dCreateRay(0, 1.f);
+
+  for (uint32_t i = 0; i < count; i++, rays += 6) {
+    float dx = rays[3] - rays[0];
+    float dy = rays[4] - rays[1];
+    float dz = rays[5] - rays[2];
+    float length = sqrtf(dx * dx + dy * dy + dz * dz);
+
+    if (length == 0.f) {
+      hits[i] = (RaycastHit) { .distance = INFINITY };
+      continue;
+    }
+
+    dGeomRaySetLength(ray, length);
+    dGeomRaySet(ray, rays[0], rays[1], rays[2], dx, dy, dz);
+    RaycastQuery query = { .hit = &hits[i], .mask = mask };
+    hitCount += raycastQuery(world, ray, &query);
+  }
+
+  dGeomDestroy(ray);
+  return hitCount;
+}
+
+bool lovrWorldSpherecast(World* world, float radius, float start[3], float end[3], RaycastHit* hit) {
+  lovrCheck(radius > 0.f, "Sphere radius must be positive");
+  dGeomID sphere = dCreateSphere(0, radius);
+  bool result = sweep(world, sphere, radius, start, end, hit);
+  dGeomDestroy(sphere);
+  return result;
+}
+
+bool lovrWorldBoxcast(World* world, float size[3], float orientation[4], float start[3], float end[3], RaycastHit* hit) {
+  lovrCheck(size[0] > 0.f && size[1] > 0.f && size[2] > 0.f, "Box dimensions must be positive");
+  dGeomID box = dCreateBox(0, size[0], size[1], size[2]);
+  dReal q[4] = { orientation[3], orientation[0], orientation[1], orientation[2] };
+  dGeomSetQuaternion(box, q);
+  float step = MIN(MIN(size[0], size[1]), size[2]) * .5f;
+  bool result = sweep(world, box, step, start, end, hit);
+  dGeomDestroy(box);
+  return result;
+}
+
+ContactEvent* lovrWorldGetContactEvents(World* world, uint32_t* count) {
+  *count = world->events.length;
+  return world->events.data;
+}
+
 Collider* lovrWorldGetFirstCollider(World* world) {
   return world->head;
 }
 
+uint32_t lovrWorldGetColliderCount(World* world) {
+  return world->colliderCount;
+}
+
+// If colliders is NULL, the World's colliders are used in list order (newest first).  Vectors are
+// 8 floats per collider (position with w = 1, then the orientation quaternion), matrices are 16.
+void lovrWorldGetPoses(World* world, Collider** colliders, uint32_t count, PoseLayout layout, bool interpolate, float* poses) {
+  Collider* collider = world->head;
+  for (uint32_t i = 0; i < count; i++) {
+    Collider* c = colliders ? colliders[i] : collider;
+    float p[4], orientation[4];
+
+    if (interpolate) {
+      lovrColliderGetInterpolatedPose(c, p, orientation);
+    } else {
+      lovrColliderGetPosition(c, &p[0], &p[1], &p[2]);
+      lovrColliderGetOrientation(c, orientation);
+    }
+
+    if (layout == POSE_MATRIX) {
+      mat4_fromQuat(poses, orientation);
+      poses[12] = p[0];
+      poses[13] = p[1];
+      poses[14] = p[2];
+      poses += 16;
+    } else {
+      poses[0] = p[0];
+      poses[1] = p[1];
+      poses[2] = p[2];
+      poses[3] = 1.f;
+      memcpy(poses + 4, orientation, 4 * sizeof(float));
+      poses += 8;
+    }
+
+    collider = colliders ? NULL : collider->next;
+  }
+}
+
+void lovrWorldSetPoses(World* world, Collider** colliders, uint32_t count, PoseLayout layout, const float* poses) {
+  Collider* collider = world->head;
+  for (uint32_t i = 0; i < count; i++) {
+    Collider* c = colliders ? colliders[i] : collider;
+    float orientation[4];
+
+    if (layout == POSE_MATRIX) {
+      quat_fromMat4(orientation, (float*) poses);
+      lovrColliderSetPosition(c, poses[12], poses[13], poses[14]);
+      poses += 16;
+    } else {
+      memcpy(orientation, poses + 4, 4 * sizeof(float));
+      lovrColliderSetPosition(c, poses[0], poses[1], poses[2]);
+      poses += 8;
+    }
+
+    lovrColliderSetOrientation(c, orientation);
+    collider = colliders ? NULL : collider->next;
+  }
+}
+
+// Snapshots are a header followed by one fixed size record per collider, in list order, then one
+// byte per joint attachment with its enabled flag.  Body state is stored as dReal, but restores are
+// not bit-exact: ODE renormalizes quaternions when they're set, and it has no way to set the
+// auto-disable timers, which restart when a body is enabled.
+
+#define SNAPSHOT_MAGIC 0x57525653 // SVRW
+#define SNAPSHOT_VERSION 1
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t realSize;
+  uint32_t colliderCount;
+  uint32_t jointCount;
+  float accumulator;
+  float alpha;
+  uint32_t padding;
+} SnapshotHeader;
+
+typedef struct {
+  dReal position[3];
+  dReal orientation[4];
+  dReal linearVelocity[3];
+  dReal angularVelocity[3];
+  dReal force[3];
+  dReal torque[3];
+  float lastPosition[3];
+  float lastOrientation[4];
+  uint32_t awake;
+} SnapshotCollider;
+
+static uint32_t countJoints(World* world) {
+  uint32_t count = 0;
+  for (Collider* collider = world->head; collider; collider = collider->next) {
+    count += collider->joints.length;
+  }
+  return count;
+}
+
+size_t lovrWorldGetSnapshotSize(World* world) {
+  return sizeof(SnapshotHeader) + world->colliderCount * sizeof(SnapshotCollider) + countJoints(world);
+}
+
+void lovrWorldSaveSnapshot(World* world, void* data) {
+  SnapshotHeader* header = data;
+  header->magic = SNAPSHOT_MAGIC;
+  header->version = SNAPSHOT_VERSION;
+  header->realSize = sizeof(dReal);
+  header->colliderCount = world->colliderCount;
+  header->jointCount = countJoints(world);
+  header->accumulator = world->accumulator;
+  header->alpha = world->alpha;
+  header->padding = 0;
+
+  SnapshotCollider* record = (SnapshotCollider*) (header + 1);
+  for (Collider* collider = world->head; collider; collider = collider->next, record++) {
+    dBodyID body = collider->body;
+    memcpy(record->position, dBodyGetPosition(body), 3 * sizeof(dReal));
+    memcpy(record->orientation, dBodyGetQuaternion(body), 4 * sizeof(dReal));
+    memcpy(record->linearVelocity, dBodyGetLinearVel(body), 3 * sizeof(dReal));
+    memcpy(record->angularVelocity, dBodyGetAngularVel(body), 3 * sizeof(dReal));
+    memcpy(record->force, dBodyGetForce(body), 3 * sizeof(dReal));
+    memcpy(record->torque, dBodyGetTorque(body), 3 * sizeof(dReal));
+    memcpy(record->lastPosition, collider->lastPosition, 3 * sizeof(float));
+    memcpy(record->lastOrientation, collider->lastOrientation, 4 * sizeof(float));
+    record->awake = dBodyIsEnabled(body);
+  }
+
+  uint8_t* joints = (uint8_t*) record;
+  for (Collider* collider = world->head; collider; collider = collider->next) {
+    for (size_t i = 0; i < collider->joints.length; i++) {
+      *joints++ = dJointIsEnabled(collider->joints.data[i]->id);
+    }
+  }
+}
+
+void lovrWorldLoadSnapshot(World* world, const void* data, size_t size) {
+  const SnapshotHeader* header = data;
+  lovrCheck(size >= sizeof(SnapshotHeader) && header->magic == SNAPSHOT_MAGIC, "Invalid World snapshot");
+  lovrCheck(header->version == SNAPSHOT_VERSION, "World snapshot version %d is not supported", header->version);
+  lovrCheck(header->realSize == sizeof(dReal), "World snapshot was saved with a different physics precision");
+  lovrCheck(header->colliderCount == world->colliderCount, "World snapshot has %d colliders, but the World has %d", header->colliderCount, world->colliderCount);
+  lovrCheck(header->jointCount == countJoints(world), "World snapshot has different joints than the World");
+  lovrCheck(size >= lovrWorldGetSnapshotSize(world), "World snapshot is truncated");
+
+  world->accumulator = header->accumulator;
+  world->alpha = header->alpha;
+
+  const SnapshotCollider* record = (const SnapshotCollider*) (header + 1);
+  for (Collider* collider = world->head; collider; collider = collider->next, record++) {
+    dBodyID body = collider->body;
+    dBodySetPosition(body, record->position[0], record->position[1], record->position[2]);
+    dBodySetQuaternion(body, record->orientation);
+    dBodySetLinearVel(body, record->linearVelocity[0], record->linearVelocity[1], record->linearVelocity[2]);
+    dBodySetAngularVel(body, record->angularVelocity[0], record->angularVelocity[1], record->angularVelocity[2]);
+    dBodySetForce(body, record->force[0], record->force[1], record->force[2]);
+    dBodySetTorque(body, record->torque[0], record->torque[1], record->torque[2]);
+    memcpy(collider->lastPosition, record->lastPosition, 3 * sizeof(float));
+    memcpy(collider->lastOrientation, record->lastOrientation, 4 * sizeof(float));
+
+    if (record->awake) {
+      dBodyEnable(body);
+    } else {
+      dBodyDisable(body);
+    }
+  }
+
+  const uint8_t* joints = (const uint8_t*) record;
+  for (Collider* collider = world->head; collider; collider = collider->next) {
+    for (size_t i = 0; i < collider->joints.length; i++) {
+      if (*joints++) {
+        dJointEnable(collider->joints.data[i]->id);
+      } else {
+        dJointDisable(collider->joints.data[i]->id);
+      }
+    }
+  }
+
+  // Contacts from the timeline being discarded don't apply anymore, they'll begin again next step
+  clearContactEvents(world);
+}
+
 void lovrWorldGetGravity(World* world, float* x, float* y, float* z) {
   dReal gravity[4];
   dWorldGetGravity(world->id, gravity);
@@ -352,6 +1098,10 @@ const char* lovrWorldGetTagName(World* world, uint32_t tag) {
   return (tag == NO_TAG) ? NULL : world->tags[tag];
 }
 
+uint32_t lovrWorldGetTag(World* world, const char* name) {
+  return findTag(world, name);
+}
+
 int lovrWorldDisableCollisionBetween(World* world, const char* tag1, const char* tag2) {
   uint32_t i = findTag(world, tag1);
   uint32_t j = findTag(world, tag2);
@@ -400,6 +1150,7 @@ Collider* lovrColliderCreate(World* world, float x, float y, float z) {
   arr_init(&collider->joints, arr_alloc);
 
   lovrColliderSetPosition(collider, x, y, z);
+  quat_identity(collider->lastOrientation);
 
   // Adjust the world's collider list
   if (!collider->world->head) {
@@ -410,6 +1161,8 @@ Collider* lovrColliderCreate(World* world, float x, float y, float z) {
     collider->world->head = collider;
   }
 
+  world->colliderCount++;
+
   // The world owns a reference to the collider
   lovrRetain(collider);
   return collider;
@@ -446,6 +1199,7 @@ void lovrColliderDestroyData(Collider* collider) {
   if (collider->next) collider->next->prev = collider->prev;
   if (collider->prev) collider->prev->next = collider->next;
   if (collider->world->head == collider) collider->world->head = collider->next;
+  collider->world->colliderCount--;
   collider->next = collider->prev = NULL;
 
   // If the Collider is destroyed, the world lets go of its reference to this Collider
@@ -456,6 +1210,27 @@ void lovrColliderInitInertia(Collider* collider, Shape* shape) {
   // compute inertia matrix for default density
   const float density = 1.0f;
   float cx, cy, cz, mass, inertia[6];
+
+  // Without a shape, the mass of all the shapes is combined (e.g. for convex decompositions)
+  if (!shape) {
+    dMass total, m;
+    dMassSetZero(&total);
+    for (size_t i = 0; i < collider->shapes.length; i++) {
+      lovrShapeGetMass(collider->shapes.data[i], density, &cx, &cy, &cz, &mass, inertia);
+      if (mass > 0.f) {
+        dMassSetParameters(&m, mass, cx, cy, cz, inertia[0], inertia[1], inertia[2], inertia[3], inertia[4], inertia[5]);
+        dMassAdd(&total, &m);
+      }
+    }
+
+    if (total.mass > 0.) {
+      float combined[6] = { total.I[0], total.I[5], total.I[10], total.I[4], total.I[8], total.I[9] };
+      lovrColliderSetMassData(collider, total.c[0], total.c[1], total.c[2], total.mass, combined);
+    }
+
+    return;
+  }
+
   lovrShapeGetMass(shape, density, &cx, &cy, &cz, &mass, inertia);
   lovrColliderSetMassData(collider, cx, cy, cz, mass, inertia);
 }
@@ -477,13 +1252,13 @@ void lovrColliderAddShape(Collider* collider, Shape* shape) {
 
   shape->collider = collider;
   dGeomSetBody(shape->id, collider->body);
-  dSpaceID newSpace = collider->world->space;
-  dSpaceAdd(newSpace, shape->id);
+  setShapeCategory(shape, collider->isStatic);
+  dSpaceAdd(collider->world->space, shape->id);
 }
 
 void lovrColliderRemoveShape(Collider* collider, Shape* shape) {
   if (shape->collider == collider) {
-    dSpaceRemove(collider->world->space, shape->id);
+    dSpaceRemove(dGeomGetSpace(shape->id), shape->id);
     dGeomSetBody(shape->id, 0);
     shape->collider = NULL;
     lovrRelease(shape, lovrShapeDestroy);
@@ -558,6 +1333,12 @@ bool lovrColliderIsKinematic(Collider* collider) {
 }
 
 void lovrColliderSetKinematic(Collider* collider, bool kinematic) {
+  if (collider->isStatic) {
+    lovrCheck(kinematic, "Static colliders are always kinematic (make it non-static first)");
+    collider->wasKinematic = true;
+    return;
+  }
+
   if (kinematic) {
     dBodySetKinematic(collider->body);
   } else {
@@ -565,6 +1346,33 @@ void lovrColliderSetKinematic(Collider* collider, bool kinematic) {
   }
 }
 
+bool lovrColliderIsStatic(Collider* collider) {
+  return collider->isStatic;
+}
+
+void lovrColliderSetStatic(Collider* collider, bool isStatic) {
+  if (collider->isStatic == isStatic) {
+    return;
+  }
+
+  // Static colliders are kinematic, the collider goes back to its old mode when it stops being static
+  if (isStatic) {
+    collider->wasKinematic = lovrColliderIsKinematic(collider);
+    lovrColliderSetKinematic(collider, true);
+    collider->isStatic = true;
+  } else {
+    collider->isStatic = false;
+    lovrColliderSetKinematic(collider, collider->wasKinematic);
+  }
+
+  for (dGeomID geom = dBodyGetFirstGeom(collider->body); geom; geom = dBodyGetNextGeom(geom)) {
+    Shape* shape = dGeomGetData(geom);
+    if (shape) {
+      setShapeCategory(shape, isStatic);
+    }
+  }
+}
+
 bool lovrColliderIsGravityIgnored(Collider* collider) {
   return !dBodyGetGravityMode(collider->body);
 }
@@ -639,8 +1447,11 @@ void lovrColliderGetPosition(Collider* collider, float* x, float* y, float* z) {
   *z = position[2];
 }
 
+// Moving a collider directly also moves its interpolation start, so a teleport doesn't get smeared
+// across the next step
 void lovrColliderSetPosition(Collider* collider, float x, float y, float z) {
   dBodySetPosition(collider->body, x, y, z);
+  vec3_set(collider->lastPosition, x, y, z);
 }
 
 void lovrColliderGetOrientation(Collider* collider, quat orientation) {
@@ -651,6 +1462,25 @@ void lovrColliderGetOrientation(Collider* collider, quat orientation) {
 void lovrColliderSetOrientation(Collider* collider, quat orientation) {
   dReal q[4] = { orientation[3], orientation[0], orientation[1], orientation[2] };
   dBodySetQuaternion(collider->body, q);
+  quat_init(collider->lastOrientation, orientation);
+}
+
+// Blends between the pose before the last fixed step and the current pose, using the fraction of a
+// step left over in the World's accumulator.  Without a fixed timestep, this is the current pose.
+void lovrColliderGetInterpolatedPose(Collider* collider, float* position, float* orientation) {
+  lovrColliderGetPosition(collider, &position[0], &position[1], &position[2]);
+  lovrColliderGetOrientation(collider, orientation);
+
+  World* world = collider->world;
+  if (world->timestep > 0.f && world->alpha < 1.f) {
+    float current[4] = { position[0], position[1], position[2] };
+    vec3_init(position, collider->lastPosition);
+    vec3_lerp(position, current, world->alpha);
+    float last[4];
+    quat_init(last, collider->lastOrientation);
+    quat_slerp(last, orientation, world->alpha);
+    quat_init(orientation, last);
+  }
 }
 
 void lovrColliderGetLinearVelocity(Collider* collider, float* x, float* y, float* z) {
@@ -804,6 +1634,12 @@ void lovrShapeDestroyData(Shape* shape) {
     }
     dGeomDestroy(shape->id);
     shape->id = NULL;
+
+    // The convex geom points into this block, so it's freed after the geom is gone
+    if (shape->type == SHAPE_CONVEX) {
+      free(shape->vertices);
+      shape->vertices = NULL;
+    }
   }
 }
 
@@ -902,6 +1738,14 @@ void lovrShapeGetMass(Shape* shape, float density, float* cx, float* cy, float*
       break;
     }
 
+    case SHAPE_CONVEX: {
+      ConvexData* data = shape->vertices;
+      float* I = data->inertia;
+      dMassSetParameters(&m, data->volume * density, data->center[0], data->center[1], data->center[2],
+        I[0] * density, I[1] * density, I[2] * density, I[3] * density, I[4] * density, I[5] * density);
+      break;
+    }
+
     case SHAPE_TERRAIN: {
       break;
     }
@@ -1070,6 +1914,230 @@ TerrainShape* lovrTerrainShapeCreate(float* vertices, uint32_t widthSamples, uin
   return terrain;
 }
 
+// Mass properties of a closed triangle mesh with uniform density (Eberly, "Polyhedral Mass
+// Properties").  Like ODE's dMass, the inertia tensor is relative to the origin, not the center.
+static void convexMass(const float* points, const uint32_t* triangles, uint32_t triangleCount, float* volume, float center[3], float inertia[6]) {
+  static const double scale[10] = { 1. / 6., 1. / 24., 1. / 24., 1. / 24., 1. / 60., 1. / 60., 1. / 60., 1. / 120., 1. / 120., 1. / 120. };
+  double integral[10] = { 0. };
+
+  for (uint32_t i = 0; i < triangleCount; i++) {
+    const float* p[3];
+    for (uint32_t j = 0; j < 3; j++) {
+      p[j] = points + 3 * triangles[3 * i + j];
+    }
+
+    double f1[3], f2[3], f3[3], g0[3], g1[3], g2[3];
+    for (uint32_t k = 0; k < 3; k++) {
+      double w0 = p[0][k], w1 = p[1][k], w2 = p[2][k];
+      double t0 = w0 + w1;
+      double t1 = w0 * w0;
+      double t2 = t1 + w1 * t0;
+      f1[k] = t0 + w2;
+      f2[k] = t2 + w2 * f1[k];
+      f3[k] = w0 * t1 + w1 * t2 + w2 * f2[k];
+      g0[k] = f2[k] + w0 * (f1[k] + w0);
+      g1[k] = f2[k] + w1 * (f1[k] + w1);
+      g2[k] = f2[k] + w2 * (f1[k] + w2);
+    }
+
+    double e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+    double e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+    double d[3] = {
+      e1[1] * e2[2] - e1[2] * e2[1],
+      e1[2] * e2[0] - e1[0] * e2[2],
+      e1[0] * e2[1] - e1[1] * e2[0]
+    };
+
+    integral[0] += d[0] * f1[0];
+    integral[1] += d[0] * f2[0];
+    integral[2] += d[1] * f2[1];
+    integral[3] += d[2] * f2[2];
+    integral[4] += d[0] * f3[0];
+    integral[5] += d[1] * f3[1];
+    integral[6] += d[2] * f3[2];
+    integral[7] += d[0] * (p[0][1] * g0[0] + p[1][1] * g1[0] + p[2][1] * g2[0]);
+    integral[8] += d[1] * (p[0][2] * g0[1] + p[1][2] * g1[1] + p[2][2] * g2[1]);
+    integral[9] += d[2] * (p[0][0] * g0[2] + p[1][0] * g1[2] + p[2][0] * g2[2]);
+  }
+
+  for (uint32_t i = 0; i < 10; i++) {
+    integral[i] *= scale[i];
+  }
+
+  double m = integral[0];
+  double c[3] = { integral[1] / m, integral[2] / m, integral[3] / m };
+  *volume = m;
+  center[0] = c[0];
+  center[1] = c[1];
+  center[2] = c[2];
+  inertia[0] = integral[5] + integral[6];
+  inertia[1] = integral[4] + integral[6];
+  inertia[2] = integral[4] + integral[5];
+  inertia[3] = -integral[7];
+  inertia[4] = -integral[9];
+  inertia[5] = -integral[8];
+}
+
+// Returns NULL if the points don't enclose any volume
+static ConvexShape* convexShapeCreate(const float* points, uint32_t count) {
+  uint32_t* triangles = malloc(6 * count * sizeof(uint32_t));
+  uint32_t* remap = malloc(count * sizeof(uint32_t));
+  lovrAssert(triangles && remap, "Out of memory");
+
+  uint32_t triangleCount = mesh_convex_hull(triangles, points, 3 * sizeof(float), count);
+
+  if (triangleCount == 0) {
+    free(triangles);
+    free(remap);
+    return NULL;
+  }
+
+  // Only the points on the hull are kept
+  uint32_t pointCount = 0;
+  memset(remap, 0xff, count * sizeof(uint32_t));
+  for (uint32_t i = 0; i < 3 * triangleCount; i++) {
+    uint32_t index = triangles[i];
+    if (remap[index] == ~0u) {
+      remap[index] = pointCount++;
+    }
+  }
+
+  size_t planesOffset = ALIGN(sizeof(ConvexData), sizeof(dReal));
+  size_t pointsOffset = planesOffset + 4 * triangleCount * sizeof(dReal);
+  size_t polygonsOffset = pointsOffset + 3 * pointCount * sizeof(dReal);
+  size_t size = polygonsOffset + 4 * triangleCount * sizeof(unsigned);
+  char* memory = malloc(size);
+  lovrAssert(memory, "Out of memory");
+
+  ConvexData* data = (ConvexData*) memory;
+  data->faceCount = triangleCount;
+  data->pointCount = pointCount;
+  data->planes = (dReal*) (memory + planesOffset);
+  data->points = (dReal*) (memory + pointsOffset);
+  data->polygons = (unsigned*) (memory + polygonsOffset);
+
+  float* hullPoints = malloc(3 * pointCount * sizeof(float));
+  lovrAssert(hullPoints, "Out of memory");
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (remap[i] != ~0u) {
+      for (uint32_t j = 0; j < 3; j++) {
+        hullPoints[3 * remap[i] + j] = points[3 * i + j];
+        data->points[3 * remap[i] + j] = points[3 * i + j];
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < 3 * triangleCount; i++) {
+    triangles[i] = remap[triangles[i]];
+  }
+
+  for (uint32_t i = 0; i < triangleCount; i++) {
+    const uint32_t* t = triangles + 3 * i;
+    float* a = hullPoints + 3 * t[0];
+    float* b = hullPoints + 3 * t[1];
+    float* c = hullPoints + 3 * t[2];
+    float u[4], v[4], n[4];
+    vec3_sub(vec3_init(u, b), a);
+    vec3_sub(vec3_init(v, c), a);
+    vec3_normalize(vec3_cross(vec3_init(n, u), v));
+    data->planes[4 * i + 0] = n[0];
+    data->planes[4 * i + 1] = n[1];
+    data->planes[4 * i + 2] = n[2];
+    data->planes[4 * i + 3] = vec3_dot(n, a);
+    data->polygons[4 * i + 0] = 3;
+    data->polygons[4 * i + 1] = t[0];
+    data->polygons[4 * i + 2] = t[1];
+    data->polygons[4 * i + 3] = t[2];
+  }
+
+  convexMass(hullPoints, triangles, triangleCount, &data->volume, data->center, data->inertia);
+
+  free(hullPoints);
+  free(triangles);
+  free(remap);
+
+  ConvexShape* convex = calloc(1, sizeof(ConvexShape));
+  lovrAssert(convex, "Out of memory");
+  convex->ref = 1;
+  convex->type = SHAPE_CONVEX;
+  convex->vertices = data;
+  convex->id = dCreateConvex(0, data->planes, data->faceCount, data->points, data->pointCount, data->polygons);
+  dGeomSetData(convex->id, convex);
+  return convex;
+}
+
+ConvexShape* lovrConvexShapeCreate(float* points, uint32_t count) {
+  ConvexShape* convex = convexShapeCreate(points, count);
+  lovrCheck(convex, "ConvexShape points must not all lie on the same plane");
+  return convex;
+}
+
+uint32_t lovrConvexShapeGetPointCount(ConvexShape* convex) {
+  ConvexData* data = convex->vertices;
+  return data->pointCount;
+}
+
+void lovrConvexShapeGetPoint(ConvexShape* convex, uint32_t index, float point[3]) {
+  ConvexData* data = convex->vertices;
+  lovrCheck(index < data->pointCount, "Invalid ConvexShape point index %d", index + 1);
+  point[0] = data->points[3 * index + 0];
+  point[1] = data->points[3 * index + 1];
+  point[2] = data->points[3 * index + 2];
+}
+
+uint32_t lovrConvexShapeGetFaceCount(ConvexShape* convex) {
+  ConvexData* data = convex->vertices;
+  return data->faceCount;
+}
+
+uint32_t lovrConvexShapeDecompose(float* vertices, uint32_t vertexCount, uint32_t* indices, uint32_t indexCount, uint32_t maxShapes, float concavity, ConvexShape** shapes) {
+  uint32_t triangleCount = indexCount / 3;
+
+  if (triangleCount == 0) {
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < 3 * triangleCount; i++) {
+    lovrCheck(indices[i] < vertexCount, "Invalid vertex index %d (expected [%d, %d])", indices[i] + 1, 1, vertexCount);
+  }
+
+  uint32_t* parts = malloc(triangleCount * sizeof(uint32_t));
+  float* points = malloc(9 * triangleCount * sizeof(float));
+  lovrAssert(parts && points, "Out of memory");
+
+  uint32_t partCount = mesh_decompose_convex(parts, indices, indexCount, vertices, 3 * sizeof(float), vertexCount, maxShapes, concavity);
+
+  if (partCount == 0) {
+    free(parts);
+    free(points);
+    lovrThrow("Out of memory");
+  }
+
+  // Parts that turn out to be flat are skipped, they don't have any volume to collide with
+  uint32_t shapeCount = 0;
+  for (uint32_t i = 0; i < partCount; i++) {
+    uint32_t pointCount = 0;
+    for (uint32_t j = 0; j < triangleCount; j++) {
+      if (parts[j] == i) {
+        for (uint32_t k = 0; k < 3; k++) {
+          memcpy(points + 3 * pointCount++, vertices + 3 * indices[3 * j + k], 3 * sizeof(float));
+        }
+      }
+    }
+
+    ConvexShape* convex = convexShapeCreate(points, pointCount);
+
+    if (convex) {
+      shapes[shapeCount++] = convex;
+    }
+  }
+
+  free(parts);
+  free(points);
+  return shapeCount;
+}
+
 void lovrJointDestroy(void* ref) {
   Joint* joint = ref;
   lovrJointDestroyData(joint);
@@ -7,6 +7,7 @@
 #define MAX_CONTACTS 10
 #define MAX_TAGS 16
 #define NO_TAG ~0u
+#define MAX_THREADS 64
 
 typedef struct World World;
 typedef struct Collider Collider;
@@ -19,6 +20,7 @@ typedef Shape CapsuleShape;
 typedef Shape CylinderShape;
 typedef Shape MeshShape;
 typedef Shape TerrainShape;
+typedef Shape ConvexShape;
 
 typedef Joint BallJoint;
 typedef Joint DistanceJoint;
@@ -39,18 +41,93 @@ typedef struct {
   float depth;
 } Contact;
 
-World* lovrWorldCreate(float xg, float yg, float zg, bool allowSleep, const char** tags, uint32_t tagCount);
+typedef enum {
+  CONTACT_BEGIN,
+  CONTACT_PERSIST,
+  CONTACT_END
+} ContactEventType;
+
+typedef struct {
+  ContactEventType type;
+  Shape* a;
+  Shape* b;
+  float position[3];
+  float normal[3];
+  float depth;
+  float impulse;
+} ContactEvent;
+
+typedef struct {
+  Shape* shape;
+  float position[3];
+  float normal[3];
+  float distance;
+} RaycastHit;
+
+typedef enum {
+  POSE_VECTORS,
+  POSE_MATRIX
+} PoseLayout;
+
+typedef enum {
+  BROADPHASE_HASH,
+  BROADPHASE_SAP,
+  BROADPHASE_QUADTREE
+} BroadphaseType;
+
+typedef struct {
+  float gravity[3];
+  bool allowSleep;
+  const char** tags;
+  uint32_t tagCount;
+  BroadphaseType broadphase;
+  float center[3];
+  float extents[3];
+  uint32_t depth;
+  uint32_t threadCount;
+  bool stats;
+} WorldInfo;
+
+// Totals for all the steps taken by the last update (times are in seconds).  Islands and awake
+// bodies are from the last step.  Times, islands, and awake bodies are only measured for Worlds
+// created with the stats flag, since they aren't free.
+typedef struct {
+  double broadphaseTime;
+  double narrowphaseTime;
+  double solverTime;
+  uint32_t stepCount;
+  uint32_t pairCount;
+  uint32_t contactCount;
+  uint32_t islandCount;
+  uint32_t awakeCount;
+} WorldStats;
+
+World* lovrWorldCreate(WorldInfo* info);
 void lovrWorldDestroy(void* ref);
 void lovrWorldDestroyData(World* world);
-void lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* userdata);
+uint32_t lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* userdata);
+float lovrWorldGetTimestep(World* world, uint32_t* maxSteps);
+void lovrWorldSetTimestep(World* world, float timestep, uint32_t maxSteps);
+void lovrWorldGetStats(World* world, WorldStats* stats);
 int lovrWorldGetStepCount(World* world);
 void lovrWorldSetStepCount(World* world, int iterations);
 void lovrWorldComputeOverlaps(World* world);
 int lovrWorldGetNextOverlap(World* world, Shape** a, Shape** b);
+ContactEvent* lovrWorldGetContactEvents(World* world, uint32_t* count);
 int lovrWorldCollide(World* world, Shape* a, Shape* b, float friction, float restitution);
 void lovrWorldGetContacts(World* world, Shape* a, Shape* b, Contact contacts[MAX_CONTACTS], uint32_t* count);
 void lovrWorldRaycast(World* world, float x1, float y1, float z1, float x2, float y2, float z2, RaycastCallback callback, void* userdata);
+bool lovrWorldRaycastFirst(World* world, float start[3], float end[3], uint32_t mask, bool any, RaycastHit* hit);
+uint32_t lovrWorldRaycastBatch(World* world, const float* rays, uint32_t count, uint32_t mask, RaycastHit* hits);
+bool lovrWorldSpherecast(World* world, float radius, float start[3], float end[3], RaycastHit* hit);
+bool lovrWorldBoxcast(World* world, float size[3], float orientation[4], float start[3], float end[3], RaycastHit* hit);
 Collider* lovrWorldGetFirstCollider(World* world);
+uint32_t lovrWorldGetColliderCount(World* world);
+void lovrWorldGetPoses(World* world, Collider** colliders, uint32_t count, PoseLayout layout, bool interpolate, float* poses);
+void lovrWorldSetPoses(World* world, Collider** colliders, uint32_t count, PoseLayout layout, const float* poses);
+size_t lovrWorldGetSnapshotSize(World* world);
+void lovrWorldSaveSnapshot(World* world, void* data);
+void lovrWorldLoadSnapshot(World* world, const void* data, size_t size);
 void lovrWorldGetGravity(World* world, float* x, float* y, float* z);
 void lovrWorldSetGravity(World* world, float x, float y, float z);
 float lovrWorldGetResponseTime(World* world);
@@ -64,6 +141,7 @@ void lovrWorldSetAngularDamping(World* world, float damping, float threshold);
 bool lovrWorldIsSleepingAllowed(World* world);
 void lovrWorldSetSleepingAllowed(World* world, bool allowed);
 const char* lovrWorldGetTagName(World* world, uint32_t tag);
+uint32_t lovrWorldGetTag(World* world, const char* name);
 int lovrWorldDisableCollisionBetween(World* world, const char* tag1, const char* tag2);
 int lovrWorldEnableCollisionBetween(World* world, const char* tag1, const char* tag2);
 int lovrWorldIsCollisionEnabledBetween(World* world, const char* tag1, const char* tag);
@@ -90,6 +168,8 @@ float lovrColliderGetRestitution(Collider* collider);
 void lovrColliderSetRestitution(Collider* collider, float restitution);
 bool lovrColliderIsKinematic(Collider* collider);
 void lovrColliderSetKinematic(Collider* collider, bool kinematic);
+bool lovrColliderIsStatic(Collider* collider);
+void lovrColliderSetStatic(Collider* collider, bool isStatic);
 bool lovrColliderIsGravityIgnored(Collider* collider);
 void lovrColliderSetGravityIgnored(Collider* collider, bool ignored);
 bool lovrColliderIsSleepingAllowed(Collider* collider);
@@ -104,6 +184,7 @@ void lovrColliderGetPosition(Collider* collider, float* x, float* y, float* z);
 void lovrColliderSetPosition(Collider* collider, float x, float y, float z);
 void lovrColliderGetOrientation(Collider* collider, float* orientation);
 void lovrColliderSetOrientation(Collider* collider, float* orientation);
+void lovrColliderGetInterpolatedPose(Collider* collider, float* position, float* orientation);
 void lovrColliderGetLinearVelocity(Collider* collider, float* x, float* y, float* z);
 void lovrColliderSetLinearVelocity(Collider* collider, float x, float y, float z);
 void lovrColliderGetAngularVelocity(Collider* collider, float* x, float* y, float* z);
@@ -132,7 +213,8 @@ typedef enum {
   SHAPE_CAPSULE,
   SHAPE_CYLINDER,
   SHAPE_MESH,
-  SHAPE_TERRAIN
+  SHAPE_TERRAIN,
+  SHAPE_CONVEX
 } ShapeType;
 
 void lovrShapeDestroy(void* ref);
@@ -176,6 +258,12 @@ MeshShape* lovrMeshShapeCreate(int vertexCount, float vertices[], int indexCount
 
 TerrainShape* lovrTerrainShapeCreate(float* vertices, uint32_t widthSamples, uint32_t depthSamples, float horizontalScale, float verticalScale);
 
+ConvexShape* lovrConvexShapeCreate(float* points, uint32_t count);
+uint32_t lovrConvexShapeGetPointCount(ConvexShape* convex);
+void lovrConvexShapeGetPoint(ConvexShape* convex, uint32_t index, float point[3]);
+uint32_t lovrConvexShapeGetFaceCount(ConvexShape* convex);
+uint32_t lovrConvexShapeDecompose(float* vertices, uint32_t vertexCount, uint32_t* indices, uint32_t indexCount, uint32_t maxShapes, float concavity, ConvexShape** shapes);
+
 // These tokens need to exist for Lua bindings
 #define lovrSphereShapeDestroy lovrShapeDestroy
 #define lovrBoxShapeDestroy lovrShapeDestroy
@@ -183,6 +271,7 @@ TerrainShape* lovrTerrainShapeCreate(float* vertices, uint32_t widthSamples, uin
 #define lovrCylinderShapeDestroy lovrShapeDestroy
 #define lovrMeshShapeDestroy lovrShapeDestroy
 #define lovrTerrainShapeDestroy lovrShapeDestroy
+#define lovrConvexShapeDestroy lovrShapeDestroy
 
 // Joints
 